@@ -28,6 +28,7 @@ struct AppStateFeedbackEntryJSON: Encodable {
     let UserDefaultsConfig: String
     let PsiphonDataSharedDB: String
     let OutstandingEffectCount: Int
+    let EmbeddedServerEntriesCache: [String: Int]
     
 }
 
@@ -46,7 +47,8 @@ extension AppState {
             PsiCashLib: psiCashLib.getDiagnosticInfo(lite: false),
             UserDefaultsConfig: makeFeedbackEntry(UserDefaultsConfig()),
             PsiphonDataSharedDB: makeFeedbackEntry(sharedDB),
-            OutstandingEffectCount: store.outstandingEffectCount
+            OutstandingEffectCount: store.outstandingEffectCount,
+            EmbeddedServerEntriesCache: EmbeddedServerEntries.cacheStatistics().mapValues { $0.intValue }
         )
         
         do {
@@ -21,8 +21,6 @@
 #import "SignedData.h"
 #import "ReceiptAttributes.h"
 #import "ReceiptAttribute.h"
-#import "UTF8String.h"
-#import "IA5String.h"
 
 /** Represents an in-app purchase in the app receipt.
  */
@@ -73,9 +71,27 @@
 
 - (instancetype _Nonnull)init NS_UNAVAILABLE;
 
+/** Returns TRUE if every field of `other` is equal to the same field of this in-app purchase.
+ */
+- (BOOL)isEqualToIAP:(AppStoreParsedIAP *_Nonnull)other;
+
 @end
 
 
+@class AppStoreParsedReceiptDiff;
+
+/**
+ Called with the fields of an in-app purchase receipt that are read before the rest of it is decoded.
+
+ @param productIdentifier The product identifier of the item that was purchased.
+ @param expiresDate The expiration date for the subscription, or nil if the purchase is not of a subscription.
+ @param isInIntroPeriod True if the transaction is in intro period.
+ @return TRUE if the in-app purchase receipt should be decoded and included in `inAppPurchases`.
+ */
+typedef BOOL (^AppStoreParsedIAPFilter)(NSString *_Nonnull productIdentifier,
+                                        NSDate *_Nullable expiresDate,
+                                        BOOL isInIntroPeriod);
+
 @interface AppStoreParsedReceiptData : NSObject
 
 /** The app’s bundle identifier.
@@ -107,7 +123,116 @@
 
 /**
  Parses receipt pointed to by `receiptURL` and returns  `AppStoreParsedReceiptData` object created from the parsed data.
+
+ Only the receipt payload is read: the PKCS#7 certificates and signer infos are skipped over without being decoded.
+ Same as `parseReceiptData:decodeSignedData:` with `decodeSignedData` set to `FALSE`.
  */
 + (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)receiptURL;
 
+/**
+ Parses receipt pointed to by `receiptURL` and returns  `AppStoreParsedReceiptData` object created from the parsed data.
+
+ @param decodeSignedData If `TRUE` the whole PKCS#7 SignedData structure is decoded, and the receipt is rejected if
+ any of it is malformed. Otherwise only the TLV headers up to the receipt payload are read, which is sufficient when
+ the receipt is not being validated.
+ */
++ (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)receiptURL
+                                        decodeSignedData:(BOOL)decodeSignedData;
+
+/**
+ Same as `parseReceiptData:`, but only the in-app purchase receipts accepted by `iapFilter` are fully decoded
+ and included in `inAppPurchases`.
+
+ The fields passed to `iapFilter` are read in place from the receipt, and product identifiers are shared between
+ in-app purchase receipts, so that a receipt with a long purchase history can be parsed with few allocations when most
+ of its in-app purchase receipts are discarded.
+
+ This is the only path that decodes lazily. `parseReceiptData:cachePath:iapFilter:` decodes every in-app purchase receipt
+ when its cache misses, and only uses this method when it has no cache path.
+
+ @param iapFilter Called once for each in-app purchase receipt, in receipt order. In-app purchase receipts without a
+ product identifier are not passed to `iapFilter` and are always included.
+ */
++ (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)receiptURL
+                                               iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nonnull)iapFilter;
+
+/**
+ Same as `parseReceiptData:iapFilter:`, but the parsed receipt is kept in a cache at `cachePath`, keyed by a SHA-256 hash
+ of the receipt data. While the receipt is unchanged it is read from the cache without being decoded.
+
+ The cache holds every in-app purchase receipt, and they are filtered by `iapFilter` whenever the cache is read, so that
+ the filter may depend on the current time. On a hit, only the in-app purchase receipts accepted by `iapFilter` are read
+ from the cache. On a miss, every in-app purchase receipt is decoded to be written to the cache, and `iapFilter` is
+ applied afterwards. The lazy decoding of `parseReceiptData:iapFilter:` is only used when `cachePath` is nil.
+
+ @param cachePath Path of the cache file, which is replaced when the receipt changes. If nil no cache is used.
+ @param iapFilter See `parseReceiptData:iapFilter:`.
+ */
++ (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)receiptURL
+                                               cachePath:(NSString *_Nullable)cachePath
+                                               iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nonnull)iapFilter;
+
+/**
+ Default path of the cache of parsed receipts, in the caches directory.
+ */
++ (NSString *_Nonnull)defaultCachePath;
+
+/**
+ Parses the receipt `receiptData` with every in-app purchase receipt, using the cache at `cachePath` as
+ `parseReceiptData:cachePath:iapFilter:` does, and returns the in-app purchase receipts that were added, removed or
+ changed since `previousReceipt` was parsed.
+
+ No filter is applied, so that an unchanged receipt always gives an empty diff even when a filter such as one of
+ unexpired subscriptions would accept fewer in-app purchase receipts than before.
+
+ @param previousReceipt Previous parse result with every in-app purchase receipt, e.g. the `receipt` of the previous
+ diff. If nil, every in-app purchase receipt is added.
+ @return nil if the receipt cannot be parsed.
+ */
++ (AppStoreParsedReceiptDiff *_Nullable)diffReceiptData:(NSData *_Nonnull)receiptData
+                                            fromReceipt:(AppStoreParsedReceiptData *_Nullable)previousReceipt
+                                              cachePath:(NSString *_Nullable)cachePath;
+
+/**
+ Returns the in-app purchase receipts that were added, removed or changed from `previousReceipt` to this receipt.
+
+ Both receipts should hold every in-app purchase receipt. If either was parsed with a filter, the in-app purchase
+ receipts the filter dropped from one but not the other are reported as added or removed.
+ */
+- (AppStoreParsedReceiptDiff *_Nonnull)diffFromReceipt:(AppStoreParsedReceiptData *_Nullable)previousReceipt;
+
+@end
+
+
+/** Changes to the in-app purchase receipts between two parses of the app receipt.
+
+ In-app purchase receipts are identified by their web order line item ID and transaction ID, so that an in-app purchase
+ receipt with the same identifiers but any other field different (e.g. a subscription that was cancelled) is changed.
+ In-app purchase receipts with the same identifiers are paired in receipt order.
+ Since receipts only grow, most diffs only have added in-app purchase receipts.
+ */
+@interface AppStoreParsedReceiptDiff : NSObject
+
+/** The receipt the diff was made to.
+ */
+@property (nonatomic, strong, readonly) AppStoreParsedReceiptData *_Nonnull receipt;
+
+/** In-app purchase receipts only in `receipt`, in receipt order.
+ */
+@property (nonatomic, strong, readonly) NSArray<AppStoreParsedIAP *> *_Nonnull addedInAppPurchases;
+
+/** In-app purchase receipts only in the previous receipt, in previous receipt order.
+ */
+@property (nonatomic, strong, readonly) NSArray<AppStoreParsedIAP *> *_Nonnull removedInAppPurchases;
+
+/** In-app purchase receipts in both receipts with different fields, as they are in `receipt`, in receipt order.
+ */
+@property (nonatomic, strong, readonly) NSArray<AppStoreParsedIAP *> *_Nonnull changedInAppPurchases;
+
+/** TRUE if no in-app purchase receipt was added, removed or changed.
+ */
+@property (nonatomic, readonly) BOOL isEmpty;
+
+- (instancetype _Nonnull)init NS_UNAVAILABLE;
+
 @end
@@ -18,12 +18,16 @@
  */
 
 #import <UIKit/UIKit.h>
+#import <CommonCrypto/CommonDigest.h>
 #import "AppStoreParsedReceiptData.h"
+#import "AppStoreReceiptHelpers.h"
+#import "receipt_decoders.h"
 #import "SharedConstants.h"
 #import "NSDate+Comparator.h"
 #import "Logging.h"
 #import "PsiFeedbackLogger.h"
 #import "NSDate+PSIDateExtension.h"
+@import Rfc3339CTimestamp;
 
 PsiFeedbackLogType const AppReceipt = @"AppReceipt";
 
@@ -44,138 +48,252 @@ NSInteger const ReceiptASN1TypeIsInIntroOfferPeriod = 1719;
 NSInteger const ReceiptASN1TypeWebOrderLineItemID = 1711;
 NSInteger const ReceiptASN1TypeCancellationDate = 1712;
 
-static intmax_t
-asn__integer_convert(const uint8_t *b, const uint8_t *end) {
-    uintmax_t value;
+/// File name of the cache of parsed receipts, which is kept in the caches directory.
+#define kAppStoreReceiptCacheFileName @"app_store_receipt.cache"
+#define kAppStoreReceiptCacheMagic "PSAR"
+#define kAppStoreReceiptCacheVersion 2
 
-    /* Perform the sign initialization */
-    /* Actually value = -(*b >> 7); gains nothing, yet unreadable! */
-    if((*b >> 7)) {
-        value = (uintmax_t)(-1);
-    } else {
-        value = 0;
-    }
+/// String length which stands for nil in the cache.
+#define kAppStoreReceiptCacheNilLength UINT32_MAX
 
-    /* Conversion engine */
-    for(; b < end; b++) {
-        value = (value << 8) | *b;
-    }
-
-    return value;
+/// Reads the primitive TLV with identifier `tag` at the start of the receipt attribute value `bytes`.
+/// Definite lengths are accepted in any form, as by `ber_decode`, but the constructed encoding of strings is not.
+/// Bytes following the TLV are ignored.
+static BOOL ASN1ReadPrimitive(const uint8_t *bytes, size_t length, uint8_t tag, der_tlv *tlv) {
+    const uint8_t *p = bytes;
+    return der_read_tlv(&p, bytes + length, tlv) == 0 && tlv->tag == tag;
 }
 
-int
-asn_INTEGER2imax(const INTEGER_t *iptr, intmax_t *lptr) {
-    uint8_t *b, *end;
-    size_t size;
+/// Returns nil if the value is not a UTF8String.
+static NSString* ASN1ReadUTF8String(const uint8_t *bytes, size_t length) {
+    der_tlv tlv;
+    if (!ASN1ReadPrimitive(bytes, length, DER_TAG_UTF8_STRING, &tlv)) {
+        return nil;
+    }
+    return [[NSString alloc] initWithBytes:tlv.value length:tlv.len encoding:NSUTF8StringEncoding];
+}
 
-    /* Sanity checking */
-    if(!iptr || !iptr->buf || !lptr) {
-        errno = EINVAL;
-        return -1;
+/// Returns nil if the value is not an IA5String.
+static NSString* ASN1ReadIA5SString(const uint8_t *bytes, size_t length) {
+    der_tlv tlv;
+    if (!ASN1ReadPrimitive(bytes, length, DER_TAG_IA5_STRING, &tlv)) {
+        return nil;
     }
+    return [[NSString alloc] initWithBytes:tlv.value length:tlv.len encoding:NSUTF8StringEncoding];
+}
 
-    /* Cache the begin/end of the buffer */
-    b = iptr->buf;    /* Start of the INTEGER buffer */
-    size = iptr->size;
-    end = b + size;    /* Where to stop */
+/// Returns FALSE if the value is not an INTEGER, or does not fit a long.
+static BOOL ASN1ReadInteger(const uint8_t *bytes, size_t length, long *value) {
+    der_tlv tlv;
+    return ASN1ReadPrimitive(bytes, length, DER_TAG_INTEGER, &tlv) &&
+           der_integer_value(tlv.value, tlv.len, value) == 0;
+}
 
-    if(size > sizeof(intmax_t)) {
-        uint8_t *end1 = end - 1;
-        /*
-         * Slightly more advanced processing,
-         * able to process INTEGERs with >sizeof(intmax_t) bytes
-         * when the actual value is small, e.g. for intmax_t == int32_t
-         * (0x0000000000abcdef INTEGER would yield a fine 0x00abcdef int32_t)
-         */
-        /* Skip out the insignificant leading bytes */
-        for(; b < end1; b++) {
-            switch(*b) {
-                case 0x00: if((b[1] & 0x80) == 0) continue; break;
-                case 0xff: if((b[1] & 0x80) != 0) continue; break;
-            }
-            break;
-        }
+/// Returns FALSE if the value is not an INTEGER, or does not fit a long.
+static BOOL ASN1ReadIntegerAsBool(const uint8_t *bytes, size_t length) {
+    long parsed;
+    if (!ASN1ReadInteger(bytes, length, &parsed)) {
+        return FALSE;
+    }
+    return parsed != 0;
+}
 
-        size = end - b;
-        if(size > sizeof(intmax_t)) {
-            /* Still cannot fit the sizeof(intmax_t) */
-            errno = ERANGE;
-            return -1;
+/// Returns the UTF-8 string `bytes`. `strings` holds the strings previously returned and `values` their bytes, and
+/// a previous string is returned instead of a new one when the bytes are the same. `bytes` must outlive `values`.
+static NSString* InternedUTF8String(const uint8_t *bytes, size_t length,
+                                    NSMutableArray<NSData *> *values, NSMutableArray<NSString *> *strings) {
+    for (NSUInteger i = 0; i < values.count; i++) {
+        NSData *value = values[i];
+        if (value.length == length && memcmp(value.bytes, bytes, length) == 0) {
+            return strings[i];
         }
     }
 
-    /* Shortcut processing of a corner case */
-    if(end == b) {
-        *lptr = 0;
-        return 0;
+    NSString *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    if (string != nil) {
+        [values addObject:[NSData dataWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO]];
+        [strings addObject:string];
     }
-
-    *lptr = asn__integer_convert(b, end);
-    return 0;
+    return string;
 }
 
-static NSString* ASN1ReadUTF8String(const uint8_t *bytes, long length) {
-    UTF8String_t *utf8String = NULL;
-    NSString *retString;
-    
-    asn_dec_rval_t rval = ber_decode(0, &asn_DEF_UTF8String, (void **)&utf8String, bytes, length);
-    
-    if (rval.code == RC_OK) {
-        retString = [[NSString alloc]initWithBytes:utf8String->buf length:utf8String->size encoding:NSUTF8StringEncoding];
-    }
-    
-    if (utf8String != NULL) {
-        ASN_STRUCT_FREE(asn_DEF_UTF8String, utf8String);
+/// Same as `ASN1ReadUTF8String`, but the string is read with `InternedUTF8String`.
+static NSString* ASN1ReadInternedUTF8String(const uint8_t *bytes, size_t length,
+                                            NSMutableArray<NSData *> *values, NSMutableArray<NSString *> *strings) {
+    der_tlv tlv;
+    if (!ASN1ReadPrimitive(bytes, length, DER_TAG_UTF8_STRING, &tlv)) {
+        return nil;
     }
-    
-    return retString;
+    return InternedUTF8String(tlv.value, tlv.len, values, strings);
 }
 
-static NSString* ASN1ReadIA5SString(const uint8_t *bytes, long length) {
-    IA5String_t *ia5String = NULL;
-    NSString *retString;
-    
-    asn_dec_rval_t rval = ber_decode(0, &asn_DEF_IA5String, (void **)&ia5String, bytes, length);
-    
-    if (rval.code == RC_OK) {
-        retString = [[NSString alloc]initWithBytes:ia5String->buf length:ia5String->size encoding:NSUTF8StringEncoding];
+/// Date read from the receipt, which is only converted to an NSDate when one is needed.
+typedef struct {
+    /// FALSE if the date is missing from the receipt or is invalid.
+    BOOL valid;
+    psi_timestamp_t ts;
+} receipt_date;
+
+/// Parses the RFC 3339 date in the IA5String receipt attribute value `bytes` in place, without the intermediate
+/// strings of `[NSDate fromRFC3339String:ASN1ReadIA5SString(bytes, length)]`.
+static receipt_date ASN1ReadRFC3339Date(const uint8_t *bytes, size_t length) {
+    receipt_date date = {.valid = FALSE};
+    der_tlv tlv;
+
+    if (ASN1ReadPrimitive(bytes, length, DER_TAG_IA5_STRING, &tlv) &&
+        psi_timestamp_parse((const char *)tlv.value, tlv.len, &date.ts) == 0) {
+        date.valid = TRUE;
     }
-    
-    if (ia5String != NULL) {
-        ASN_STRUCT_FREE(asn_DEF_IA5String, ia5String);
-    }
-    
-    return retString;
+
+    return date;
 }
 
-static intmax_t ASN1ReadInteger(const uint8_t *bytes, long length) {
-    intmax_t parsed = 0;
-    INTEGER_t *asn1Integer = NULL;
+/// Same conversion as fromRFC3339String:. Returns nil if `date` is not valid.
+static NSDate* NSDateFromReceiptDate(receipt_date date) {
+    if (!date.valid) {
+        return nil;
+    }
+    return [NSDate dateWithTimeIntervalSince1970:date.ts.sec + date.ts.nsec / 1000000000.0];
+}
 
-    asn_dec_rval_t rval = ber_decode(0, &asn_DEF_INTEGER, (void **)&asn1Integer, bytes, length);
+/// Returns TRUE if `a` and `b` are the same instant, or are both not valid.
+static BOOL ReceiptDatesEqual(receipt_date a, receipt_date b) {
+    if (!a.valid || !b.valid) {
+        return a.valid == b.valid;
+    }
+    return a.ts.sec == b.ts.sec && a.ts.nsec == b.ts.nsec;
+}
 
-    int result = asn_INTEGER2imax(asn1Integer, &parsed);
+/// Reads values appended to a cache by the `CacheAppend` functions.
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} cache_reader;
 
-    if (result != 0) {
-        [NSException raise:NSGenericException format:@"Failed to parse ASN1 Integer"];
-        exit(1);
+static BOOL CacheRead(cache_reader *reader, void *out, size_t length) {
+    if ((size_t)(reader->end - reader->p) < length) {
+        return FALSE;
     }
+    memcpy(out, reader->p, length);
+    reader->p += length;
+    return TRUE;
+}
 
-    if (rval.code == RC_OK) {
-        ASN_STRUCT_FREE(asn_DEF_INTEGER, asn1Integer);
+/// Reads a string appended by `CacheAppendString` in place. `*bytes` is set to NULL if the string is nil.
+static BOOL CacheReadStringBytes(cache_reader *reader, const uint8_t **bytes, uint32_t *length) {
+    if (!CacheRead(reader, length, sizeof(*length))) {
+        return FALSE;
+    }
+    if (*length == kAppStoreReceiptCacheNilLength) {
+        *bytes = NULL;
+        *length = 0;
+        return TRUE;
+    }
+    if ((size_t)(reader->end - reader->p) < *length) {
+        return FALSE;
     }
+    *bytes = reader->p;
+    reader->p += *length;
+    return TRUE;
+}
 
-    return parsed;
+static BOOL CacheReadString(cache_reader *reader, NSString *__autoreleasing _Nullable *string) {
+    const uint8_t *bytes;
+    uint32_t length;
+    if (!CacheReadStringBytes(reader, &bytes, &length)) {
+        return FALSE;
+    }
+    if (bytes == NULL) {
+        *string = nil;
+        return TRUE;
+    }
+    *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    return *string != nil;
 }
 
-static BOOL ASN1ReadIntegerAsBool(const uint8_t *bytes, long length) {
-    intmax_t parsed = ASN1ReadInteger(bytes, length);
-    if (parsed == 0) {
+static BOOL CacheReadDate(cache_reader *reader, receipt_date *date) {
+    uint8_t valid;
+    if (!CacheRead(reader, &valid, sizeof(valid))) {
         return FALSE;
-    } else {
+    }
+    *date = (receipt_date){.valid = (valid != 0)};
+    if (valid == 0) {
         return TRUE;
     }
+    return CacheRead(reader, &date->ts.sec, sizeof(date->ts.sec)) &&
+           CacheRead(reader, &date->ts.nsec, sizeof(date->ts.nsec));
+}
+
+static void CacheAppendString(NSMutableData *cache, NSString *_Nullable string) {
+    NSData *bytes = [string dataUsingEncoding:NSUTF8StringEncoding];
+    uint32_t length = (bytes != nil) ? (uint32_t)bytes.length : kAppStoreReceiptCacheNilLength;
+    [cache appendBytes:&length length:sizeof(length)];
+    if (bytes != nil) {
+        [cache appendData:bytes];
+    }
+}
+
+static void CacheAppendDate(NSMutableData *cache, receipt_date date) {
+    uint8_t valid = date.valid ? 1 : 0;
+    [cache appendBytes:&valid length:sizeof(valid)];
+    if (date.valid) {
+        [cache appendBytes:&date.ts.sec length:sizeof(date.ts.sec)];
+        [cache appendBytes:&date.ts.nsec length:sizeof(date.ts.nsec)];
+    }
+}
+
+@interface AppStoreParsedIAP ()
+
+/// Dates as read from the receipt, from which `purchaseDate`, `expiresDate` and `cancellationDate` are created.
+@property (nonatomic, readonly) receipt_date purchaseTimestamp;
+@property (nonatomic, readonly) receipt_date expiresTimestamp;
+@property (nonatomic, readonly) receipt_date cancellationTimestamp;
+
+/// Same as `initWithASN1Data:`, but reads the in-app purchase receipt in place from `bytes`.
+- (instancetype _Nonnull)initWithBytes:(const uint8_t *_Nonnull)bytes length:(size_t)length NS_DESIGNATED_INITIALIZER;
+
+/// Reads the in-app purchase receipt fields appended by `appendToCache:`, apart from the given fields which are
+/// read by `AppStoreParsedReceiptData`.
+/// @return nil if the cache is malformed.
+- (instancetype _Nullable)initWithCacheReader:(cache_reader *_Nonnull)reader
+                            productIdentifier:(NSString *_Nullable)productIdentifier
+                             expiresTimestamp:(receipt_date)expiresTimestamp
+                              isInIntroPeriod:(BOOL)isInIntroPeriod NS_DESIGNATED_INITIALIZER;
+
+/// Appends the fields which are not appended by `AppStoreParsedReceiptData`.
+- (void)appendToCache:(NSMutableData *_Nonnull)cache;
+
+@end
+
+@interface AppStoreParsedReceiptData ()
+
+/// Same as `initWithASN1Data:`, but only the in-app purchase receipts accepted by `iapFilter`, if any, are decoded.
+- (instancetype _Nonnull)initWithASN1Data:(NSData *_Nonnull)asn1Data
+                                iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nullable)iapFilter NS_DESIGNATED_INITIALIZER;
+
+- (instancetype _Nonnull)initWithBundleIdentifier:(NSString *_Nullable)bundleIdentifier
+                       originalApplicationVersion:(NSString *_Nullable)originalApplicationVersion
+                                   inAppPurchases:(NSArray<AppStoreParsedIAP *> *_Nonnull)inAppPurchases NS_DESIGNATED_INITIALIZER;
+
+@end
+
+@interface AppStoreParsedReceiptDiff ()
+
+- (instancetype _Nonnull)initWithReceipt:(AppStoreParsedReceiptData *_Nonnull)receipt
+                     addedInAppPurchases:(NSArray<AppStoreParsedIAP *> *_Nonnull)added
+                   removedInAppPurchases:(NSArray<AppStoreParsedIAP *> *_Nonnull)removed
+                   changedInAppPurchases:(NSArray<AppStoreParsedIAP *> *_Nonnull)changed NS_DESIGNATED_INITIALIZER;
+
+@end
+
+/// Fields are nil when missing from the receipt.
+static BOOL EqualFields(id _Nullable a, id _Nullable b) {
+    return a == b || [a isEqual:b];
+}
+
+/// Returns the key which identifies `iap` in a diff, see `AppStoreParsedReceiptDiff`.
+static NSString* IAPDiffKey(AppStoreParsedIAP *iap) {
+    return [NSString stringWithFormat:@"%@/%@", iap.webOrderLineItemID ?: @"", iap.transactionID ?: @""];
 }
 
 // TODO: Local receipt does not contains `is_trial_period` field, it is only accessible by
@@ -187,34 +305,140 @@ static BOOL ASN1ReadIntegerAsBool(const uint8_t *bytes, long length) {
 - (instancetype)initWithASN1Data:(NSData*)asn1Data {
     self = [super init];
     if (self) {
-        NSMutableArray<AppStoreParsedIAP *> *mutablePurchases = [NSMutableArray array];
-        
-        // Explicit casting to avoid errors when compiling as Objective-C++
-        [AppStoreParsedReceiptData enumerateReceiptAttributes:(const uint8_t*)asn1Data.bytes length:asn1Data.length usingBlock:^(NSData *data, long type) {
-            switch (type) {
-                case ReceiptASN1TypeBundleIdentifier:
-                    self->_bundleIdentifier = ASN1ReadUTF8String(data.bytes, data.length);
-                    break;
-                case ReceiptASN1TypeOriginalApplicationVersion:
-                    self->_originalApplicationVersion = ASN1ReadUTF8String(data.bytes, data.length);
-                    break;
-                case ReceiptASN1TypeInAppPurchaseReceipt: {
-                    AppStoreParsedIAP *iapPurchase = [[AppStoreParsedIAP alloc]
-                                                       initWithASN1Data:data];
-                    [mutablePurchases addObject: iapPurchase];
+        [self readAttributesFromData:asn1Data iapFilter:nil];
+    }
+    return self;
+}
+
+- (instancetype)initWithASN1Data:(NSData*)asn1Data iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nullable)iapFilter {
+    self = [super init];
+    if (self) {
+        [self readAttributesFromData:asn1Data iapFilter:iapFilter];
+    }
+    return self;
+}
+
+- (instancetype)initWithBundleIdentifier:(NSString *)bundleIdentifier
+              originalApplicationVersion:(NSString *)originalApplicationVersion
+                          inAppPurchases:(NSArray<AppStoreParsedIAP *> *)inAppPurchases {
+    self = [super init];
+    if (self) {
+        self->_bundleIdentifier = bundleIdentifier;
+        self->_originalApplicationVersion = originalApplicationVersion;
+        self->_inAppPurchases = inAppPurchases;
+    }
+    return self;
+}
+
+- (void)readAttributesFromData:(NSData*)asn1Data iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nullable)iapFilter {
+    NSMutableArray<AppStoreParsedIAP *> *mutablePurchases = [NSMutableArray array];
+
+    // Product identifiers read for `iapFilter`, see ASN1ReadInternedUTF8String.
+    NSMutableArray<NSData *> *productIdentifierValues = [NSMutableArray array];
+    NSMutableArray<NSString *> *productIdentifiers = [NSMutableArray array];
+    
+    // Explicit casting to avoid errors when compiling as Objective-C++
+    [AppStoreParsedReceiptData enumerateReceiptAttributes:(const uint8_t*)asn1Data.bytes
+                                                  length:asn1Data.length
+                                              usingBlock:^(const uint8_t *value, size_t length, long type) {
+        switch (type) {
+            case ReceiptASN1TypeBundleIdentifier:
+                self->_bundleIdentifier = ASN1ReadUTF8String(value, length);
+                break;
+            case ReceiptASN1TypeOriginalApplicationVersion:
+                self->_originalApplicationVersion = ASN1ReadUTF8String(value, length);
+                break;
+            case ReceiptASN1TypeInAppPurchaseReceipt: {
+                if (iapFilter != nil &&
+                    ![AppStoreParsedReceiptData filterIAP:value length:length
+                                                iapFilter:iapFilter
+                                  productIdentifierValues:productIdentifierValues
+                                       productIdentifiers:productIdentifiers]) {
                     break;
                 }
-                default:
-                    break;
+                AppStoreParsedIAP *iapPurchase = [[AppStoreParsedIAP alloc]
+                                                   initWithBytes:value length:length];
+                [mutablePurchases addObject: iapPurchase];
+                break;
             }
-        }];
-        
-        self->_inAppPurchases = mutablePurchases;
-    }
-    return self;
+            default:
+                break;
+        }
+    }];
+    
+    self->_inAppPurchases = mutablePurchases;
 }
 
 + (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)data {
+    return [AppStoreParsedReceiptData parseReceiptData:data decodeSignedData:FALSE iapFilter:nil];
+}
+
++ (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)data
+                                        decodeSignedData:(BOOL)decodeSignedData {
+    return [AppStoreParsedReceiptData parseReceiptData:data decodeSignedData:decodeSignedData iapFilter:nil];
+}
+
++ (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)data
+                                               iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nonnull)iapFilter {
+    return [AppStoreParsedReceiptData parseReceiptData:data decodeSignedData:FALSE iapFilter:iapFilter];
+}
+
++ (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)data
+                                               cachePath:(NSString *_Nullable)cachePath
+                                               iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nonnull)iapFilter {
+    if (cachePath == nil) {
+        return [AppStoreParsedReceiptData parseReceiptData:data decodeSignedData:FALSE iapFilter:iapFilter];
+    }
+
+    NSData *key = [AppStoreParsedReceiptData cacheKeyForReceiptData:data];
+
+    AppStoreParsedReceiptData *receipt = [AppStoreParsedReceiptData receiptFromCache:cachePath
+                                                                                 key:key
+                                                                           iapFilter:iapFilter];
+    if (receipt != nil) {
+        return receipt;
+    }
+
+    // Every in-app purchase receipt is decoded for the cache,
+    // and then filtered as it would be when read from the cache.
+    receipt = [AppStoreParsedReceiptData parseReceiptData:data cacheMissPath:cachePath key:key];
+    if (receipt == nil) {
+        return nil;
+    }
+
+    NSMutableArray<AppStoreParsedIAP *> *inAppPurchases = [NSMutableArray array];
+    for (AppStoreParsedIAP *iap in receipt.inAppPurchases) {
+        // Same as filterIAP:.
+        if (iap.productIdentifier == nil ||
+            iapFilter(iap.productIdentifier, NSDateFromReceiptDate(iap.expiresTimestamp), iap.isInIntroPeriod)) {
+            [inAppPurchases addObject:iap];
+        }
+    }
+
+    return [[AppStoreParsedReceiptData alloc] initWithBundleIdentifier:receipt.bundleIdentifier
+                                            originalApplicationVersion:receipt.originalApplicationVersion
+                                                        inAppPurchases:inAppPurchases];
+}
+
+/**
+ Decodes every in-app purchase receipt of `data` after a miss of the cache at `cachePath`, and writes them to the cache
+ for `key`.
+ */
++ (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)data
+                                           cacheMissPath:(NSString *_Nonnull)cachePath
+                                                     key:(NSData *_Nonnull)key {
+    AppStoreParsedReceiptData *receipt = [AppStoreParsedReceiptData parseReceiptData:data
+                                                                    decodeSignedData:FALSE
+                                                                           iapFilter:nil];
+    if (receipt != nil) {
+        [AppStoreParsedReceiptData writeReceipt:receipt toCache:cachePath key:key];
+    }
+    return receipt;
+}
+
++ (AppStoreParsedReceiptData *_Nullable)parseReceiptData:(NSData *_Nonnull)data
+                                        decodeSignedData:(BOOL)decodeSignedData
+                                               iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nullable)iapFilter {
     AppStoreParsedReceiptData *receipt = nil;
     SignedData_t * signedData = NULL;
     
@@ -225,13 +449,27 @@ static BOOL ASN1ReadIntegerAsBool(const uint8_t *bytes, long length) {
         return nil;
     }
     
-    asn_dec_rval_t rval = ber_decode(0, &asn_DEF_SignedData, (void **)&signedData, bytes, length);
+    if (decodeSignedData == FALSE) {
+        const uint8_t *content = NULL;
+        size_t contentLength = 0;
+
+        if (receipt_pkcs7_content(bytes, length, &content, &contentLength) == RECEIPT_CONTENT_OK) {
+            return [[AppStoreParsedReceiptData alloc] initWithASN1Data:[NSData dataWithBytesNoCopy:(void *)content length:contentLength freeWhenDone:NO]
+                                                             iapFilter:iapFilter];
+        }
+
+        // The content is split into segments, or encoded in a form
+        // the scan does not handle, which is left to the full decode.
+    }
+
+    asn_dec_rval_t rval = SignedData_decode_fast(0, &signedData, bytes, length);
 
     if (rval.code == RC_OK) {
         int signedDataSize = signedData->content.contentInfo.contentData.size;
         uint8_t* signedDataBuf = signedData->content.contentInfo.contentData.buf;
 
-       receipt = [[AppStoreParsedReceiptData alloc] initWithASN1Data:[NSData dataWithBytesNoCopy:signedDataBuf length:signedDataSize freeWhenDone:NO ]];
+       receipt = [[AppStoreParsedReceiptData alloc] initWithASN1Data:[NSData dataWithBytesNoCopy:signedDataBuf length:signedDataSize freeWhenDone:NO ]
+                                                            iapFilter:iapFilter];
     }
     
     if (signedData != NULL) {
@@ -241,25 +479,308 @@ static BOOL ASN1ReadIntegerAsBool(const uint8_t *bytes, long length) {
     return receipt;
 }
 
-+ (void)enumerateReceiptAttributes:(const uint8_t*)p length:(long)tlength
-                        usingBlock:(void (^)(NSData *_Nonnull data, long type))block
+/**
+ Reads the fields of the in-app purchase receipt at `p` that are passed to `iapFilter`, and returns whether it should be decoded.
+ Nothing else is decoded, and product identifiers are read with ASN1ReadInternedUTF8String.
+ */
++ (BOOL)filterIAP:(const uint8_t*)p length:(size_t)tlength
+        iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nonnull)iapFilter
+productIdentifierValues:(NSMutableArray<NSData *> *)productIdentifierValues
+productIdentifiers:(NSMutableArray<NSString *> *)productIdentifiers
 {
-    ReceiptAttributes_t * receiptAttributes = NULL;
-    asn_dec_rval_t rval = ber_decode(0, &asn_DEF_ReceiptAttributes,
-                                     (void **)&receiptAttributes, p, tlength);
-    if (rval.code == RC_OK) {
-        for(int i = 0; i < receiptAttributes->list.count; i++) {
-            ReceiptAttribute_t *receiptAttr = receiptAttributes->list.array[i];
-            if (receiptAttr->value.size) {
-                NSData *_Nonnull nonCopied = [NSData dataWithBytesNoCopy:receiptAttr->value.buf
-                                                                  length:receiptAttr->value.size
-                                                            freeWhenDone:NO];
-                block(nonCopied, receiptAttr->type);
+    __block NSString *productIdentifier = nil;
+    __block receipt_date expiresDate = {.valid = FALSE};
+    __block BOOL isInIntroPeriod = FALSE;
+
+    [AppStoreParsedReceiptData enumerateReceiptAttributes:p
+                                                   length:tlength
+                                               usingBlock:^(const uint8_t *value, size_t length, long type)
+     {
+        switch (type) {
+            case ReceiptASN1TypeProductIdentifier:
+                productIdentifier = ASN1ReadInternedUTF8String(value, length,
+                                                              productIdentifierValues, productIdentifiers);
+                break;
+            case ReceiptASN1TypeSubscriptionExpirationDate:
+                expiresDate = ASN1ReadRFC3339Date(value, length);
+                break;
+            case ReceiptASN1TypeIsInIntroOfferPeriod:
+                isInIntroPeriod = ASN1ReadIntegerAsBool(value, length);
+                break;
+        }
+    }];
+
+    if (productIdentifier == nil) {
+        // Left to the caller, as without a filter.
+        return TRUE;
+    }
+
+    return iapFilter(productIdentifier, NSDateFromReceiptDate(expiresDate), isInIntroPeriod);
+}
+
+#pragma mark - Cache
+
++ (NSString *_Nonnull)defaultCachePath {
+    NSString *cachesDir = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    return [cachesDir stringByAppendingPathComponent:kAppStoreReceiptCacheFileName];
+}
+
+/**
+ Returns the cache key of the receipt `data`, which is also the header of the cache file.
+
+ Cache file layout, in host byte order:
+   char[4] magic, uint32 version, uint8[32] SHA-256 of the receipt,
+   string bundle identifier, string original application version,
+   uint32 in-app purchase receipt count, then for each in-app purchase receipt:
+     string product identifier, date expires date, uint8 is in intro period,
+     uint32 length of the remaining fields, string transaction ID, string original transaction ID,
+     string raw purchase date, date purchase date, string web order line item ID, date cancellation date.
+
+ A string is a uint32 length followed by UTF-8 bytes, with a length of UINT32_MAX for nil. A date is a uint8 which is
+ 0 for a missing or invalid date, followed otherwise by int64 seconds since the epoch and int32 nanoseconds.
+ */
++ (NSData *_Nonnull)cacheKeyForReceiptData:(NSData *_Nonnull)data {
+    NSMutableData *key = [NSMutableData dataWithCapacity:8 + CC_SHA256_DIGEST_LENGTH];
+    uint32_t version = kAppStoreReceiptCacheVersion;
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+
+    [key appendBytes:kAppStoreReceiptCacheMagic length:4];
+    [key appendBytes:&version length:sizeof(version)];
+    [key appendBytes:digest length:sizeof(digest)];
+
+    return key;
+}
+
+/**
+ Returns the receipt cached at `cachePath` if it was written for `key`, otherwise nil.
+ In-app purchase receipts are filtered by `iapFilter` as in `filterIAP:`, and only those accepted are read.
+ */
++ (AppStoreParsedReceiptData *_Nullable)receiptFromCache:(NSString *_Nonnull)cachePath
+                                                     key:(NSData *_Nonnull)key
+                                               iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nullable)iapFilter {
+    NSData *cache = [NSData dataWithContentsOfFile:cachePath options:NSDataReadingUncached error:nil];
+    if (cache == nil || cache.length < key.length || memcmp(cache.bytes, key.bytes, key.length) != 0) {
+        return nil;
+    }
+
+    cache_reader reader = {
+        .p = (const uint8_t *)cache.bytes + key.length,
+        .end = (const uint8_t *)cache.bytes + cache.length
+    };
+
+    NSString *bundleIdentifier, *originalApplicationVersion;
+    uint32_t count;
+    if (!CacheReadString(&reader, &bundleIdentifier) ||
+        !CacheReadString(&reader, &originalApplicationVersion) ||
+        !CacheRead(&reader, &count, sizeof(count))) {
+        return nil;
+    }
+
+    NSMutableArray<AppStoreParsedIAP *> *inAppPurchases = [NSMutableArray array];
+
+    // Product identifiers, see InternedUTF8String.
+    NSMutableArray<NSData *> *productIdentifierValues = [NSMutableArray array];
+    NSMutableArray<NSString *> *productIdentifiers = [NSMutableArray array];
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *productIdentifierBytes;
+        uint32_t productIdentifierLength;
+        NSString *productIdentifier = nil;
+        receipt_date expiresDate;
+        uint8_t isInIntroPeriod;
+        uint32_t length;
+
+        if (!CacheReadStringBytes(&reader, &productIdentifierBytes, &productIdentifierLength) ||
+            !CacheReadDate(&reader, &expiresDate) ||
+            !CacheRead(&reader, &isInIntroPeriod, sizeof(isInIntroPeriod)) ||
+            !CacheRead(&reader, &length, sizeof(length)) ||
+            (size_t)(reader.end - reader.p) < length) {
+            return nil;
+        }
+
+        if (productIdentifierBytes != NULL) {
+            productIdentifier = InternedUTF8String(productIdentifierBytes, productIdentifierLength,
+                                                   productIdentifierValues, productIdentifiers);
+            if (productIdentifier == nil) {
+                return nil;
             }
         }
+
+        cache_reader fields = {.p = reader.p, .end = reader.p + length};
+        reader.p += length;
+
+        if (iapFilter != nil && productIdentifier != nil &&
+            !iapFilter(productIdentifier, NSDateFromReceiptDate(expiresDate), isInIntroPeriod != 0)) {
+            continue;
+        }
+
+        AppStoreParsedIAP *iap = [[AppStoreParsedIAP alloc] initWithCacheReader:&fields
+                                                              productIdentifier:productIdentifier
+                                                               expiresTimestamp:expiresDate
+                                                                isInIntroPeriod:isInIntroPeriod != 0];
+        if (iap == nil) {
+            return nil;
+        }
+        [inAppPurchases addObject:iap];
     }
-    if(receiptAttributes != NULL) {
-        ASN_STRUCT_FREE(asn_DEF_ReceiptAttributes, receiptAttributes);
+
+    if (reader.p != reader.end) {
+        return nil;
+    }
+
+    return [[AppStoreParsedReceiptData alloc] initWithBundleIdentifier:bundleIdentifier
+                                            originalApplicationVersion:originalApplicationVersion
+                                                        inAppPurchases:inAppPurchases];
+}
+
+/**
+ Replaces the cache at `cachePath` with `receipt` for `key`. Failures are ignored, the
+ receipt will be parsed again on the next read.
+ */
++ (void)writeReceipt:(AppStoreParsedReceiptData *_Nonnull)receipt
+             toCache:(NSString *_Nonnull)cachePath
+                 key:(NSData *_Nonnull)key {
+    NSMutableData *cache = [NSMutableData dataWithData:key];
+
+    CacheAppendString(cache, receipt.bundleIdentifier);
+    CacheAppendString(cache, receipt.originalApplicationVersion);
+
+    uint32_t count = (uint32_t)receipt.inAppPurchases.count;
+    [cache appendBytes:&count length:sizeof(count)];
+
+    NSMutableData *fields = [NSMutableData data];
+
+    for (AppStoreParsedIAP *iap in receipt.inAppPurchases) {
+        CacheAppendString(cache, iap.productIdentifier);
+        CacheAppendDate(cache, iap.expiresTimestamp);
+        uint8_t isInIntroPeriod = iap.isInIntroPeriod ? 1 : 0;
+        [cache appendBytes:&isInIntroPeriod length:sizeof(isInIntroPeriod)];
+
+        // The remaining fields are prefixed with their length, so that
+        // they can be skipped when the filter does not accept the record.
+        [fields setLength:0];
+        [iap appendToCache:fields];
+        uint32_t length = (uint32_t)fields.length;
+        [cache appendBytes:&length length:sizeof(length)];
+        [cache appendData:fields];
+    }
+
+    [cache writeToFile:cachePath atomically:YES];
+}
+
+#pragma mark - Diff
+
++ (AppStoreParsedReceiptDiff *_Nullable)diffReceiptData:(NSData *_Nonnull)receiptData
+                                            fromReceipt:(AppStoreParsedReceiptData *_Nullable)previousReceipt
+                                              cachePath:(NSString *_Nullable)cachePath {
+    AppStoreParsedReceiptData *receipt;
+
+    if (cachePath == nil) {
+        receipt = [AppStoreParsedReceiptData parseReceiptData:receiptData];
+    } else {
+        NSData *key = [AppStoreParsedReceiptData cacheKeyForReceiptData:receiptData];
+        receipt = [AppStoreParsedReceiptData receiptFromCache:cachePath key:key iapFilter:nil];
+        if (receipt == nil) {
+            receipt = [AppStoreParsedReceiptData parseReceiptData:receiptData cacheMissPath:cachePath key:key];
+        }
+    }
+
+    if (receipt == nil) {
+        return nil;
+    }
+    return [receipt diffFromReceipt:previousReceipt];
+}
+
+- (AppStoreParsedReceiptDiff *_Nonnull)diffFromReceipt:(AppStoreParsedReceiptData *_Nullable)previousReceipt {
+    NSArray<AppStoreParsedIAP *> *previous = previousReceipt.inAppPurchases ?: @[];
+    NSArray<AppStoreParsedIAP *> *current = self.inAppPurchases;
+
+    // Receipts only grow, so the previous in-app purchase receipts are
+    // usually a prefix of the current ones, which is checked without keys.
+    NSUInteger prefix = 0;
+    while (prefix < previous.count && prefix < current.count &&
+           [current[prefix] isEqualToIAP:previous[prefix]]) {
+        prefix++;
+    }
+
+    if (prefix == previous.count) {
+        NSArray<AppStoreParsedIAP *> *added = [current subarrayWithRange:NSMakeRange(prefix, current.count - prefix)];
+        return [[AppStoreParsedReceiptDiff alloc] initWithReceipt:self
+                                              addedInAppPurchases:added
+                                            removedInAppPurchases:@[]
+                                            changedInAppPurchases:@[]];
+    }
+
+    // Previous in-app purchase receipts after the common prefix, by key, in receipt order.
+    NSMutableDictionary<NSString *, NSMutableArray<AppStoreParsedIAP *> *> *previousByKey =
+        [NSMutableDictionary dictionaryWithCapacity:previous.count - prefix];
+    for (NSUInteger i = prefix; i < previous.count; i++) {
+        NSString *key = IAPDiffKey(previous[i]);
+        NSMutableArray<AppStoreParsedIAP *> *withKey = previousByKey[key];
+        if (withKey == nil) {
+            withKey = [NSMutableArray arrayWithCapacity:1];
+            previousByKey[key] = withKey;
+        }
+        [withKey addObject:previous[i]];
+    }
+
+    NSMutableArray<AppStoreParsedIAP *> *added = [NSMutableArray array];
+    NSMutableArray<AppStoreParsedIAP *> *changed = [NSMutableArray array];
+
+    for (NSUInteger i = prefix; i < current.count; i++) {
+        AppStoreParsedIAP *iap = current[i];
+        NSMutableArray<AppStoreParsedIAP *> *withKey = previousByKey[IAPDiffKey(iap)];
+
+        if (withKey.count == 0) {
+            [added addObject:iap];
+            continue;
+        }
+
+        // Paired with the first unpaired previous in-app purchase receipt with the same key.
+        if (![iap isEqualToIAP:withKey[0]]) {
+            [changed addObject:iap];
+        }
+        [withKey removeObjectAtIndex:0];
+    }
+
+    // Previous in-app purchase receipts left unpaired.
+    NSMutableArray<AppStoreParsedIAP *> *removed = [NSMutableArray array];
+    for (NSUInteger i = prefix; i < previous.count; i++) {
+        if ([previousByKey[IAPDiffKey(previous[i])] indexOfObjectIdenticalTo:previous[i]] != NSNotFound) {
+            [removed addObject:previous[i]];
+        }
+    }
+
+    return [[AppStoreParsedReceiptDiff alloc] initWithReceipt:self
+                                          addedInAppPurchases:added
+                                        removedInAppPurchases:removed
+                                        changedInAppPurchases:changed];
+}
+
+/**
+ Calls `block` with each receipt attribute in the DER encoded `ReceiptAttributes` SET at `p` that has a non-empty value.
+ The value passed to `block` points into `p` and is only valid as long as `p` is.
+ Nothing is enumerated if any attribute is malformed.
+ */
++ (void)enumerateReceiptAttributes:(const uint8_t*)p length:(size_t)tlength
+                        usingBlock:(NS_NOESCAPE void (^)(const uint8_t *_Nonnull value, size_t length, long type))block
+{
+    // Attributes are validated up front, since the iterator
+    // only finds a malformed attribute when it reaches it.
+    if (receipt_attributes_validate(p, tlength) < 0) {
+        return;
+    }
+
+    receipt_attribute_iterator it;
+    receipt_attribute_iterator_init(&it, p, tlength);
+
+    receipt_attribute attr;
+    while (receipt_attribute_iterator_next(&it, &attr) == 1) {
+        if (attr.value_len > 0) {
+            block(attr.value, attr.value_len, attr.type);
+        }
     }
 }
 
@@ -271,56 +792,157 @@ static BOOL ASN1ReadIntegerAsBool(const uint8_t *bytes, long length) {
 - (instancetype)initWithASN1Data:(NSData *_Nonnull)asn1Data {
     self = [super init];
     if (self) {
-        // Initializes subscription-only fields to nil.
-        self->_webOrderLineItemID = nil;
-        self->_expiresDate = nil;
-        self->_cancellationDate = nil;
-        
-        [AppStoreParsedReceiptData enumerateReceiptAttributes:(const uint8_t*)asn1Data.bytes
-                                                 length:asn1Data.length
-                                             usingBlock:^(NSData *data, long type)
-         {
-            const uint8_t *p = (const uint8_t*)data.bytes;
-            const NSUInteger length = data.length;
-            switch (type) {
-                case ReceiptASN1TypeProductIdentifier:
-                    self->_productIdentifier = ASN1ReadUTF8String(p, length);
-                    break;
-                case ReceiptASN1TypeTransactionID:
-                    self->_transactionID = ASN1ReadUTF8String(p, length);
-                    break;
-                case ReceiptASN1TypeOriginalTransactionID:
-                    self->_originalTransactionID = ASN1ReadUTF8String(p, length);
-                    break;
-                case ReceiptASN1TypePurchaseDate: {
-                    self->_rawPurchaseDate = ASN1ReadIA5SString(p, length);
-                    self->_purchaseDate = [NSDate fromRFC3339String:self->_rawPurchaseDate];
-                    break;
-                }
-                case ReceiptASN1TypeSubscriptionExpirationDate: {
-                    NSString *string = ASN1ReadIA5SString(p, length);
-                    self->_expiresDate = [NSDate fromRFC3339String:string];
-                    break;
-                }
-                case ReceiptASN1TypeCancellationDate: {
-                    NSString *string = ASN1ReadIA5SString(p, length);
-                    self->_cancellationDate = [NSDate fromRFC3339String:string];
-                    break;
-                }
-                case ReceiptASN1TypeWebOrderLineItemID: {
-                    intmax_t webOrderLineItemID = ASN1ReadInteger(p, length);
-                    self->_webOrderLineItemID = [NSString stringWithFormat:@"%jd",
+        [self readAttributesFromBytes:(const uint8_t*)asn1Data.bytes length:asn1Data.length];
+    }
+    return self;
+}
+
+- (instancetype)initWithBytes:(const uint8_t *_Nonnull)bytes length:(size_t)length {
+    self = [super init];
+    if (self) {
+        [self readAttributesFromBytes:bytes length:length];
+    }
+    return self;
+}
+
+- (instancetype)initWithCacheReader:(cache_reader *)reader
+                  productIdentifier:(NSString *)productIdentifier
+                   expiresTimestamp:(receipt_date)expiresTimestamp
+                    isInIntroPeriod:(BOOL)isInIntroPeriod {
+    self = [super init];
+    if (self) {
+        self->_productIdentifier = productIdentifier;
+        self->_expiresTimestamp = expiresTimestamp;
+        self->_isInIntroPeriod = isInIntroPeriod;
+
+        NSString *transactionID, *originalTransactionID, *rawPurchaseDate, *webOrderLineItemID;
+        receipt_date purchaseDate, cancellationDate;
+
+        if (!CacheReadString(reader, &transactionID) ||
+            !CacheReadString(reader, &originalTransactionID) ||
+            !CacheReadString(reader, &rawPurchaseDate) ||
+            !CacheReadDate(reader, &purchaseDate) ||
+            !CacheReadString(reader, &webOrderLineItemID) ||
+            !CacheReadDate(reader, &cancellationDate) ||
+            reader->p != reader->end) {
+            return nil;
+        }
+
+        self->_transactionID = transactionID;
+        self->_originalTransactionID = originalTransactionID;
+        self->_rawPurchaseDate = rawPurchaseDate;
+        self->_purchaseTimestamp = purchaseDate;
+        self->_webOrderLineItemID = webOrderLineItemID;
+        self->_cancellationTimestamp = cancellationDate;
+    }
+    return self;
+}
+
+// Dates are created from the dates read from the receipt when they are needed.
+
+- (NSDate *)purchaseDate {
+    return NSDateFromReceiptDate(self.purchaseTimestamp);
+}
+
+- (NSDate *)expiresDate {
+    return NSDateFromReceiptDate(self.expiresTimestamp);
+}
+
+- (NSDate *)cancellationDate {
+    return NSDateFromReceiptDate(self.cancellationTimestamp);
+}
+
+- (BOOL)isEqualToIAP:(AppStoreParsedIAP *_Nonnull)other {
+    return EqualFields(self.productIdentifier, other.productIdentifier) &&
+           EqualFields(self.transactionID, other.transactionID) &&
+           EqualFields(self.originalTransactionID, other.originalTransactionID) &&
+           ReceiptDatesEqual(self.purchaseTimestamp, other.purchaseTimestamp) &&
+           EqualFields(self.rawPurchaseDate, other.rawPurchaseDate) &&
+           EqualFields(self.webOrderLineItemID, other.webOrderLineItemID) &&
+           ReceiptDatesEqual(self.expiresTimestamp, other.expiresTimestamp) &&
+           ReceiptDatesEqual(self.cancellationTimestamp, other.cancellationTimestamp) &&
+           self.isInIntroPeriod == other.isInIntroPeriod;
+}
+
+- (void)appendToCache:(NSMutableData *)cache {
+    CacheAppendString(cache, self.transactionID);
+    CacheAppendString(cache, self.originalTransactionID);
+    CacheAppendString(cache, self.rawPurchaseDate);
+    CacheAppendDate(cache, self.purchaseTimestamp);
+    CacheAppendString(cache, self.webOrderLineItemID);
+    CacheAppendDate(cache, self.cancellationTimestamp);
+}
+
+- (void)readAttributesFromBytes:(const uint8_t *_Nonnull)bytes length:(size_t)bytesLength {
+    // Initializes subscription-only fields to nil.
+    self->_webOrderLineItemID = nil;
+    self->_expiresTimestamp = (receipt_date){.valid = FALSE};
+    self->_cancellationTimestamp = (receipt_date){.valid = FALSE};
+
+    [AppStoreParsedReceiptData enumerateReceiptAttributes:bytes
+                                                   length:bytesLength
+                                               usingBlock:^(const uint8_t *p, size_t length, long type)
+     {
+        switch (type) {
+            case ReceiptASN1TypeProductIdentifier:
+                self->_productIdentifier = ASN1ReadUTF8String(p, length);
+                break;
+            case ReceiptASN1TypeTransactionID:
+                self->_transactionID = ASN1ReadUTF8String(p, length);
+                break;
+            case ReceiptASN1TypeOriginalTransactionID:
+                self->_originalTransactionID = ASN1ReadUTF8String(p, length);
+                break;
+            case ReceiptASN1TypePurchaseDate: {
+                self->_rawPurchaseDate = ASN1ReadIA5SString(p, length);
+                self->_purchaseTimestamp = ASN1ReadRFC3339Date(p, length);
+                break;
+            }
+            case ReceiptASN1TypeSubscriptionExpirationDate:
+                self->_expiresTimestamp = ASN1ReadRFC3339Date(p, length);
+                break;
+            case ReceiptASN1TypeCancellationDate:
+                self->_cancellationTimestamp = ASN1ReadRFC3339Date(p, length);
+                break;
+            case ReceiptASN1TypeWebOrderLineItemID: {
+                long webOrderLineItemID;
+                if (ASN1ReadInteger(p, length, &webOrderLineItemID)) {
+                    self->_webOrderLineItemID = [NSString stringWithFormat:@"%ld",
                                                  webOrderLineItemID];
-                    break;
-                }
-                case ReceiptASN1TypeIsInIntroOfferPeriod: {
-                    self->_isInIntroPeriod = ASN1ReadIntegerAsBool(p, length);
-                    break;
                 }
+                break;
             }
-        }];
+            case ReceiptASN1TypeIsInIntroOfferPeriod: {
+                self->_isInIntroPeriod = ASN1ReadIntegerAsBool(p, length);
+                break;
+            }
+        }
+    }];
+}
+
+@end
+
+
+@implementation AppStoreParsedReceiptDiff
+
+- (instancetype)initWithReceipt:(AppStoreParsedReceiptData *)receipt
+            addedInAppPurchases:(NSArray<AppStoreParsedIAP *> *)added
+          removedInAppPurchases:(NSArray<AppStoreParsedIAP *> *)removed
+          changedInAppPurchases:(NSArray<AppStoreParsedIAP *> *)changed {
+    self = [super init];
+    if (self) {
+        self->_receipt = receipt;
+        self->_addedInAppPurchases = added;
+        self->_removedInAppPurchases = removed;
+        self->_changedInAppPurchases = changed;
     }
     return self;
 }
 
+- (BOOL)isEmpty {
+    return self.addedInAppPurchases.count == 0 &&
+           self.removedInAppPurchases.count == 0 &&
+           self.changedInAppPurchases.count == 0;
+}
+
 @end
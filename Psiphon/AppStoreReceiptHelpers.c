@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "AppStoreReceiptHelpers.h"
+#import <limits.h>
+
+// Limit on the nesting of TLVs skipped by `ber_skip_tlv`.
+#define BER_MAX_SKIP_DEPTH 16
+
+// See comment in header
+int ber_read_header(const uint8_t **p, const uint8_t *end, der_tlv *tlv) {
+    const uint8_t *q = *p;
+
+    if (q >= end) {
+        return -1;
+    }
+
+    const uint8_t tag = *q++;
+    if ((tag & 0x1F) == 0x1F) {
+        // High-tag-number form.
+        return -1;
+    }
+
+    if (q >= end) {
+        return -1;
+    }
+
+    size_t len = *q++;
+    if (len == 0x80) {
+        // The indefinite length is only allowed on constructed TLVs.
+        if ((tag & DER_CONSTRUCTED) == 0) {
+            return -1;
+        }
+        len = BER_INDEFINITE_LENGTH;
+    } else if (len & 0x80) {
+        const size_t num_octets = len & 0x7F;
+        if (num_octets > sizeof(size_t) || num_octets > (size_t)(end - q)) {
+            return -1;
+        }
+        len = 0;
+        for (size_t i = 0; i < num_octets; i++) {
+            len = (len << 8) | *q++;
+        }
+        if (len > (size_t)(end - q)) {
+            return -1;
+        }
+    } else if (len > (size_t)(end - q)) {
+        return -1;
+    }
+
+    tlv->tag = tag;
+    tlv->value = q;
+    tlv->len = len;
+
+    *p = q;
+
+    return 0;
+}
+
+// See comment in header
+int der_read_tlv(const uint8_t **p, const uint8_t *end, der_tlv *tlv) {
+    const uint8_t *q = *p;
+    der_tlv header;
+
+    // DER does not allow the indefinite length.
+    if (ber_read_header(&q, end, &header) != 0 || header.len == BER_INDEFINITE_LENGTH) {
+        return -1;
+    }
+
+    *tlv = header;
+    *p = q + header.len;
+
+    return 0;
+}
+
+static int ber_skip_tlv_depth(const uint8_t **p, const uint8_t *end, int depth) {
+    const uint8_t *q = *p;
+    der_tlv tlv;
+
+    if (depth > BER_MAX_SKIP_DEPTH || ber_read_header(&q, end, &tlv) != 0) {
+        return -1;
+    }
+
+    if (tlv.len != BER_INDEFINITE_LENGTH) {
+        *p = q + tlv.len;
+        return 0;
+    }
+
+    // Skip the contents up to and including the end-of-contents octets.
+    for (;;) {
+        if (end - q >= 2 && q[0] == 0x00 && q[1] == 0x00) {
+            *p = q + 2;
+            return 0;
+        }
+        if (ber_skip_tlv_depth(&q, end, depth + 1) != 0) {
+            return -1;
+        }
+    }
+}
+
+// See comment in header
+int ber_skip_tlv(const uint8_t **p, const uint8_t *end) {
+    return ber_skip_tlv_depth(p, end, 0);
+}
+
+/*!
+ * @brief Reads the header of the constructed TLV at `*p`, which must have the identifier `tag`, and
+ * advances `*p` to its contents.
+ *
+ * `*end` is narrowed to the end of the contents if the length is definite. Otherwise it is left unchanged,
+ * since the end-of-contents octets are never reached by the scan.
+ */
+static int ber_enter(const uint8_t **p, const uint8_t **end, uint8_t tag) {
+    der_tlv tlv;
+
+    if (ber_read_header(p, *end, &tlv) != 0 || tlv.tag != tag) {
+        return -1;
+    }
+
+    if (tlv.len != BER_INDEFINITE_LENGTH) {
+        *end = tlv.value + tlv.len;
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief Advances `*p` past the primitive TLV at `*p`, which must have the identifier `tag`.
+ */
+static int der_skip_primitive(const uint8_t **p, const uint8_t *end, uint8_t tag) {
+    der_tlv tlv;
+    return (der_read_tlv(p, end, &tlv) == 0 && tlv.tag == tag) ? 0 : -1;
+}
+
+// See comment in header
+receipt_content_result receipt_pkcs7_content(const uint8_t *data, size_t len,
+                                             const uint8_t **content, size_t *content_len) {
+    if (data == NULL) {
+        return RECEIPT_CONTENT_ERROR;
+    }
+
+    const uint8_t *p = data;
+    const uint8_t *end = data + len;
+
+    // ContentInfo ::= SEQUENCE {
+    //     contentType OBJECT IDENTIFIER,
+    //     content     [0] EXPLICIT SignedData }
+    //
+    // SignedData ::= SEQUENCE {
+    //     version          INTEGER,
+    //     digestAlgorithms SET OF AlgorithmIdentifier,
+    //     contentInfo      ContentInfo (with OCTET STRING content),
+    //     ... }
+    if (ber_enter(&p, &end, DER_TAG_SEQUENCE) != 0 ||
+        der_skip_primitive(&p, end, DER_TAG_OBJECT_IDENTIFIER) != 0 ||
+        ber_enter(&p, &end, DER_TAG_CONTEXT_0) != 0 ||
+        ber_enter(&p, &end, DER_TAG_SEQUENCE) != 0 ||
+        der_skip_primitive(&p, end, DER_TAG_INTEGER) != 0 ||
+        ber_skip_tlv(&p, end) != 0 ||
+        ber_enter(&p, &end, DER_TAG_SEQUENCE) != 0 ||
+        der_skip_primitive(&p, end, DER_TAG_OBJECT_IDENTIFIER) != 0 ||
+        ber_enter(&p, &end, DER_TAG_CONTEXT_0) != 0) {
+        return RECEIPT_CONTENT_ERROR;
+    }
+
+    der_tlv octets;
+    if (ber_read_header(&p, end, &octets) != 0) {
+        return RECEIPT_CONTENT_ERROR;
+    }
+
+    if (octets.tag == DER_TAG_OCTET_STRING) {
+        *content = octets.value;
+        *content_len = octets.len;
+        return RECEIPT_CONTENT_OK;
+    }
+
+    if (octets.tag != (DER_TAG_OCTET_STRING | DER_CONSTRUCTED)) {
+        return RECEIPT_CONTENT_ERROR;
+    }
+
+    // Constructed OCTET STRING. The content is only contiguous if
+    // there is a single primitive segment.
+    if (octets.len != BER_INDEFINITE_LENGTH) {
+        end = octets.value + octets.len;
+        if (p == end) {
+            // No segments.
+            return RECEIPT_CONTENT_SEGMENTED;
+        }
+    }
+
+    der_tlv segment;
+    if (ber_read_header(&p, end, &segment) != 0) {
+        return RECEIPT_CONTENT_ERROR;
+    }
+    if (segment.tag != DER_TAG_OCTET_STRING) {
+        // Nested constructed segments, or no segments, are left to the full decode.
+        return RECEIPT_CONTENT_SEGMENTED;
+    }
+    p = segment.value + segment.len;
+
+    if (octets.len != BER_INDEFINITE_LENGTH) {
+        if (p != end) {
+            return RECEIPT_CONTENT_SEGMENTED;
+        }
+    } else {
+        if (end - p < 2) {
+            return RECEIPT_CONTENT_ERROR;
+        }
+        if (p[0] != 0x00 || p[1] != 0x00) {
+            return RECEIPT_CONTENT_SEGMENTED;
+        }
+    }
+
+    *content = segment.value;
+    *content_len = segment.len;
+    return RECEIPT_CONTENT_OK;
+}
+
+// See comment in header
+int der_integer_value(const uint8_t *value, size_t len, long *out) {
+    // asn1c decodes an empty INTEGER as 0.
+    if (len == 0) {
+        *out = 0;
+        return 0;
+    }
+
+    const uint8_t *b = value;
+    const uint8_t *end = value + len;
+
+    // Skip insignificant leading octets.
+    for (; b < end - 1; b++) {
+        if ((b[0] == 0x00 && (b[1] & 0x80) == 0) || (b[0] == 0xFF && (b[1] & 0x80) != 0)) {
+            continue;
+        }
+        break;
+    }
+
+    if ((size_t)(end - b) > sizeof(long)) {
+        return -1;
+    }
+
+    // Sign extend.
+    unsigned long v = (*b & 0x80) ? ULONG_MAX : 0;
+    for (; b < end; b++) {
+        v = (v << 8) | *b;
+    }
+
+    *out = (long)v;
+    return 0;
+}
+
+// See comment in header
+int receipt_attribute_iterator_init(receipt_attribute_iterator *it, const uint8_t *data, size_t len) {
+    const uint8_t *p = data;
+    der_tlv set;
+
+    if (data == NULL || der_read_tlv(&p, data + len, &set) != 0 || set.tag != DER_TAG_SET) {
+        it->next = NULL;
+        it->end = NULL;
+        return -1;
+    }
+
+    it->next = set.value;
+    it->end = set.value + set.len;
+    return 0;
+}
+
+// See comment in header
+int receipt_attribute_iterator_next(receipt_attribute_iterator *it, receipt_attribute *attr) {
+    if (it->next == it->end) {
+        return 0;
+    }
+
+    der_tlv seq, type, version, value;
+    const uint8_t *p = it->next;
+
+    if (der_read_tlv(&p, it->end, &seq) != 0 || seq.tag != DER_TAG_SEQUENCE) {
+        return -1;
+    }
+
+    const uint8_t *q = seq.value;
+    const uint8_t *seq_end = seq.value + seq.len;
+
+    if (der_read_tlv(&q, seq_end, &type) != 0 || type.tag != DER_TAG_INTEGER ||
+        der_read_tlv(&q, seq_end, &version) != 0 || version.tag != DER_TAG_INTEGER ||
+        der_read_tlv(&q, seq_end, &value) != 0 || value.tag != DER_TAG_OCTET_STRING ||
+        q != seq_end) {
+        return -1;
+    }
+
+    if (der_integer_value(type.value, type.len, &attr->type) != 0 ||
+        der_integer_value(version.value, version.len, &attr->version) != 0) {
+        return -1;
+    }
+
+    attr->value = value.value;
+    attr->value_len = value.len;
+
+    it->next = p;
+
+    return 1;
+}
+
+// See comment in header
+long receipt_attributes_validate(const uint8_t *data, size_t len) {
+    receipt_attribute_iterator it;
+    receipt_attribute attr;
+    long count = 0;
+    int ret;
+
+    if (receipt_attribute_iterator_init(&it, data, len) != 0) {
+        return -1;
+    }
+
+    while ((ret = receipt_attribute_iterator_next(&it, &attr)) == 1) {
+        count++;
+    }
+
+    return (ret == 0) ? count : -1;
+}
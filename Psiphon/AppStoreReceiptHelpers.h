@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AppStoreReceiptHelpers_h
+#define AppStoreReceiptHelpers_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// DER identifier octets used by the receipt.
+#define DER_TAG_INTEGER 0x02
+#define DER_TAG_OCTET_STRING 0x04
+#define DER_TAG_OBJECT_IDENTIFIER 0x06
+#define DER_TAG_UTF8_STRING 0x0C
+#define DER_TAG_IA5_STRING 0x16
+#define DER_TAG_SEQUENCE 0x30
+#define DER_TAG_SET 0x31
+#define DER_TAG_CONTEXT_0 0xA0
+
+/// Constructed bit of the identifier octet.
+#define DER_CONSTRUCTED 0x20
+
+/*!
+ * @brief View of a DER encoded TLV (tag, length, value) into the encoded buffer.
+ */
+typedef struct {
+    /// Identifier octet. Only the low-tag-number form is supported.
+    uint8_t tag;
+    /// Pointer to the value in the encoded buffer.
+    const uint8_t *value;
+    /// Length of the value.
+    size_t len;
+} der_tlv;
+
+/*!
+ * @brief Reads the DER encoded TLV at `*p` and advances `*p` past it.
+ *
+ * Only definite lengths are accepted, and the value must lie within `end`.
+ *
+ * @param p Pointer to the TLV. Advanced past the TLV on success, unchanged on failure.
+ * @param end End of the encoded buffer.
+ * @param tlv Populated on success.
+ * @return 0 on success, -1 if the TLV is malformed or truncated.
+ */
+int der_read_tlv(const uint8_t **p, const uint8_t *end, der_tlv *tlv);
+
+/*!
+ * @brief Reads the identifier and length octets of the BER encoded TLV at `*p` and advances `*p` to its value.
+ *
+ * Unlike `der_read_tlv` the indefinite length is accepted on constructed TLVs, in which case `tlv->len` is
+ * `BER_INDEFINITE_LENGTH` and the value extends to the matching end-of-contents octets.
+ * A definite length value must lie within `end`.
+ *
+ * @return 0 on success, -1 if the header is malformed or truncated.
+ */
+int ber_read_header(const uint8_t **p, const uint8_t *end, der_tlv *tlv);
+
+/// `der_tlv.len` of a TLV with the indefinite length.
+#define BER_INDEFINITE_LENGTH SIZE_MAX
+
+/*!
+ * @brief Advances `*p` past the BER encoded TLV at `*p`, including any nested indefinite length TLVs.
+ *
+ * @return 0 on success, -1 if the TLV is malformed, truncated or nested too deeply.
+ */
+int ber_skip_tlv(const uint8_t **p, const uint8_t *end);
+
+/*!
+ * @brief Result of `receipt_pkcs7_content`.
+ */
+typedef enum {
+    /// The content was found and points into the receipt.
+    RECEIPT_CONTENT_OK = 0,
+    /// The content is a constructed OCTET STRING of more than one segment, which must be joined by
+    /// decoding the receipt fully.
+    RECEIPT_CONTENT_SEGMENTED = 1,
+    /// The receipt is malformed, or encoded in a form not handled by the scan.
+    RECEIPT_CONTENT_ERROR = -1,
+} receipt_content_result;
+
+/*!
+ * @brief Locates the content of a PKCS#7 SignedData receipt without decoding the rest of it.
+ *
+ * Only the TLV headers from the start of the receipt to `content.contentInfo.contentData` are read, and the
+ * digest algorithms are skipped over. The certificates, CRLs and signer infos which follow the content are
+ * not read at all, so the receipt signature is not checked: callers which validate the receipt must decode
+ * it fully.
+ *
+ * @param content Set to the DER encoded `ReceiptAttributes`, pointing into `data`, on `RECEIPT_CONTENT_OK`.
+ * @param content_len Set to the length of the content on `RECEIPT_CONTENT_OK`.
+ */
+receipt_content_result receipt_pkcs7_content(const uint8_t *data, size_t len,
+                                             const uint8_t **content, size_t *content_len);
+
+/*!
+ * @brief Reads the value of a DER encoded INTEGER into a long.
+ *
+ * Same conversion as the asn1c NativeInteger decoder: leading sign extension octets are ignored, and an
+ * empty value is 0.
+ *
+ * @return 0 on success, -1 if the value does not fit a long.
+ */
+int der_integer_value(const uint8_t *value, size_t len, long *out);
+
+/*!
+ * @brief A receipt attribute, with its value pointing into the receipt.
+ *
+ * ReceiptAttribute ::= SEQUENCE {
+ *     type    INTEGER,
+ *     version INTEGER,
+ *     value   OCTET STRING }
+ */
+typedef struct {
+    long type;
+    long version;
+    const uint8_t *value;
+    size_t value_len;
+} receipt_attribute;
+
+/*!
+ * @brief Iterator over the receipt attributes in a DER encoded `ReceiptAttributes ::= SET OF ReceiptAttribute`.
+ *
+ * Used for both the receipt payload and the in-app purchase receipts it contains. Makes no allocations.
+ */
+typedef struct {
+    const uint8_t *next;
+    const uint8_t *end;
+} receipt_attribute_iterator;
+
+/*!
+ * @brief Initializes the iterator over the SET OF receipt attributes at the start of `data`.
+ *
+ * Bytes following the SET are ignored.
+ *
+ * @return 0 on success, -1 if `data` does not start with a SET.
+ */
+int receipt_attribute_iterator_init(receipt_attribute_iterator *it, const uint8_t *data, size_t len);
+
+/*!
+ * @brief Reads the next receipt attribute.
+ *
+ * @param it Iterator.
+ * @param attr Populated with the next attribute. Its value points into the buffer passed to
+ * `receipt_attribute_iterator_init`.
+ * @return 1 if an attribute was read, 0 at the end of the SET, or -1 if the attribute is malformed in which
+ * case the iterator must not be used further.
+ */
+int receipt_attribute_iterator_next(receipt_attribute_iterator *it, receipt_attribute *attr);
+
+/*!
+ * @brief Checks that every receipt attribute in the SET at the start of `data` is well formed.
+ *
+ * Allows callers to preserve all-or-nothing semantics while still iterating without allocations.
+ *
+ * @return Number of attributes, or -1 if the SET or any attribute is malformed.
+ */
+long receipt_attributes_validate(const uint8_t *data, size_t len);
+
+#endif /* AppStoreReceiptHelpers_h */
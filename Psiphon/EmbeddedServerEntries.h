@@ -28,15 +28,124 @@ typedef NS_ERROR_ENUM(EmbeddedServerEntriesErrorDomain, EmbeddedServerEntriesErr
     EmbeddedServerEntriesErrorDecodingError = 2
 };
 
+/// Per-region entry counts and duplicate IP addresses of an embedded server entries file.
+@interface EmbeddedServerEntriesStatistics : NSObject
+
+/// Number of server entries successfully decoded.
+@property (nonatomic, readonly) NSUInteger entryCount;
+
+/// Number of server entries in each region, including duplicates. Any string region is counted, including an empty one.
+@property (nonatomic, readonly) NSDictionary<NSString*, NSNumber*> *regionCounts;
+
+/// Number of server entries whose IP address is the same as that of an earlier server entry.
+@property (nonatomic, readonly) NSUInteger duplicateCount;
+
+/// IP addresses of the first duplicate server entries, up to 100.
+@property (nonatomic, readonly) NSArray<NSString*> *duplicateIPAddresses;
+
+/// TRUE if the file has more distinct IP addresses than duplicate detection keeps (about a million), in which case
+/// duplicates of the IP addresses past that limit are not counted.
+@property (nonatomic, readonly) BOOL ipAddressLimitReached;
+
+@end
+
 @interface EmbeddedServerEntries : NSObject
 
 /// Decode embedded server entries file and return set of all egress regions available in the decoded entries.
+///
+/// The file may either be in the hex line format, or the binary container format generated by `convert_server_entries.py`.
+///
+/// Regions are read from the index generated at build time if present, otherwise from a cache in the caches directory
+/// keyed by the identity and contents of the file. The file is only decoded if both miss, in which case the decoded regions
+/// are written to the cache file `embedded_server_entries_regions.cache` in the caches directory, replacing any previous
+/// cache. Use `egressRegionsFromFile:cachePath:error:` with a nil cache path to always decode the file without writing a cache.
 /// @param filePath Path to embedded server entries file.
 /// @param outError Non-nil if an error occurs. If some server entries were successfully decoded before the error occured, then they
 /// will still be returned.
 /// @return Set of all egress regions with a corresponding server entry.
 + (NSSet*)egressRegionsFromFile:(NSString*)filePath error:(NSError * _Nullable *)outError;
 
+/// Same as `egressRegionsFromFile:error:`, but with the cache stored at `cachePath`.
+/// @param filePath Path to embedded server entries file.
+/// @param cachePath Path to cache file. Created if missing or stale. If nil, no cache is used.
+/// @param outError Non-nil if an error occurs. If some server entries were successfully decoded before the error occured, then they
+/// will still be returned.
+/// @return Set of all egress regions with a corresponding server entry.
++ (NSSet*)egressRegionsFromFile:(NSString*)filePath
+                      cachePath:(NSString * _Nullable)cachePath
+                          error:(NSError * _Nullable *)outError;
+
+/// Same as `egressRegionsFromFile:error:` without a cache, but splits the file into chunks of whole lines which are decoded concurrently
+/// on up to `maxConcurrency` threads. Results, including the line number reported in `outError`, are identical to decoding
+/// the file serially.
+/// `egressRegionsFromFile:error:` uses the number of active processors.
+/// @param filePath Path to embedded server entries file.
+/// @param maxConcurrency Maximum number of chunks decoded concurrently. Small files are always decoded serially.
+/// @param outError Non-nil if an error occurs. If some server entries were successfully decoded before the error occured, then they
+/// will still be returned.
+/// @return Set of all egress regions with a corresponding server entry.
++ (NSSet*)egressRegionsFromFile:(NSString*)filePath
+                 maxConcurrency:(NSUInteger)maxConcurrency
+                          error:(NSError * _Nullable *)outError;
+
+/// Decode embedded server entries file and count the server entries in each region and those with duplicate IP addresses,
+/// in a single pass. Unlike `egressRegionsFromFile:error:` neither the index nor the cache is used.
+///
+/// Duplicates are detected exactly with a set of the IP addresses seen. Its memory grows with the number of distinct IP
+/// addresses up to a limit, see `ipAddressLimitReached`.
+/// @param filePath Path to embedded server entries file.
+/// @param outError Non-nil if an error occurs. If some server entries were successfully decoded before the error occured, then they
+/// will still be counted.
+/// @return Statistics of the decoded server entries.
++ (EmbeddedServerEntriesStatistics*)statisticsFromFile:(NSString*)filePath error:(NSError * _Nullable *)outError;
+
+/// Number of times regions were read from the build time index (`indexHits`), and the number of hits
+/// and misses of the regions cache (`cacheHits`, `cacheMisses`) since launch. Included in feedback diagnostics.
++ (NSDictionary<NSString*, NSNumber*>*)cacheStatistics;
+
+@end
+
+/// Decoded, in-memory table of embedded server entries which can be filtered by region and capabilities
+/// without decoding the server entries file again.
+///
+/// Only the legacy fields (IP address, web server port, secret and certificate), the region and the
+/// capabilities of each server entry are kept. Entries are identified by their index in the file.
+@interface EmbeddedServerEntryTable : NSObject
+
+/// Number of server entries in the table.
+@property (nonatomic, readonly) NSUInteger count;
+
+/// Regions with at least one server entry, in order of first occurrence.
+@property (nonatomic, readonly) NSArray<NSString*> *regions;
+
+/// Decode embedded server entries file into a table.
+///
+/// The file may either be in the hex line format, or the binary container format generated by `convert_server_entries.py`.
+/// Any string region is accepted. A server entry whose IP address is not printable ASCII is a decoding error.
+/// @param filePath Path to embedded server entries file.
+/// @param outError Non-nil if an error occurs. If some server entries were successfully decoded before the error occured, then they
+/// will still be in the returned table.
+/// @return Table of decoded server entries.
++ (EmbeddedServerEntryTable*)tableFromFile:(NSString*)filePath error:(NSError * _Nullable *)outError;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Returns the indices of server entries in `region` which support all of `capabilities`.
+/// @param region Region code, or nil for all regions.
+/// @param capabilities Capability names as they appear in the server entry, e.g. "OSSH" or "QUIC". Empty to match all entries.
+/// Capabilities that are not known to the table match no entries.
+/// @return Indices of matching server entries.
+- (NSIndexSet*)entriesInRegion:(NSString * _Nullable)region supportingCapabilities:(NSArray<NSString*>*)capabilities;
+
+/// IP address of server entry at `index`, which must be less than `count`.
+- (NSString*)ipAddressAtIndex:(NSUInteger)index;
+
+/// Web server port of server entry at `index`, which must be less than `count`, or 0 if the server entry does not have a valid port.
+- (uint16_t)webServerPortAtIndex:(NSUInteger)index;
+
+/// Region of server entry at `index`, which must be less than `count`.
+- (NSString*)regionAtIndex:(NSUInteger)index;
+
 @end
 
 NS_ASSUME_NONNULL_END
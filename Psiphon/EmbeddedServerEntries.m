@@ -19,123 +19,756 @@
 
 #import "EmbeddedServerEntries.h"
 #import "EmbeddedServerEntriesHelpers.h"
+#import "EmbeddedServerEntriesStats.h"
+#import "EmbeddedServerEntriesTable.h"
 #import "NSError+Convenience.h"
+#import <stdatomic.h>
 
 #define kEmbeddedServerEntryRegionJsonKey @"region"
+#define kEmbeddedServerEntryRegionJsonKeyCString "region"
+#define kEmbeddedServerEntryCapabilitiesJsonKey @"capabilities"
+
+/// Suffix of the server entries index generated at build time by `gen_server_entries_index.py`,
+/// which is placed next to the server entries file.
+#define kEmbeddedServerEntriesIndexSuffix @".index"
+
+/// Files are only split into chunks that are at least this size, since
+/// decoding smaller files concurrently is not worth the overhead.
+#define kEmbeddedServerEntriesMinChunkSize (256 * 1024)
+
+/// File name of the cache of derived egress regions, which is kept in the caches directory.
+#define kEmbeddedServerEntriesCacheFileName @"embedded_server_entries_regions.cache"
+#define kEmbeddedServerEntriesCacheMagic "PSRC"
+#define kEmbeddedServerEntriesCacheVersion 1
+
+/// Maximum number of duplicate IP addresses listed by `EmbeddedServerEntriesStatistics`.
+#define kEmbeddedServerEntriesMaxListedDuplicates 100
 
 NSErrorDomain _Nonnull const EmbeddedServerEntriesErrorDomain = @"EmbeddedServerEntriesErrorDomain";
 
+// Counters reported by `cacheStatistics`.
+static atomic_ulong indexHits;
+static atomic_ulong cacheHits;
+static atomic_ulong cacheMisses;
+
+@interface EmbeddedServerEntriesStatistics ()
+
+@property (nonatomic, readwrite) NSUInteger entryCount;
+@property (nonatomic, readwrite) NSDictionary<NSString*, NSNumber*> *regionCounts;
+@property (nonatomic, readwrite) NSUInteger duplicateCount;
+@property (nonatomic, readwrite) NSArray<NSString*> *duplicateIPAddresses;
+@property (nonatomic, readwrite) BOOL ipAddressLimitReached;
+
+@end
+
+@implementation EmbeddedServerEntriesStatistics
+@end
+
+@interface EmbeddedServerEntries ()
+
++ (nonnull NSError *)fileError:(NSString*)format, ...;
++ (nonnull NSError *)decodingError:(NSString*)format, ...;
+
++ (void)enumerateEntriesInFile:(const server_entries_file *)file
+                      filePath:(NSString*)filePath
+                         error:(NSError * _Nullable *)outError
+                    usingBlock:(BOOL (^)(const char *entry, size_t len, unsigned long entryNumber,
+                                         NSError * _Nullable *error))block;
+
++ (NSString*)regionWithId:(int)regionId inRegions:(const server_entry_regions *)regions;
+
+@end
+
 @implementation EmbeddedServerEntries
 
 + (NSSet*)egressRegionsFromFile:(NSString*)filePath error:(NSError * _Nullable *)outError {
+    return [EmbeddedServerEntries egressRegionsFromFile:filePath
+                                              cachePath:[EmbeddedServerEntries defaultCachePath]
+                                                  error:outError];
+}
+
++ (NSSet*)egressRegionsFromFile:(NSString*)filePath
+                      cachePath:(NSString * _Nullable)cachePath
+                          error:(NSError * _Nullable *)outError {
+    return [EmbeddedServerEntries egressRegionsFromFile:filePath
+                                              cachePath:cachePath
+                                         maxConcurrency:[[NSProcessInfo processInfo] activeProcessorCount]
+                                                  error:outError];
+}
+
++ (NSSet*)egressRegionsFromFile:(NSString*)filePath
+                 maxConcurrency:(NSUInteger)maxConcurrency
+                          error:(NSError * _Nullable *)outError {
+    return [EmbeddedServerEntries egressRegionsFromFile:filePath
+                                              cachePath:nil
+                                         maxConcurrency:maxConcurrency
+                                                  error:outError];
+}
+
++ (NSSet*)egressRegionsFromFile:(NSString*)filePath
+                      cachePath:(NSString * _Nullable)cachePath
+                 maxConcurrency:(NSUInteger)maxConcurrency
+                          error:(NSError * _Nullable *)outError {
 
     *outError = nil;
 
     NSMutableSet *egressRegions = [[NSMutableSet alloc] init];
 
-    FILE * fp;
-    char * line = NULL;
-    size_t len = 0;
-    ssize_t nread;
+    server_entries_file file;
 
-    fp = fopen([filePath UTF8String], "r");
-    if (fp == NULL) {
+    errno = 0;
+    if (server_entries_file_map([filePath UTF8String], &file) != 0) {
         *outError = [EmbeddedServerEntries
-                     fileError:@"Error failed to open embedded server entry file at path (%@).",
-                     filePath];
+                     fileError:@"Error failed to open embedded server entry file at path (%@): %s.",
+                     filePath,
+                     strerror(errno)];
         return egressRegions;
     }
 
+    // Regions are read from the index generated at build time if there is one
+    // for this file, since unlike the cache it is not written at runtime.
+    // Otherwise they are read from the cache, and only if that misses is every
+    // server entry decoded.
+    // The whole file is hashed once for both the index and the cache key.
+    NSString *indexPath = [filePath stringByAppendingString:kEmbeddedServerEntriesIndexSuffix];
+    uint64_t contentHash = server_entries_content_hash(file.data, file.len);
+    if ([EmbeddedServerEntries addEgressRegionsFromIndex:indexPath
+                                                  source:&file
+                                             contentHash:contentHash
+                                                   toSet:egressRegions]) {
+        atomic_fetch_add(&indexHits, 1);
+    } else {
+        NSData *cacheKey = nil;
+        NSSet *cachedRegions = nil;
+
+        if (cachePath != nil) {
+            cacheKey = [EmbeddedServerEntries cacheKeyForFile:&file contentHash:contentHash];
+            cachedRegions = [EmbeddedServerEntries regionsFromCache:cachePath key:cacheKey];
+            atomic_fetch_add((cachedRegions != nil) ? &cacheHits : &cacheMisses, 1);
+        }
+
+        if (cachedRegions != nil) {
+            [egressRegions unionSet:cachedRegions];
+        } else {
+            [EmbeddedServerEntries addEgressRegionsFromFile:&file
+                                                   filePath:filePath
+                                             maxConcurrency:maxConcurrency
+                                                      toSet:egressRegions
+                                                      error:outError];
+
+            // Partial results are not cached.
+            if (cachePath != nil && *outError == nil) {
+                [EmbeddedServerEntries writeRegions:egressRegions toCache:cachePath key:cacheKey];
+            }
+        }
+    }
+
     errno = 0;
-    unsigned long line_number = 1;
+    int ret = server_entries_file_unmap(&file);
+    if (ret != 0) {
+        *outError = [EmbeddedServerEntries
+                     fileError:@"Error unmapping embedded server entries file at path (%@): %s.",
+                     filePath,
+                     strerror(errno)];
+    }
 
-    while ((nread = getline(&line, &len, fp)) != -1) {
-        // Drop carriage return and newline if present.
-        // This is done by moving the null terminator and
-        // not reallocing.
-        drop_newline_and_carriage_return(line);
+    return egressRegions;
+}
 
-        errno = 0;
-        char *decoded = hex_decode(line);
-        if (decoded == NULL) {
-            *outError = [EmbeddedServerEntries
-                         decodingError:@"Error failed to hex decode line (%lu) in embedded server entries file at path (#%@): %s.",
-                         line_number,
-                         filePath,
-                         strerror(errno)];
-            break;
++ (EmbeddedServerEntriesStatistics*)statisticsFromFile:(NSString*)filePath error:(NSError * _Nullable *)outError {
+
+    *outError = nil;
+
+    EmbeddedServerEntriesStatistics *statistics = [[EmbeddedServerEntriesStatistics alloc] init];
+    statistics.regionCounts = @{};
+    statistics.duplicateIPAddresses = @[];
+
+    server_entries_file file;
+
+    errno = 0;
+    if (server_entries_file_map([filePath UTF8String], &file) != 0) {
+        *outError = [EmbeddedServerEntries
+                     fileError:@"Error failed to open embedded server entry file at path (%@): %s.",
+                     filePath,
+                     strerror(errno)];
+        return statistics;
+    }
+
+    // Updated by the enumeration block below.
+    __block server_entries_stats stats;
+    if (server_entries_stats_init(&stats) != 0) {
+        *outError = [EmbeddedServerEntries
+                     decodingError:@"Error failed to allocate statistics for embedded server entries file at path (%@).",
+                     filePath];
+        server_entries_file_unmap(&file);
+        return statistics;
+    }
+
+    NSMutableArray<NSString*> *duplicates = [NSMutableArray array];
+
+    [EmbeddedServerEntries enumerateEntriesInFile:&file
+                                         filePath:filePath
+                                            error:outError
+                                       usingBlock:^BOOL(const char *entry, size_t len, unsigned long entryNumber, NSError **error) {
+
+        int ret = server_entries_stats_add_entry(&stats, entry, len);
+
+        if (ret == SERVER_ENTRY_TABLE_NEEDS_PARSER) {
+            const char *json = server_entry_json_n(entry, len);
+            NSString *region = [EmbeddedServerEntries regionFromJson:json
+                                                              length:len - (json - entry)
+                                                          lineNumber:entryNumber
+                                                               error:error];
+            if (region == nil) {
+                return FALSE;
+            }
+            const char *regionCString = [region UTF8String];
+            ret = server_entries_stats_add(&stats, entry, len, regionCString, strlen(regionCString));
         }
 
-        char *json = server_entry_json(decoded);
-        if (json == NULL) {
-            *outError = [EmbeddedServerEntries
-                         decodingError:@"Error failed to find server entry in hex decoded line (#%lu) in embedded server entries file at path (%@).",
-                         line_number,
-                         filePath];
-            free(decoded);
-            break;
+        if (ret < 0) {
+            *error = [EmbeddedServerEntries
+                      decodingError:@"Error failed to count server entry (#%lu) in embedded server entries file at path (%@).",
+                      entryNumber,
+                      filePath];
+            return FALSE;
         }
 
-        NSData *jsonData = [NSData dataWithBytes:json length:strlen(json)];
-        free(decoded);
-        if (jsonData == nil) {
-            *outError = [EmbeddedServerEntries
-                         decodingError:@"Error failed to convert embedded server entry json data from line (#%lu) to NSData.",
-                         line_number];
+        if (ret == 1 && [duplicates count] < kEmbeddedServerEntriesMaxListedDuplicates) {
+            // IP address is the first legacy field, which `server_entries_stats_add` has found.
+            const char *delim = memchr(entry, ' ', len);
+            NSString *ipAddress = [[NSString alloc] initWithBytes:entry
+                                                           length:delim - entry
+                                                         encoding:NSUTF8StringEncoding];
+            if (ipAddress != nil) {
+                [duplicates addObject:ipAddress];
+            }
+        }
+
+        return TRUE;
+    }];
+
+    NSMutableDictionary<NSString*, NSNumber*> *regionCounts = [NSMutableDictionary dictionaryWithCapacity:stats.regions.count];
+    for (size_t i = 0; i < stats.regions.count; i++) {
+        // Regions of entries that failed to be counted have no entries.
+        if (stats.region_entry_counts[i] > 0) {
+            regionCounts[[EmbeddedServerEntries regionWithId:(int)i inRegions:&stats.regions]] =
+                @(stats.region_entry_counts[i]);
+        }
+    }
+
+    statistics.entryCount = stats.entry_count;
+    statistics.regionCounts = regionCounts;
+    statistics.duplicateCount = stats.duplicate_count;
+    statistics.duplicateIPAddresses = duplicates;
+    statistics.ipAddressLimitReached = (stats.ip_address_limit_reached != 0);
+
+    server_entries_stats_free(&stats);
+
+    errno = 0;
+    int ret = server_entries_file_unmap(&file);
+    if (ret != 0) {
+        *outError = [EmbeddedServerEntries
+                     fileError:@"Error unmapping embedded server entries file at path (%@): %s.",
+                     filePath,
+                     strerror(errno)];
+    }
+
+    return statistics;
+}
+
++ (NSDictionary<NSString*, NSNumber*>*)cacheStatistics {
+    return @{
+        @"indexHits": @(atomic_load(&indexHits)),
+        @"cacheHits": @(atomic_load(&cacheHits)),
+        @"cacheMisses": @(atomic_load(&cacheMisses))
+    };
+}
+
+#pragma mark - Cache
+
++ (NSString*)defaultCachePath {
+    NSString *cachesDir = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    return [cachesDir stringByAppendingPathComponent:kEmbeddedServerEntriesCacheFileName];
+}
+
+/// Returns the cache key of `file`, whose `server_entries_content_hash` is `contentHash`. The key is also the
+/// header of the cache file.
+///
+/// Cache file layout, in host byte order:
+///   char[4] magic, uint32 version,
+///   uint64 inode, uint64 size, int64 mtime seconds, int64 mtime nanoseconds, uint64 content hash,
+///   uint32 region count, then for each region: uint32 length followed by the UTF-8 region code.
++ (NSData*)cacheKeyForFile:(const server_entries_file *)file contentHash:(uint64_t)contentHash {
+    NSMutableData *key = [NSMutableData dataWithCapacity:48];
+    uint32_t version = kEmbeddedServerEntriesCacheVersion;
+    uint64_t size = file->len;
+
+    [key appendBytes:kEmbeddedServerEntriesCacheMagic length:4];
+    [key appendBytes:&version length:sizeof(version)];
+    [key appendBytes:&file->inode length:sizeof(file->inode)];
+    [key appendBytes:&size length:sizeof(size)];
+    [key appendBytes:&file->mtime_sec length:sizeof(file->mtime_sec)];
+    [key appendBytes:&file->mtime_nsec length:sizeof(file->mtime_nsec)];
+    [key appendBytes:&contentHash length:sizeof(contentHash)];
+
+    return key;
+}
+
+/// Returns cached regions if the cache at `cachePath` was written for `key`, otherwise nil.
++ (NSSet * _Nullable)regionsFromCache:(NSString*)cachePath key:(NSData*)key {
+    NSData *cache = [NSData dataWithContentsOfFile:cachePath options:NSDataReadingUncached error:nil];
+    if (cache == nil || [cache length] < [key length] + sizeof(uint32_t) ||
+        memcmp(cache.bytes, key.bytes, [key length]) != 0) {
+        return nil;
+    }
+
+    const unsigned char *p = (const unsigned char *)cache.bytes + [key length];
+    const unsigned char *end = (const unsigned char *)cache.bytes + [cache length];
+
+    uint32_t count;
+    memcpy(&count, p, sizeof(count));
+    p += sizeof(count);
+
+    NSMutableSet *regions = [NSMutableSet setWithCapacity:MIN(count, 256)];
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t len;
+        if ((size_t)(end - p) < sizeof(len)) {
+            return nil;
+        }
+        memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+
+        if ((size_t)(end - p) < len) {
+            return nil;
+        }
+        NSString *region = [[NSString alloc] initWithBytes:p length:len encoding:NSUTF8StringEncoding];
+        if (region == nil) {
+            return nil;
+        }
+        [regions addObject:region];
+        p += len;
+    }
+
+    return (p == end) ? regions : nil;
+}
+
+/// Replaces the cache at `cachePath` with `regions` for `key`. Failures are ignored, the
+/// regions will be derived again on the next read.
++ (void)writeRegions:(NSSet*)regions toCache:(NSString*)cachePath key:(NSData*)key {
+    NSMutableData *cache = [NSMutableData dataWithData:key];
+
+    uint32_t count = (uint32_t)[regions count];
+    [cache appendBytes:&count length:sizeof(count)];
+
+    for (NSString *region in regions) {
+        NSData *bytes = [region dataUsingEncoding:NSUTF8StringEncoding];
+        uint32_t len = (uint32_t)[bytes length];
+        [cache appendBytes:&len length:sizeof(len)];
+        [cache appendData:bytes];
+    }
+
+    [cache writeToFile:cachePath atomically:YES];
+}
+
+#pragma mark - Index
+
+/// Adds all regions in the index at `indexPath` to `egressRegions`.
+/// @param contentHash `server_entries_content_hash` of `source`.
+/// @return FALSE if the index is missing, invalid or was not generated for `source`.
++ (BOOL)addEgressRegionsFromIndex:(NSString*)indexPath
+                           source:(const server_entries_file *)source
+                      contentHash:(uint64_t)contentHash
+                            toSet:(NSMutableSet*)egressRegions {
+
+    server_entries_index index;
+    if (server_entries_index_open([indexPath UTF8String], source, contentHash, &index) != 0) {
+        return FALSE;
+    }
+
+    for (uint32_t i = 0; i < index.region_count; i++) {
+        const char *name;
+        size_t name_len;
+        uint32_t entry_count, first_entry;
+        server_entries_index_region(&index, i, &name, &name_len, &entry_count, &first_entry);
+
+        NSString *region = [[NSString alloc] initWithBytes:name length:name_len encoding:NSUTF8StringEncoding];
+        if (region == nil) {
+            [egressRegions removeAllObjects];
+            server_entries_index_close(&index);
+            return FALSE;
+        }
+        [egressRegions addObject:region];
+    }
+
+    server_entries_index_close(&index);
+
+    return TRUE;
+}
+
+#pragma mark - Scanning
+
+/// Splits `file` into up to `maxConcurrency` chunks of whole lines, decodes them concurrently into
+/// per-chunk sets, and merges the sets into `egressRegions`.
+///
+/// Only the regions of lines before the first line that fails to decode are added. That chunk is
+/// decoded again once the number of lines preceding it is known, so that `outError` reports the same
+/// line number as a serial scan.
++ (void)addEgressRegionsFromFile:(const server_entries_file *)file
+                        filePath:(NSString*)filePath
+                  maxConcurrency:(NSUInteger)maxConcurrency
+                           toSet:(NSMutableSet*)egressRegions
+                           error:(NSError * _Nullable *)outError {
+
+    if (server_entries_is_binary(file->data, file->len)) {
+        // Entries are length prefixed, so the binary format is not split into chunks.
+        [EmbeddedServerEntries enumerateEntriesInFile:file
+                                             filePath:filePath
+                                                error:outError
+                                           usingBlock:^BOOL(const char *entry, size_t len, unsigned long entryNumber, NSError **error) {
+            return [EmbeddedServerEntries addRegionOfEntry:entry
+                                                    length:len
+                                               entryNumber:entryNumber
+                                                  filePath:filePath
+                                                     toSet:egressRegions
+                                                     error:error];
+        }];
+        return;
+    }
+
+    size_t numChunks = MAX(1, MIN(maxConcurrency, file->len / kEmbeddedServerEntriesMinChunkSize));
+
+    if (numChunks == 1) {
+        [EmbeddedServerEntries addEgressRegionsFromLines:file->data
+                                                  length:file->len
+                                         firstLineNumber:1
+                                                filePath:filePath
+                                                   toSet:egressRegions
+                                                   error:outError];
+        return;
+    }
+
+    size_t *chunkStarts = malloc(sizeof(size_t) * (numChunks + 1));
+    unsigned long *chunkLines = calloc(numChunks, sizeof(unsigned long));
+    BOOL *chunkFailed = calloc(numChunks, sizeof(BOOL));
+    if (chunkStarts == NULL || chunkLines == NULL || chunkFailed == NULL) {
+        free(chunkStarts);
+        free(chunkLines);
+        free(chunkFailed);
+        // Not enough memory to split the file, decode it serially instead.
+        [EmbeddedServerEntries addEgressRegionsFromLines:file->data
+                                                  length:file->len
+                                         firstLineNumber:1
+                                                filePath:filePath
+                                                   toSet:egressRegions
+                                                   error:outError];
+        return;
+    }
+
+    for (size_t i = 0; i < numChunks; i++) {
+        chunkStarts[i] = line_start_at_or_after(file->data, file->len, (file->len / numChunks) * i);
+    }
+    chunkStarts[numChunks] = file->len;
+
+    NSMutableArray<NSMutableSet*> *chunkRegions = [NSMutableArray arrayWithCapacity:numChunks];
+    for (size_t i = 0; i < numChunks; i++) {
+        [chunkRegions addObject:[[NSMutableSet alloc] init]];
+    }
+
+    dispatch_apply(numChunks, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        NSError *chunkError = nil;
+        chunkLines[i] = [EmbeddedServerEntries addEgressRegionsFromLines:file->data + chunkStarts[i]
+                                                                  length:chunkStarts[i + 1] - chunkStarts[i]
+                                                         firstLineNumber:1
+                                                                filePath:filePath
+                                                                   toSet:chunkRegions[i]
+                                                                   error:&chunkError];
+        chunkFailed[i] = (chunkError != nil);
+    });
+
+    unsigned long lineNumber = 1;
+
+    for (size_t i = 0; i < numChunks; i++) {
+        if (chunkFailed[i]) {
+            // Decode the failed chunk again with its true starting line number.
+            [EmbeddedServerEntries addEgressRegionsFromLines:file->data + chunkStarts[i]
+                                                      length:chunkStarts[i + 1] - chunkStarts[i]
+                                             firstLineNumber:lineNumber
+                                                    filePath:filePath
+                                                       toSet:egressRegions
+                                                       error:outError];
             break;
         }
+        [egressRegions unionSet:chunkRegions[i]];
+        lineNumber += chunkLines[i];
+    }
 
-        NSError *error = nil;
-        NSDictionary *jsonObject = [NSJSONSerialization JSONObjectWithData:jsonData options:kNilOptions error:&error];
-        if (error != nil) {
-            *outError = [EmbeddedServerEntries
-                         decodingError:@"Error failed to serialize json object from decoded server entry on line (#%lu): %@.",
+    free(chunkStarts);
+    free(chunkLines);
+    free(chunkFailed);
+}
+
+/// Decodes each server entry line in `data` and adds its region to `egressRegions`.
+/// Stops at the first line that fails to decode, with `outError` set.
+/// @param firstLineNumber Line number of the first line in `data`, used in errors.
+/// @return Number of lines successfully decoded.
++ (unsigned long)addEgressRegionsFromLines:(const char *)data
+                                    length:(size_t)length
+                           firstLineNumber:(unsigned long)firstLineNumber
+                                  filePath:(NSString*)filePath
+                                     toSet:(NSMutableSet*)egressRegions
+                                     error:(NSError * _Nullable *)outError {
+
+    return [EmbeddedServerEntries enumerateEntriesInLines:data
+                                                   length:length
+                                          firstLineNumber:firstLineNumber
+                                                 filePath:filePath
+                                                    error:outError
+                                               usingBlock:^BOOL(const char *entry, size_t len, unsigned long entryNumber, NSError **error) {
+        return [EmbeddedServerEntries addRegionOfEntry:entry
+                                                length:len
+                                           entryNumber:entryNumber
+                                              filePath:filePath
+                                                 toSet:egressRegions
+                                                 error:error];
+    }];
+}
+
+/// Adds the region of the decoded server entry `entry` to `egressRegions`.
+/// @return FALSE with `outError` set if the region could not be found.
++ (BOOL)addRegionOfEntry:(const char *)entry
+                  length:(size_t)len
+             entryNumber:(unsigned long)entryNumber
+                filePath:(NSString*)filePath
+                   toSet:(NSMutableSet*)egressRegions
+                   error:(NSError * _Nullable *)outError {
+
+    const char *json = server_entry_json_n(entry, len);
+    if (json == NULL) {
+        *outError = [EmbeddedServerEntries
+                     decodingError:@"Error failed to find server entry in entry (#%lu) in embedded server entries file at path (%@).",
+                     entryNumber,
+                     filePath];
+        return FALSE;
+    }
+
+    NSString *region = [EmbeddedServerEntries regionFromJson:json
+                                                      length:len - (json - entry)
+                                                  lineNumber:entryNumber
+                                                       error:outError];
+    if (region == nil) {
+        return FALSE;
+    }
+    [egressRegions addObject:region];
+
+    return TRUE;
+}
+
+#pragma mark - Enumeration
+
+/// Calls `block` with each decoded server entry of `file`, which may be in either the hex line or the binary format.
+/// Stops at the first entry that fails to decode, or for which `block` returns FALSE, with `outError` set.
+/// The entry passed to `block` is not NULL terminated and is only valid for the duration of the call.
++ (void)enumerateEntriesInFile:(const server_entries_file *)file
+                      filePath:(NSString*)filePath
+                         error:(NSError * _Nullable *)outError
+                    usingBlock:(BOOL (^)(const char *entry, size_t len, unsigned long entryNumber,
+                                         NSError * _Nullable *error))block {
+
+    if (!server_entries_is_binary(file->data, file->len)) {
+        [EmbeddedServerEntries enumerateEntriesInLines:file->data
+                                                length:file->len
+                                       firstLineNumber:1
+                                              filePath:filePath
+                                                 error:outError
+                                            usingBlock:block];
+        return;
+    }
+
+    binary_entries_iterator it;
+    if (binary_entries_iterator_init(&it, file->data, file->len) != 0) {
+        *outError = [EmbeddedServerEntries
+                     decodingError:@"Error unsupported binary embedded server entries file at path (%@).",
+                     filePath];
+        return;
+    }
+
+    const char *entry;
+    size_t len;
+    unsigned long entry_number = 1;
+    int ret;
+
+    // Errors are held strongly outside of the autorelease pool below, which would otherwise release them.
+    NSError *error = nil;
+
+    while ((ret = binary_entries_iterator_next(&it, &entry, &len)) == 1) {
+        @autoreleasepool {
+            if (!block(entry, len, entry_number, &error)) {
+                break;
+            }
+            entry_number++;
+        }
+    }
+
+    if (error == nil && ret != 0) {
+        error = [EmbeddedServerEntries
+                 decodingError:@"Error malformed entry (#%lu) in binary embedded server entries file at path (%@).",
+                 entry_number,
+                 filePath];
+    }
+
+    if (error != nil) {
+        *outError = error;
+    }
+}
+
+/// Calls `block` with each hex decoded server entry line in `data`, which is in the hex line format.
+/// Stops at the first line that fails to decode, or for which `block` returns FALSE, with `outError` set.
+/// The entry passed to `block` is not NULL terminated and is only valid for the duration of the call.
+/// @param firstLineNumber Line number of the first line in `data`, passed to `block` and used in errors.
+/// @return Number of lines for which `block` returned TRUE.
++ (unsigned long)enumerateEntriesInLines:(const char *)data
+                                  length:(size_t)length
+                         firstLineNumber:(unsigned long)firstLineNumber
+                                filePath:(NSString*)filePath
+                                   error:(NSError * _Nullable *)outError
+                              usingBlock:(BOOL (^)(const char *entry, size_t len, unsigned long entryNumber,
+                                                   NSError * _Nullable *error))block {
+
+    // Scratch buffer that each line is hex decoded into. Reused across lines
+    // and only grown when a longer line is encountered.
+    char *decoded = NULL;
+    size_t decoded_cap = 0;
+
+    line_iterator it;
+    line_iterator_init(&it, data, length);
+
+    const char *line;
+    size_t len;
+    unsigned long line_number = firstLineNumber;
+
+    // Errors are held strongly outside of the autorelease pool below, which would otherwise release them.
+    NSError *error = nil;
+
+    while (line_iterator_next(&it, &line, &len) == 1) {
+        @autoreleasepool {
+
+            if ((len / 2) + 1 > decoded_cap) {
+                char *buf = realloc(decoded, (len / 2) + 1);
+                if (buf == NULL) {
+                    error = [EmbeddedServerEntries
+                             decodingError:@"Error failed to allocate buffer for line (%lu) in embedded server entries file at path (%@).",
+                             line_number,
+                             filePath];
+                    break;
+                }
+                decoded = buf;
+                decoded_cap = (len / 2) + 1;
+            }
+
+            errno = 0;
+            ssize_t decoded_len = hex_decode_buf(line, len, decoded);
+            if (decoded_len < 0) {
+                error = [EmbeddedServerEntries
+                         decodingError:@"Error failed to hex decode line (%lu) in embedded server entries file at path (#%@): %s.",
                          line_number,
-                         error];
-            break;
+                         filePath,
+                         strerror(errno)];
+                break;
+            }
+
+            if (!block(decoded, decoded_len, line_number, &error)) {
+                break;
+            }
+
+            line_number++;
+
         }
+    }
 
-        id regionObject = jsonObject[kEmbeddedServerEntryRegionJsonKey];
-        if (regionObject == nil) {
+    if (decoded != NULL) {
+        free(decoded);
+    }
+
+    if (error != nil) {
+        *outError = error;
+    }
+
+    return line_number - firstLineNumber;
+}
+
+#pragma mark - Helpers
+
+/// Returns the region of the server entry JSON, or nil with outError set.
+/// The JSON is scanned in place for the region key, only falling back to
+/// NSJSONSerialization when the scanner cannot produce a definitive result.
+/// @param json Pointer to server entry JSON. Must remain valid for the duration of the call.
++ (NSString * _Nullable)regionFromJson:(const char *)json
+                                length:(size_t)length
+                            lineNumber:(unsigned long)line_number
+                                 error:(NSError * _Nullable *)outError {
+
+    json_field field = { .key = kEmbeddedServerEntryRegionJsonKeyCString };
+
+    if (server_entry_json_scan(json, length, &field, 1) == JSON_SCAN_OK) {
+        if (field.type == JSON_VALUE_STRING) {
+            // Scanner only returns escape-free ASCII strings.
+            return [[NSString alloc] initWithBytes:field.value
+                                            length:field.value_len
+                                          encoding:NSASCIIStringEncoding];
+        } else if (field.type == JSON_VALUE_NONE) {
             *outError = [EmbeddedServerEntries
                          decodingError:@"Error failed to find region key (%@) in embedded server entry json on line (#%lu).",
                          kEmbeddedServerEntryRegionJsonKey,
                          line_number];
-            break;
-        } else if ([regionObject isKindOfClass:[NSString class]]) {
-            [egressRegions addObject:(NSString*)regionObject];
-        } else {
-            *outError = [EmbeddedServerEntries
-                         decodingError:@"Error region in embedded server entry on line (#%lu) is not NSString but %@.",
-                         line_number,
-                         [regionObject class]];
-            break;
+            return nil;
         }
-
-        line_number++;
+        // Wrong type. Defer to the full parser for the error.
     }
 
-    if (nread == -1 && errno != 0 && ferror(fp) != 0) {
+    // Wraps the JSON without copying. The data must not outlive this call.
+    NSData *jsonData = [NSData dataWithBytesNoCopy:(void *)json length:length freeWhenDone:NO];
+    if (jsonData == nil) {
         *outError = [EmbeddedServerEntries
-                     fileError:@"Error reading embedded server entries file at path (%@): %s.",
-                     filePath,
-                     strerror(errno)];
+                     decodingError:@"Error failed to convert embedded server entry json data from line (#%lu) to NSData.",
+                     line_number];
+        return nil;
     }
 
-    errno = 0;
-    int ret = fclose(fp);
-    if (ret != 0) {
+    NSError *error = nil;
+    NSDictionary *jsonObject = [NSJSONSerialization JSONObjectWithData:jsonData options:kNilOptions error:&error];
+    if (error != nil) {
         *outError = [EmbeddedServerEntries
-                     fileError:@"Error closing file stream for embedded server entries file at path (%@): %s.",
-                     filePath,
-                     strerror(errno)];
+                     decodingError:@"Error failed to serialize json object from decoded server entry on line (#%lu): %@.",
+                     line_number,
+                     error];
+        return nil;
     }
 
-    if (line != NULL) {
-        free(line);
+    id regionObject = jsonObject[kEmbeddedServerEntryRegionJsonKey];
+    if (regionObject == nil) {
+        *outError = [EmbeddedServerEntries
+                     decodingError:@"Error failed to find region key (%@) in embedded server entry json on line (#%lu).",
+                     kEmbeddedServerEntryRegionJsonKey,
+                     line_number];
+        return nil;
+    } else if (![regionObject isKindOfClass:[NSString class]]) {
+        *outError = [EmbeddedServerEntries
+                     decodingError:@"Error region in embedded server entry on line (#%lu) is not NSString but %@.",
+                     line_number,
+                     [regionObject class]];
+        return nil;
     }
 
-    return egressRegions;
+    return (NSString*)regionObject;
+}
+
+/// Region codes are either scanned from ASCII JSON or copied from an NSString, so they are valid UTF-8.
++ (NSString*)regionWithId:(int)regionId inRegions:(const server_entry_regions *)regions {
+    size_t len;
+    const char *code = server_entry_regions_code(regions, regionId, &len);
+    return [[NSString alloc] initWithBytes:code length:len encoding:NSUTF8StringEncoding];
 }
 
 #pragma mark - Error constructors
@@ -169,3 +802,203 @@ NSErrorDomain _Nonnull const EmbeddedServerEntriesErrorDomain = @"EmbeddedServer
 }
 
 @end
+
+#pragma mark - EmbeddedServerEntryTable
+
+@implementation EmbeddedServerEntryTable {
+    server_entry_table table;
+}
+
+- (instancetype)initEmpty {
+    self = [super init];
+    if (self) {
+        server_entry_table_init(&table);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    server_entry_table_free(&table);
+}
+
++ (EmbeddedServerEntryTable*)tableFromFile:(NSString*)filePath error:(NSError * _Nullable *)outError {
+
+    *outError = nil;
+
+    EmbeddedServerEntryTable *entryTable = [[EmbeddedServerEntryTable alloc] initEmpty];
+
+    server_entries_file file;
+
+    errno = 0;
+    if (server_entries_file_map([filePath UTF8String], &file) != 0) {
+        *outError = [EmbeddedServerEntries
+                     fileError:@"Error failed to open embedded server entry file at path (%@): %s.",
+                     filePath,
+                     strerror(errno)];
+        return entryTable;
+    }
+
+    [EmbeddedServerEntries enumerateEntriesInFile:&file
+                                         filePath:filePath
+                                            error:outError
+                                       usingBlock:^BOOL(const char *entry, size_t len, unsigned long entryNumber, NSError **error) {
+        return [entryTable addEntry:entry length:len number:entryNumber filePath:filePath error:error];
+    }];
+
+    errno = 0;
+    int ret = server_entries_file_unmap(&file);
+    if (ret != 0) {
+        *outError = [EmbeddedServerEntries
+                     fileError:@"Error unmapping embedded server entries file at path (%@): %s.",
+                     filePath,
+                     strerror(errno)];
+    }
+
+    return entryTable;
+}
+
+- (NSUInteger)count {
+    return table.count;
+}
+
+- (NSArray<NSString*>*)regions {
+    NSMutableArray<NSString*> *regions = [NSMutableArray arrayWithCapacity:table.regions.count];
+    for (size_t i = 0; i < table.regions.count; i++) {
+        [regions addObject:[EmbeddedServerEntries regionWithId:(int)i inRegions:&table.regions]];
+    }
+    return regions;
+}
+
+- (NSIndexSet*)entriesInRegion:(NSString * _Nullable)region supportingCapabilities:(NSArray<NSString*>*)capabilities {
+
+    NSMutableIndexSet *indices = [[NSMutableIndexSet alloc] init];
+
+    int regionId = SERVER_ENTRY_ANY_REGION;
+    if (region != nil) {
+        const char *regionCString = [region UTF8String];
+        regionId = server_entry_table_region_id(&table, regionCString, strlen(regionCString));
+        if (regionId < 0) {
+            return indices;
+        }
+    }
+
+    uint32_t capabilityMask = 0;
+    for (NSString *capability in capabilities) {
+        const char *capabilityCString = [capability UTF8String];
+        uint32_t bit = server_entry_capability_from_name(capabilityCString, strlen(capabilityCString));
+        if (bit == 0) {
+            return indices;
+        }
+        capabilityMask |= bit;
+    }
+
+    size_t matches = server_entry_table_query(&table, regionId, capabilityMask, NULL, 0);
+    if (matches == 0) {
+        return indices;
+    }
+
+    uint32_t *matchIndices = malloc(matches * sizeof(uint32_t));
+    if (matchIndices == NULL) {
+        return indices;
+    }
+
+    server_entry_table_query(&table, regionId, capabilityMask, matchIndices, matches);
+
+    // Indices are in table order, so add them in contiguous ranges.
+    size_t start = 0;
+    for (size_t i = 1; i <= matches; i++) {
+        if (i == matches || matchIndices[i] != matchIndices[i - 1] + 1) {
+            [indices addIndexesInRange:NSMakeRange(matchIndices[start], i - start)];
+            start = i;
+        }
+    }
+
+    free(matchIndices);
+
+    return indices;
+}
+
+- (NSString*)ipAddressAtIndex:(NSUInteger)index {
+    // `server_entry_table_append` only accepts printable ASCII IP addresses, so this is never nil.
+    return [[NSString alloc] initWithBytes:table.strings + table.ip_address_offset[index]
+                                    length:table.ip_address_len[index]
+                                  encoding:NSASCIIStringEncoding];
+}
+
+- (uint16_t)webServerPortAtIndex:(NSUInteger)index {
+    return table.web_server_port[index];
+}
+
+- (NSString*)regionAtIndex:(NSUInteger)index {
+    return [EmbeddedServerEntries regionWithId:(int)table.region_id[index] inRegions:&table.regions];
+}
+
+#pragma mark - Decoding
+
+/// Adds decoded server entry to the table. The JSON config is scanned in place, only falling back
+/// to NSJSONSerialization when the scanner cannot produce a definitive result.
+/// @return TRUE if the entry was added, otherwise FALSE with `outError` set.
+- (BOOL)addEntry:(const char *)entry
+          length:(size_t)len
+          number:(unsigned long)entry_number
+        filePath:(NSString*)filePath
+           error:(NSError * _Nullable *)outError {
+
+    server_entry_table_result result = server_entry_table_add(&table, entry, len);
+    if (result == SERVER_ENTRY_TABLE_OK) {
+        return TRUE;
+    }
+
+    const char *json = server_entry_json_n(entry, len);
+
+    if (result == SERVER_ENTRY_TABLE_NEEDS_PARSER && json != NULL) {
+
+        // Wraps the JSON without copying. The data must not outlive this call.
+        NSData *jsonData = [NSData dataWithBytesNoCopy:(void *)json length:len - (json - entry) freeWhenDone:NO];
+
+        NSError *error = nil;
+        NSDictionary *jsonObject = [NSJSONSerialization JSONObjectWithData:jsonData options:kNilOptions error:&error];
+        if (error != nil) {
+            *outError = [EmbeddedServerEntries
+                         decodingError:@"Error failed to serialize json object from decoded server entry (#%lu): %@.",
+                         entry_number,
+                         error];
+            return FALSE;
+        }
+
+        id regionObject = jsonObject[kEmbeddedServerEntryRegionJsonKey];
+        if (![regionObject isKindOfClass:[NSString class]]) {
+            *outError = [EmbeddedServerEntries
+                         decodingError:@"Error region in embedded server entry (#%lu) is not NSString but %@.",
+                         entry_number,
+                         [regionObject class]];
+            return FALSE;
+        }
+
+        uint32_t capabilities = 0;
+        id capabilitiesObject = jsonObject[kEmbeddedServerEntryCapabilitiesJsonKey];
+        if ([capabilitiesObject isKindOfClass:[NSArray class]]) {
+            for (id capability in (NSArray*)capabilitiesObject) {
+                if ([capability isKindOfClass:[NSString class]]) {
+                    const char *capabilityCString = [(NSString*)capability UTF8String];
+                    capabilities |= server_entry_capability_from_name(capabilityCString, strlen(capabilityCString));
+                }
+            }
+        }
+
+        const char *region = [(NSString*)regionObject UTF8String];
+
+        result = server_entry_table_append(&table, entry, len, region, strlen(region), capabilities);
+        if (result == SERVER_ENTRY_TABLE_OK) {
+            return TRUE;
+        }
+    }
+
+    *outError = [EmbeddedServerEntries
+                 decodingError:@"Error failed to add server entry (#%lu) in embedded server entries file at path (%@) to table.",
+                 entry_number,
+                 filePath];
+    return FALSE;
+}
+
+@end
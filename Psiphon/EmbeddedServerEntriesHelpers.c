@@ -19,49 +19,262 @@
 
 #import "EmbeddedServerEntriesHelpers.h"
 #import <errno.h>
+#import <fcntl.h>
 #import <stdlib.h>
 #import <string.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+#if defined(__AVX2__)
+#import <immintrin.h>
+#define HEX_DECODE_VECTORIZED 1
+#elif defined(__SSE2__)
+#import <emmintrin.h>
+#define HEX_DECODE_VECTORIZED 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#import <arm_neon.h>
+#define HEX_DECODE_VECTORIZED 1
+#else
+#define HEX_DECODE_VECTORIZED 0
+#endif
 
 // Forward declarations of helpers
 void drop_last_char_if_char(char *s, int c);
 char * strchrn(char const *s, int c, int n);
 
+// Maps each byte to its hex nibble value, or XX (0xFF) if it is not a hex character.
+#define XX 0xFF
+static const unsigned char hex_table[256] = {
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, XX, XX, XX, XX, XX, XX,
+    XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+};
+#undef XX
+
+#if defined(__AVX2__)
+
+/*!
+ * @brief Decodes 32 hex characters into 16 bytes using AVX2.
+ * @return 0 on success, -1 if a character is not hex or a decoded byte is zero.
+ */
+static inline int hex_decode_32(const char *s, char *out) {
+    const __m256i chars = _mm256_loadu_si256((const __m256i *)s);
+    const __m256i bias = _mm256_set1_epi8((char)0x80);
+
+    // Unsigned range checks are done as signed comparisons on biased values.
+    const __m256i digits = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    const __m256i is_digit = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(0x80 + 10)),
+                                               _mm256_xor_si256(digits, bias));
+    const __m256i letters = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)),
+                                            _mm256_set1_epi8('a'));
+    const __m256i is_letter = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(0x80 + 6)),
+                                                _mm256_xor_si256(letters, bias));
+
+    if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)) != -1) {
+        return -1;
+    }
+
+    const __m256i nibbles =
+        _mm256_or_si256(_mm256_and_si256(is_digit, digits),
+                        _mm256_and_si256(is_letter, _mm256_add_epi8(letters, _mm256_set1_epi8(10))));
+
+    // Each 16-bit lane holds the high nibble in its low byte and the low nibble in its high byte.
+    const __m256i bytes = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(nibbles, _mm256_set1_epi16(0x00FF)), 4),
+                                          _mm256_srli_epi16(nibbles, 8));
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(bytes, bytes), 0x08);
+    const __m128i decoded = _mm256_castsi256_si128(packed);
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(decoded, _mm_setzero_si128())) != 0) {
+        return -1;
+    }
+
+    _mm_storeu_si128((__m128i *)out, decoded);
+    return 0;
+}
+
+#elif defined(__SSE2__)
+
+/*!
+ * @brief Converts 16 hex characters into 8 bytes held in the low half of each 16-bit lane.
+ * @return 0 on success, -1 if a character is not hex.
+ */
+static inline int hex_nibbles_16(__m128i chars, __m128i *bytes) {
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+
+    // Unsigned range checks are done as signed comparisons on biased values.
+    const __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i is_digit = _mm_cmplt_epi8(_mm_xor_si128(digits, bias),
+                                            _mm_set1_epi8((char)(0x80 + 10)));
+    const __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+                                         _mm_set1_epi8('a'));
+    const __m128i is_letter = _mm_cmplt_epi8(_mm_xor_si128(letters, bias),
+                                             _mm_set1_epi8((char)(0x80 + 6)));
+
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF) {
+        return -1;
+    }
+
+    const __m128i nibbles =
+        _mm_or_si128(_mm_and_si128(is_digit, digits),
+                     _mm_and_si128(is_letter, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+
+    // Each 16-bit lane holds the high nibble in its low byte and the low nibble in its high byte.
+    *bytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4),
+                          _mm_srli_epi16(nibbles, 8));
+    return 0;
+}
+
+/*!
+ * @brief Decodes 32 hex characters into 16 bytes using SSE2.
+ * @return 0 on success, -1 if a character is not hex or a decoded byte is zero.
+ */
+static inline int hex_decode_32(const char *s, char *out) {
+    __m128i lo, hi;
+    if (hex_nibbles_16(_mm_loadu_si128((const __m128i *)s), &lo) != 0 ||
+        hex_nibbles_16(_mm_loadu_si128((const __m128i *)(s + 16)), &hi) != 0) {
+        return -1;
+    }
+
+    const __m128i decoded = _mm_packus_epi16(lo, hi);
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(decoded, _mm_setzero_si128())) != 0) {
+        return -1;
+    }
+
+    _mm_storeu_si128((__m128i *)out, decoded);
+    return 0;
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+/*!
+ * @brief Converts 16 hex characters into their nibble values using NEON.
+ * @return 0 on success, -1 if a character is not hex.
+ */
+static inline int hex_nibbles_16(uint8x16_t chars, uint8x16_t *nibbles) {
+    const uint8x16_t digits = vsubq_u8(chars, vdupq_n_u8('0'));
+    const uint8x16_t is_digit = vcltq_u8(digits, vdupq_n_u8(10));
+    const uint8x16_t letters = vsubq_u8(vorrq_u8(chars, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    const uint8x16_t is_letter = vcltq_u8(letters, vdupq_n_u8(6));
+
+    if (vminvq_u8(vorrq_u8(is_digit, is_letter)) != 0xFF) {
+        return -1;
+    }
+
+    *nibbles = vorrq_u8(vandq_u8(is_digit, digits),
+                        vandq_u8(is_letter, vaddq_u8(letters, vdupq_n_u8(10))));
+    return 0;
+}
+
+/*!
+ * @brief Decodes 32 hex characters into 16 bytes using NEON.
+ * @return 0 on success, -1 if a character is not hex or a decoded byte is zero.
+ */
+static inline int hex_decode_32(const char *s, char *out) {
+    // De-interleaves high nibble characters into val[0] and low nibble characters into val[1].
+    const uint8x16x2_t chars = vld2q_u8((const uint8_t *)s);
+
+    uint8x16_t hi, lo;
+    if (hex_nibbles_16(chars.val[0], &hi) != 0 || hex_nibbles_16(chars.val[1], &lo) != 0) {
+        return -1;
+    }
+
+    const uint8x16_t decoded = vorrq_u8(vshlq_n_u8(hi, 4), lo);
+
+    if (vminvq_u8(decoded) == 0) {
+        return -1;
+    }
+
+    vst1q_u8((uint8_t *)out, decoded);
+    return 0;
+}
+
+#endif
+
 // See comment in header
-char * hex_decode(const char *s) {
-    if (s == NULL) {
-        return NULL;
+ssize_t hex_decode_buf(const char *s, size_t len, char *out) {
+    if (s == NULL || out == NULL) {
+        errno = EINVAL;
+        return -1;
     }
 
     // Must have an even length.
-    if (strlen(s) % 2 != 0) {
-        return NULL;
+    if (len % 2 != 0) {
+        errno = EINVAL;
+        return -1;
     }
 
-    unsigned long decoded_len = (strlen(s)/2) + 1;
-    char *decoded = (char*)malloc(sizeof(char) * decoded_len);
-    char *p = decoded;
+    size_t i = 0;
 
-    for (int i = 0; i < strlen(s); (i+=2)) {
+#if HEX_DECODE_VECTORIZED
+    // Each step reads 32 hex characters before writing the 16 bytes they decode to,
+    // which never overtakes unread input when decoding in place.
+    for (; i + 32 <= len; i += 32) {
+        if (hex_decode_32(s + i, out + (i / 2)) != 0) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+#endif
+
+    for (; i < len; i += 2) {
         // Each hex character represents 4 bits of data.
         // Thus, each two characters represents 1 byte of data
         // which corresponds to one character.
-        char hex[3];
-        memcpy(hex, s + i, sizeof(char) * 2);
-        hex[2] = '\0';
-
-        errno = 0;
-        long val = strtol(hex, NULL, 16);
-        if (val == 0 || errno != 0) {
+        const unsigned char hi = hex_table[(unsigned char)s[i]];
+        const unsigned char lo = hex_table[(unsigned char)s[i + 1]];
+        const unsigned char val = (unsigned char)((hi << 4) | lo);
+        if (((hi | lo) & 0xF0) != 0 || val == 0) {
             // Failed to decode string. Defer error
             // handling to the caller.
-            free(decoded);
-            return NULL;
+            errno = EINVAL;
+            return -1;
         }
-        *p = (char)val;
-        p++;
+        out[i / 2] = (char)val;
+    }
+
+    return (ssize_t)(len / 2);
+}
+
+// See comment in header
+char * hex_decode(const char *s) {
+    if (s == NULL) {
+        return NULL;
+    }
+
+    const size_t len = strlen(s);
+
+    // Must have an even length.
+    if (len % 2 != 0) {
+        return NULL;
+    }
+
+    char *decoded = (char*)malloc(sizeof(char) * ((len / 2) + 1));
+    if (decoded == NULL) {
+        return NULL;
+    }
+
+    ssize_t decoded_len = hex_decode_buf(s, len, decoded);
+    if (decoded_len < 0) {
+        free(decoded);
+        return NULL;
     }
 
-    decoded[decoded_len-1] = '\0';
+    decoded[decoded_len] = '\0';
 
     return decoded;
 }
@@ -86,6 +299,619 @@ char * server_entry_json(const char *s) {
     return json;
 }
 
+// See comment in header
+const char * server_entry_json_n(const char *s, size_t len) {
+    const char *end = s + len;
+    for (int i = 0; i < 4; i++) {
+        const char *delim = memchr(s, ' ', (size_t)(end - s));
+        if (delim == NULL) {
+            return NULL;
+        }
+        s = delim + 1; // move past delim
+    }
+    return s;
+}
+
+/*** JSON SCANNER ***/
+
+// Nesting beyond this depth is left to the full parser.
+#define JSON_SCAN_MAX_DEPTH 16
+
+static const char * json_skip_value(const char *p, const char *end, int depth);
+
+static inline const char * json_skip_whitespace(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+/*!
+ * @brief Skips past a JSON string starting at the opening quote.
+ * @param has_escapes Set to 1 if the string contains escape sequences, otherwise 0.
+ * @return Pointer past the closing quote. NULL if the string is invalid or contains non-ASCII bytes.
+ */
+static const char * json_skip_string(const char *p, const char *end, int *has_escapes) {
+    *has_escapes = 0;
+    p++; // move past opening quote
+
+    while (p < end) {
+        const unsigned char c = (unsigned char)*p;
+        if (c == '"') {
+            return p + 1;
+        } else if (c == '\\') {
+            *has_escapes = 1;
+            if (p + 1 >= end) {
+                return NULL;
+            }
+            switch (p[1]) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    p += 2;
+                    break;
+                case 'u':
+                    if (p + 6 > end) {
+                        return NULL;
+                    }
+                    for (int i = 2; i < 6; i++) {
+                        if (hex_table[(unsigned char)p[i]] == 0xFF) {
+                            return NULL;
+                        }
+                    }
+                    p += 6;
+                    break;
+                default:
+                    return NULL;
+            }
+        } else if (c < 0x20 || c >= 0x80) {
+            // Control characters are invalid. Non-ASCII bytes would need
+            // UTF-8 validation, which is left to the full parser.
+            return NULL;
+        } else {
+            p++;
+        }
+    }
+
+    return NULL;
+}
+
+static inline const char * json_skip_digits(const char *p, const char *end) {
+    const char *start = p;
+    while (p < end && *p >= '0' && *p <= '9') {
+        p++;
+    }
+    return (p == start) ? NULL : p;
+}
+
+/*!
+ * @brief Skips past a JSON number.
+ * @return Pointer past the number. NULL if the number is invalid.
+ */
+static const char * json_skip_number(const char *p, const char *end) {
+    if (p < end && *p == '-') {
+        p++;
+    }
+    if (p < end && *p == '0') {
+        p++;
+    } else if ((p = json_skip_digits(p, end)) == NULL) {
+        return NULL;
+    }
+    if (p < end && *p == '.') {
+        if ((p = json_skip_digits(p + 1, end)) == NULL) {
+            return NULL;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        if ((p = json_skip_digits(p, end)) == NULL) {
+            return NULL;
+        }
+    }
+    return p;
+}
+
+static inline const char * json_skip_literal(const char *p, const char *end, const char *literal, size_t len) {
+    if ((size_t)(end - p) < len || memcmp(p, literal, len) != 0) {
+        return NULL;
+    }
+    return p + len;
+}
+
+/*!
+ * @brief Skips past a JSON array or object starting at the opening bracket.
+ * @return Pointer past the closing bracket. NULL if invalid or nested too deeply.
+ */
+static const char * json_skip_container(const char *p, const char *end, int depth) {
+    const char close = (*p == '{') ? '}' : ']';
+    const int is_object = (close == '}');
+    int has_escapes;
+
+    if (depth >= JSON_SCAN_MAX_DEPTH) {
+        return NULL;
+    }
+
+    p = json_skip_whitespace(p + 1, end);
+    if (p < end && *p == close) {
+        return p + 1;
+    }
+
+    while (p < end) {
+        if (is_object) {
+            if (*p != '"' || (p = json_skip_string(p, end, &has_escapes)) == NULL) {
+                return NULL;
+            }
+            p = json_skip_whitespace(p, end);
+            if (p >= end || *p != ':') {
+                return NULL;
+            }
+            p = json_skip_whitespace(p + 1, end);
+        }
+
+        if ((p = json_skip_value(p, end, depth + 1)) == NULL) {
+            return NULL;
+        }
+
+        p = json_skip_whitespace(p, end);
+        if (p >= end) {
+            return NULL;
+        } else if (*p == close) {
+            return p + 1;
+        } else if (*p != ',') {
+            return NULL;
+        }
+        p = json_skip_whitespace(p + 1, end);
+    }
+
+    return NULL;
+}
+
+/*!
+ * @brief Skips past a JSON value.
+ * @return Pointer past the value. NULL if invalid or unsupported.
+ */
+static const char * json_skip_value(const char *p, const char *end, int depth) {
+    int has_escapes;
+
+    if (p >= end) {
+        return NULL;
+    }
+
+    switch (*p) {
+        case '"':
+            return json_skip_string(p, end, &has_escapes);
+        case '{':
+        case '[':
+            return json_skip_container(p, end, depth);
+        case 't':
+            return json_skip_literal(p, end, "true", 4);
+        case 'f':
+            return json_skip_literal(p, end, "false", 5);
+        case 'n':
+            return json_skip_literal(p, end, "null", 4);
+        default:
+            return json_skip_number(p, end);
+    }
+}
+
+// See comment in header
+json_scan_result server_entry_json_scan(const char *json, size_t len, json_field *fields, size_t num_fields) {
+    for (size_t i = 0; i < num_fields; i++) {
+        fields[i].type = JSON_VALUE_NONE;
+        fields[i].value = NULL;
+        fields[i].value_len = 0;
+    }
+
+    if (json == NULL) {
+        return JSON_SCAN_FALLBACK;
+    }
+
+    const char *end = json + len;
+    const char *p = json_skip_whitespace(json, end);
+    int has_escapes;
+
+    if (p >= end || *p != '{') {
+        return JSON_SCAN_FALLBACK;
+    }
+
+    p = json_skip_whitespace(p + 1, end);
+    if (p < end && *p == '}') {
+        p++;
+    } else {
+        while (1) {
+            // Key
+            if (p >= end || *p != '"') {
+                return JSON_SCAN_FALLBACK;
+            }
+            const char *key = p + 1;
+            if ((p = json_skip_string(p, end, &has_escapes)) == NULL || has_escapes) {
+                return JSON_SCAN_FALLBACK;
+            }
+            const size_t key_len = (size_t)(p - 1 - key);
+
+            p = json_skip_whitespace(p, end);
+            if (p >= end || *p != ':') {
+                return JSON_SCAN_FALLBACK;
+            }
+            p = json_skip_whitespace(p + 1, end);
+
+            // Value
+            const char *value = p;
+            if ((p = json_skip_value(p, end, 1)) == NULL) {
+                return JSON_SCAN_FALLBACK;
+            }
+
+            for (size_t i = 0; i < num_fields; i++) {
+                if (strlen(fields[i].key) != key_len || memcmp(fields[i].key, key, key_len) != 0) {
+                    continue;
+                }
+                if (fields[i].type != JSON_VALUE_NONE) {
+                    // Which duplicate wins is up to the full parser.
+                    return JSON_SCAN_FALLBACK;
+                }
+                if (*value == '"') {
+                    json_skip_string(value, end, &has_escapes);
+                    if (has_escapes) {
+                        return JSON_SCAN_FALLBACK;
+                    }
+                    fields[i].type = JSON_VALUE_STRING;
+                    fields[i].value = value + 1;
+                    fields[i].value_len = (size_t)(p - value - 2);
+                } else {
+                    fields[i].type = (*value == '[') ? JSON_VALUE_ARRAY : JSON_VALUE_OTHER;
+                    fields[i].value = value;
+                    fields[i].value_len = (size_t)(p - value);
+                }
+            }
+
+            p = json_skip_whitespace(p, end);
+            if (p >= end) {
+                return JSON_SCAN_FALLBACK;
+            } else if (*p == '}') {
+                p++;
+                break;
+            } else if (*p != ',') {
+                return JSON_SCAN_FALLBACK;
+            }
+            p = json_skip_whitespace(p + 1, end);
+        }
+    }
+
+    // Only whitespace may follow the object.
+    if (json_skip_whitespace(p, end) != end) {
+        return JSON_SCAN_FALLBACK;
+    }
+
+    return JSON_SCAN_OK;
+}
+
+// See comment in header
+int json_string_array_next(const char **cursor, const char *end, const char **value, size_t *len) {
+    const char *p = *cursor;
+    int has_escapes;
+
+    if (p < end && *p == '[') {
+        p++;
+    }
+    p = json_skip_whitespace(p, end);
+    if (p < end && *p == ',') {
+        p = json_skip_whitespace(p + 1, end);
+    }
+
+    if (p >= end || *p == ']') {
+        *cursor = end;
+        return 0;
+    }
+
+    const char *start = p;
+    if (*p != '"' || (p = json_skip_string(p, end, &has_escapes)) == NULL || has_escapes) {
+        *cursor = end;
+        return -1;
+    }
+
+    *value = start + 1;
+    *len = (size_t)(p - start - 2);
+    *cursor = p;
+
+    return 1;
+}
+
+/*** FILES ***/
+
+// See comment in header
+int server_entries_file_map(const char *path, server_entries_file *file) {
+    memset(file, 0, sizeof(*file));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    file->inode = (uint64_t)st.st_ino;
+#if defined(__APPLE__)
+    file->mtime_sec = (int64_t)st.st_mtimespec.tv_sec;
+    file->mtime_nsec = (int64_t)st.st_mtimespec.tv_nsec;
+#else
+    file->mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    file->mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+#endif
+
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    // The mapping remains valid after the file descriptor is closed.
+    close(fd);
+    if (data == MAP_FAILED) {
+        errno = err;
+        return -1;
+    }
+
+    // The file is read once from start to end, which lets the kernel read ahead aggressively.
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    file->data = data;
+    file->len = (size_t)st.st_size;
+
+    return 0;
+}
+
+// See comment in header
+int server_entries_file_unmap(server_entries_file *file) {
+    int ret = 0;
+    if (file->data != NULL) {
+        ret = munmap((void *)file->data, file->len);
+    }
+    memset(file, 0, sizeof(*file));
+    return ret;
+}
+
+// See comment in header
+uint64_t server_entries_content_hash(const char *data, size_t len) {
+    const uint64_t prime = 0x9E3779B97F4A7C15ULL;
+    uint64_t h = 0xcbf29ce484222325ULL ^ (uint64_t)len;
+    size_t i = 0;
+
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        h = (h ^ word) * prime;
+        h ^= h >> 32;
+    }
+
+    // Remaining bytes.
+    uint64_t word = 0;
+    if (i < len) {
+        memcpy(&word, data + i, len - i);
+    }
+    h = (h ^ word) * prime;
+    h ^= h >> 29;
+
+    return h;
+}
+
+// See comment in header
+void line_iterator_init(line_iterator *it, const char *data, size_t len) {
+    it->next = data;
+    it->end = (data == NULL) ? NULL : data + len;
+}
+
+// See comment in header
+int line_iterator_next(line_iterator *it, const char **line, size_t *len) {
+    if (it->next == it->end) {
+        return 0;
+    }
+
+    const char *start = it->next;
+    const char *newline = memchr(start, '\n', (size_t)(it->end - start));
+    const char *line_end;
+
+    if (newline == NULL) {
+        line_end = it->end;
+        it->next = it->end;
+    } else {
+        line_end = newline;
+        it->next = newline + 1;
+    }
+
+    if (line_end > start && *(line_end - 1) == '\r') {
+        line_end--;
+    }
+
+    *line = start;
+    *len = (size_t)(line_end - start);
+
+    return 1;
+}
+
+// See comment in header
+size_t line_start_at_or_after(const char *data, size_t len, size_t offset) {
+    if (offset == 0 || offset >= len) {
+        return (offset == 0) ? 0 : len;
+    }
+    // A line starts at offset if the previous character ends a line.
+    const char *newline = memchr(data + offset - 1, '\n', len - offset + 1);
+    return (newline == NULL) ? len : (size_t)(newline - data) + 1;
+}
+
+/*** BINARY FORMAT ***/
+
+static inline uint32_t read_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t read_le64(const unsigned char *p) {
+    return (uint64_t)read_le32(p) | ((uint64_t)read_le32(p + 4) << 32);
+}
+
+#define SERVER_ENTRIES_BINARY_MAGIC "PSEB"
+#define SERVER_ENTRIES_BINARY_VERSION 1
+#define SERVER_ENTRIES_BINARY_HEADER_SIZE 12
+
+// See comment in header
+int server_entries_is_binary(const char *data, size_t len) {
+    return (len >= 4 && memcmp(data, SERVER_ENTRIES_BINARY_MAGIC, 4) == 0) ? 1 : 0;
+}
+
+// See comment in header
+int binary_entries_iterator_init(binary_entries_iterator *it, const char *data, size_t len) {
+    if (len < SERVER_ENTRIES_BINARY_HEADER_SIZE || !server_entries_is_binary(data, len)) {
+        return -1;
+    }
+
+    const unsigned char *p = (const unsigned char *)data;
+    if (read_le32(p + 4) != SERVER_ENTRIES_BINARY_VERSION) {
+        return -1;
+    }
+
+    it->remaining = read_le32(p + 8);
+    it->next = p + SERVER_ENTRIES_BINARY_HEADER_SIZE;
+    it->end = p + len;
+
+    return 0;
+}
+
+// See comment in header
+int binary_entries_iterator_next(binary_entries_iterator *it, const char **entry, size_t *len) {
+    if (it->remaining == 0) {
+        // Trailing bytes after the last entry are malformed.
+        return (it->next == it->end) ? 0 : -1;
+    }
+
+    // Unsigned LEB128. Lengths are limited to 32 bits.
+    uint64_t entry_len = 0;
+    int shift = 0;
+    while (1) {
+        if (it->next >= it->end || shift > 28) {
+            return -1;
+        }
+        const unsigned char b = *it->next++;
+        entry_len |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            break;
+        }
+        shift += 7;
+    }
+
+    if (entry_len > (uint64_t)(it->end - it->next)) {
+        return -1;
+    }
+
+    *entry = (const char *)it->next;
+    *len = (size_t)entry_len;
+    it->next += entry_len;
+    it->remaining--;
+
+    return 1;
+}
+
+/*** INDEX ***/
+
+#define SERVER_ENTRIES_INDEX_MAGIC "PSEI"
+#define SERVER_ENTRIES_INDEX_VERSION 2
+#define SERVER_ENTRIES_INDEX_HEADER_SIZE 40
+#define SERVER_ENTRIES_INDEX_REGION_SIZE 16
+
+// See comment in header
+int server_entries_index_open(const char *path, const server_entries_file *source, uint64_t source_hash,
+                              server_entries_index *index) {
+    memset(index, 0, sizeof(*index));
+
+    if (server_entries_file_map(path, &index->file) != 0) {
+        return -1;
+    }
+
+    const unsigned char *base = (const unsigned char *)index->file.data;
+    const size_t len = index->file.len;
+
+    if (len < SERVER_ENTRIES_INDEX_HEADER_SIZE ||
+        memcmp(base, SERVER_ENTRIES_INDEX_MAGIC, 4) != 0 ||
+        read_le32(base + 4) != SERVER_ENTRIES_INDEX_VERSION) {
+        goto invalid;
+    }
+
+    // Stale if generated for a different server entries file.
+    if (read_le64(base + 8) != (uint64_t)source->len ||
+        read_le64(base + 16) != source_hash) {
+        goto invalid;
+    }
+
+    index->entry_count = read_le32(base + 24);
+    index->region_count = read_le32(base + 28);
+    const uint64_t strings_size = read_le32(base + 32);
+
+    const uint64_t regions_size = (uint64_t)index->region_count * SERVER_ENTRIES_INDEX_REGION_SIZE;
+    const uint64_t strings_padded = (strings_size + 7) & ~(uint64_t)7;
+    const uint64_t offsets_size = (uint64_t)index->entry_count * 8;
+
+    if (SERVER_ENTRIES_INDEX_HEADER_SIZE + regions_size + strings_padded + offsets_size != len) {
+        goto invalid;
+    }
+
+    index->regions = base + SERVER_ENTRIES_INDEX_HEADER_SIZE;
+    index->strings = index->regions + regions_size;
+    index->entry_offsets = index->strings + strings_padded;
+
+    // Validate every region so that lookups need no further bounds checks.
+    uint64_t next_entry = 0;
+    for (uint32_t i = 0; i < index->region_count; i++) {
+        const unsigned char *region = index->regions + (uint64_t)i * SERVER_ENTRIES_INDEX_REGION_SIZE;
+        const uint64_t name_offset = read_le32(region);
+        const uint64_t name_len = read_le32(region + 4);
+        const uint64_t entry_count = read_le32(region + 8);
+        const uint64_t first_entry = read_le32(region + 12);
+
+        if (name_len == 0 || name_offset + name_len > strings_size || first_entry != next_entry) {
+            goto invalid;
+        }
+        next_entry += entry_count;
+    }
+
+    if (next_entry != index->entry_count) {
+        goto invalid;
+    }
+
+    return 0;
+
+invalid:
+    server_entries_index_close(index);
+    return -1;
+}
+
+// See comment in header
+void server_entries_index_close(server_entries_index *index) {
+    server_entries_file_unmap(&index->file);
+    memset(index, 0, sizeof(*index));
+}
+
+// See comment in header
+void server_entries_index_region(const server_entries_index *index, uint32_t i,
+                                 const char **name, size_t *name_len,
+                                 uint32_t *entry_count, uint32_t *first_entry) {
+    const unsigned char *region = index->regions + (uint64_t)i * SERVER_ENTRIES_INDEX_REGION_SIZE;
+    *name = (const char *)index->strings + read_le32(region);
+    *name_len = read_le32(region + 4);
+    *entry_count = read_le32(region + 8);
+    *first_entry = read_le32(region + 12);
+}
+
+// See comment in header
+uint64_t server_entries_index_entry_offset(const server_entries_index *index, uint32_t i) {
+    return read_le64(index->entry_offsets + (uint64_t)i * 8);
+}
+
 /*** HELPERS ***/
 
 /*!
@@ -20,6 +20,10 @@
 #ifndef EmbeddedServerEntriesHelpers_h
 #define EmbeddedServerEntriesHelpers_h
 
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
 /*!
  * @brief Decodes hex encoded string.
  *
@@ -38,6 +42,26 @@
  */
 char * hex_decode(const char *s);
 
+/*!
+ * @brief Decodes hex encoded bytes into a caller-supplied buffer.
+ *
+ * Table driven decoder which processes 32 hex characters per step with SSE2/AVX2 on x86 and NEON on arm64,
+ * with a scalar fallback for the remainder. The input does not need to be NULL terminated and the output is not
+ * NULL terminated.
+ *
+ * Decoding in place is supported by passing the same pointer for `s` and `out`. Any other overlap between
+ * the input and output buffers is undefined.
+ *
+ * On failure -1 is returned and errno is set to EINVAL. A decoded NULL byte is treated as a failure, since
+ * decoded server entries are handled as C strings. The contents of `out` are unspecified on failure.
+ *
+ * @param s Pointer to hex encoded bytes. Must only contain hexadecimal characters.
+ * @param len Number of hex characters in `s`. Must be even.
+ * @param out Pointer to buffer of at least `len / 2` bytes, or `s` to decode in place.
+ * @return Number of bytes written to `out`. -1 on error.
+ */
+ssize_t hex_decode_buf(const char *s, size_t len, char *out);
+
 /*!
  * @brief Drops newline and carriage return from end of string.
  *
@@ -59,4 +83,246 @@ void drop_newline_and_carriage_return(char *s);
  */
 char * server_entry_json(const char *s);
 
+/*!
+ * @brief Skip past legacy format (4 space delimited fields) to JSON config in a decoded server entry
+ * which is not NULL terminated.
+ *
+ * @param s Pointer to decoded server entry.
+ * @param len Length of `s`.
+ * @return  Pointer to JSON config in server entry. NULL if there are fewer than 4 fields.
+ */
+const char * server_entry_json_n(const char *s, size_t len);
+
+/*!
+ * @brief Result of scanning server entry JSON with `server_entry_json_scan`.
+ */
+typedef enum {
+    /// Scan completed. Requested fields which are present in the JSON have been populated.
+    JSON_SCAN_OK = 0,
+    /// The JSON is invalid or uses features the scanner does not handle, e.g. non-ASCII bytes,
+    /// escaped keys or requested values, duplicate requested keys or deep nesting.
+    /// The caller must fall back to a full JSON parser.
+    JSON_SCAN_FALLBACK = 1
+} json_scan_result;
+
+/*!
+ * @brief Type of a top-level JSON value found by `server_entry_json_scan`.
+ */
+typedef enum {
+    JSON_VALUE_NONE = 0,
+    JSON_VALUE_STRING,
+    JSON_VALUE_ARRAY,
+    JSON_VALUE_OTHER
+} json_value_type;
+
+/*!
+ * @brief Top-level field to find with `server_entry_json_scan`.
+ */
+typedef struct {
+    /// Key of the field. Set by the caller.
+    const char *key;
+    /// Type of the value, JSON_VALUE_NONE if the key was not found.
+    json_value_type type;
+    /// Points into the scanned JSON. For strings, the contents between the quotes, which never contain
+    /// escape sequences. For all other types, the raw JSON text of the value.
+    const char *value;
+    size_t value_len;
+} json_field;
+
+/*!
+ * @brief Finds top-level fields in server entry JSON without allocating or building a full object.
+ *
+ * The whole input is validated as a single JSON object, so that `JSON_SCAN_OK` is only returned for
+ * input a full JSON parser would accept with identical results for the requested fields.
+ *
+ * @param json Pointer to JSON object, e.g. as returned by `server_entry_json`. Need not be NULL terminated.
+ * @param len Length of `json`.
+ * @param fields Fields to find. `type`, `value` and `value_len` are populated on `JSON_SCAN_OK`.
+ * @param num_fields Number of fields.
+ * @return `JSON_SCAN_OK` or `JSON_SCAN_FALLBACK`.
+ */
+json_scan_result server_entry_json_scan(const char *json, size_t len, json_field *fields, size_t num_fields);
+
+/*!
+ * @brief Iterates over the string elements of a JSON array value found by `server_entry_json_scan`,
+ * e.g. server entry capabilities.
+ *
+ * @param cursor Set to the array `value` before the first call. Advanced by each call.
+ * @param end End of the array value, i.e. `value + value_len`.
+ * @param value Set to the contents of the next string element.
+ * @param len Set to the length of the next string element.
+ * @return 1 if an element was returned, 0 if there are no more elements, -1 if the next element is not a
+ * string without escape sequences.
+ */
+int json_string_array_next(const char **cursor, const char *end, const char **value, size_t *len);
+
+/*!
+ * @brief Read-only memory mapping of an embedded server entries file.
+ */
+typedef struct {
+    const char *data;
+    size_t len;
+    /// Identity of the file when it was mapped.
+    uint64_t inode;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+} server_entries_file;
+
+/*!
+ * @brief Maps the file at path into memory for sequential reading.
+ *
+ * An empty file is mapped successfully with `data` set to NULL and `len` set to 0.
+ *
+ * @param path Path to file.
+ * @param file Populated on success. Must be unmapped with `server_entries_file_unmap`.
+ * @return 0 on success. -1 on failure, in which case errno is set.
+ */
+int server_entries_file_map(const char *path, server_entries_file *file);
+
+/*!
+ * @brief Unmaps a file previously mapped with `server_entries_file_map`.
+ * @param file Mapped file. Reset to an empty mapping.
+ * @return 0 on success. -1 on failure, in which case errno is set.
+ */
+int server_entries_file_unmap(server_entries_file *file);
+
+/*!
+ * @brief Returns a 64-bit non-cryptographic hash of the whole buffer `data` of length `len`.
+ *
+ * Processes 8 bytes per step, read in host byte order, which is little-endian on all supported targets.
+ * Used to detect a changed server entries file, not to authenticate it. `gen_server_entries_index.py`
+ * computes the same hash for the index it generates.
+ */
+uint64_t server_entries_content_hash(const char *data, size_t len);
+
+/*!
+ * @brief Iterator over the lines of a buffer that yields views into the buffer without copying.
+ */
+typedef struct {
+    const char *next;
+    const char *end;
+} line_iterator;
+
+/*!
+ * @brief Initializes iterator over the lines in the buffer `data` of length `len`.
+ */
+void line_iterator_init(line_iterator *it, const char *data, size_t len);
+
+/*!
+ * @brief Advances iterator to the next line.
+ *
+ * Lines are delimited by \n or \r\n, which are not included in the returned line. Like `getline()`, a trailing
+ * newline at the end of the buffer does not produce an empty final line.
+ *
+ * @param it Iterator.
+ * @param line Set to point to the start of the line. Not NULL terminated.
+ * @param len Set to the length of the line.
+ * @return 1 if a line was returned, 0 if there are no more lines.
+ */
+int line_iterator_next(line_iterator *it, const char **line, size_t *len);
+
+/*!
+ * @brief Returns the offset of the first line that starts at or after `offset` in the buffer `data` of length `len`.
+ *
+ * Used to split a buffer into chunks of whole lines.
+ *
+ * @return Offset of the start of a line, or `len` if no line starts at or after `offset`.
+ */
+size_t line_start_at_or_after(const char *data, size_t len, size_t offset);
+
+/*!
+ * @brief Iterator over the entries of a server entries file in the binary container format.
+ *
+ * The binary format stores hex decoded server entries, which halves the size of the file and removes the
+ * need to hex decode at runtime. It is generated from the hex line format by `convert_server_entries.py`.
+ *
+ * Layout:
+ *   char[4] magic "PSEB", uint32 version (little-endian), uint32 entry count (little-endian),
+ *   then for each entry: length as an unsigned LEB128 varint followed by the raw server entry bytes.
+ */
+typedef struct {
+    const unsigned char *next;
+    const unsigned char *end;
+    uint32_t remaining;
+} binary_entries_iterator;
+
+/*!
+ * @brief Returns 1 if the buffer starts with the binary container format magic, otherwise 0.
+ */
+int server_entries_is_binary(const char *data, size_t len);
+
+/*!
+ * @brief Initializes iterator over the entries of the binary container format file in `data`.
+ * @return 0 on success. -1 if the header is invalid or the version is not supported.
+ */
+int binary_entries_iterator_init(binary_entries_iterator *it, const char *data, size_t len);
+
+/*!
+ * @brief Advances iterator to the next entry.
+ * @param it Iterator.
+ * @param entry Set to point to the raw server entry in the buffer. Not NULL terminated.
+ * @param len Set to the length of the entry.
+ * @return 1 if an entry was returned, 0 if there are no more entries, -1 if the file is truncated or malformed.
+ */
+int binary_entries_iterator_next(binary_entries_iterator *it, const char **entry, size_t *len);
+
+/*!
+ * @brief Binary sidecar index of an embedded server entries file, generated at build time
+ * by `gen_server_entries_index.py`. See the script for the file layout.
+ */
+typedef struct {
+    server_entries_file file;
+    uint32_t entry_count;
+    uint32_t region_count;
+    const unsigned char *regions;
+    const unsigned char *strings;
+    const unsigned char *entry_offsets;
+} server_entries_index;
+
+/*!
+ * @brief Maps and validates the index at `path` generated for the server entries file `source`.
+ *
+ * The index is rejected if it is malformed, has an unsupported version, or was generated for a different
+ * server entries file than `source`, which is identified by its size and `server_entries_content_hash`.
+ * The hash covers the whole of `source`, so that an edit anywhere in the file invalidates the index.
+ *
+ * @param path Path to index file.
+ * @param source Mapped server entries file the index must correspond to.
+ * @param source_hash `server_entries_content_hash` of `source`. Passed in so that callers which also key a
+ * cache on the hash only compute it once.
+ * @param index Populated on success. Must be closed with `server_entries_index_close`.
+ * @return 0 on success. -1 if the index is missing, invalid or stale.
+ */
+int server_entries_index_open(const char *path, const server_entries_file *source, uint64_t source_hash,
+                              server_entries_index *index);
+
+/*!
+ * @brief Unmaps index previously opened with `server_entries_index_open`.
+ */
+void server_entries_index_close(server_entries_index *index);
+
+/*!
+ * @brief Returns the `i`th region in the index. Regions are sorted by name.
+ *
+ * @param index Open index.
+ * @param i Region index. Must be less than `index->region_count`.
+ * @param name Set to point to region name in the index. Not NULL terminated.
+ * @param name_len Set to length of region name.
+ * @param entry_count Set to the number of server entries in the region.
+ * @param first_entry Set to the position of the region's first entry, see `server_entries_index_entry_offset`.
+ */
+void server_entries_index_region(const server_entries_index *index, uint32_t i,
+                                 const char **name, size_t *name_len,
+                                 uint32_t *entry_count, uint32_t *first_entry);
+
+/*!
+ * @brief Returns byte offset of the start of the `i`th indexed server entry's line in the server entries file.
+ *
+ * Entries are grouped by region in region order. Opening the index checks its layout, the name and entry range
+ * of every region, and that it was generated for the server entries file, but not the offsets themselves. The
+ * content hash covers the server entries file and not the index, so a corrupted index can still hold offsets
+ * past the end of the file. Offsets must be bounds checked against the server entries file before use.
+ */
+uint64_t server_entries_index_entry_offset(const server_entries_index *index, uint32_t i);
+
 #endif /* EmbeddedServerEntriesHelpers_h */
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "EmbeddedServerEntriesStats.h"
+#import "EmbeddedServerEntriesHelpers.h"
+#import <stdlib.h>
+#import <string.h>
+
+#define kServerEntryRegionJsonKey "region"
+
+/// Initial capacity of the IP address set.
+#define IP_ADDRESS_SET_MIN_CAPACITY 1024
+
+/*** IP ADDRESS SET ***/
+
+static uint32_t ip_address_hash(const char *ip, size_t len) {
+    // The low bits of the hash are the least mixed, so the high bits of its product are used.
+    return (uint32_t)((server_entries_content_hash(ip, len) * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static int ip_address_set_init(ip_address_set *set) {
+    memset(set, 0, sizeof(*set));
+    set->slots = calloc(IP_ADDRESS_SET_MIN_CAPACITY, sizeof(uint64_t));
+    if (set->slots == NULL) {
+        return -1;
+    }
+    set->capacity = IP_ADDRESS_SET_MIN_CAPACITY;
+    return 0;
+}
+
+static void ip_address_set_free(ip_address_set *set) {
+    free(set->slots);
+    free(set->bytes);
+    memset(set, 0, sizeof(*set));
+}
+
+/*!
+ * @brief Finds the slot of the address, or the empty slot where it would be inserted.
+ * @return 1 if the address is present, otherwise 0.
+ */
+static int ip_address_set_find(const ip_address_set *set, const char *ip, size_t len, uint32_t hash, size_t *slot) {
+    const size_t mask = set->capacity - 1;
+    size_t i = hash & mask;
+    while (set->slots[i] != 0) {
+        if ((uint32_t)(set->slots[i] >> 32) == hash) {
+            const char *stored = set->bytes + (uint32_t)set->slots[i] - 1;
+            if ((unsigned char)stored[0] == len && memcmp(stored + 1, ip, len) == 0) {
+                *slot = i;
+                return 1;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+    *slot = i;
+    return 0;
+}
+
+static int ip_address_set_grow(ip_address_set *set) {
+    const size_t capacity = set->capacity * 2;
+    uint64_t *slots = calloc(capacity, sizeof(uint64_t));
+    if (slots == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < set->capacity; i++) {
+        if (set->slots[i] != 0) {
+            size_t j = (size_t)(set->slots[i] >> 32) & (capacity - 1);
+            while (slots[j] != 0) {
+                j = (j + 1) & (capacity - 1);
+            }
+            slots[j] = set->slots[i];
+        }
+    }
+    free(set->slots);
+    set->slots = slots;
+    set->capacity = capacity;
+    return 0;
+}
+
+/*!
+ * @return 1 if the address was already present, 0 if it was inserted, 2 if it is not present and the set is full,
+ * or -1 on error.
+ */
+static int ip_address_set_insert(ip_address_set *set, const char *ip, size_t len) {
+    if (len > UINT8_MAX) {
+        return -1;
+    }
+
+    const uint32_t hash = ip_address_hash(ip, len);
+    size_t slot;
+    if (ip_address_set_find(set, ip, len, hash, &slot)) {
+        return 1;
+    }
+    if (set->count == IP_ADDRESS_SET_MAX_ADDRESSES) {
+        return 2;
+    }
+
+    // Load factor is kept at or below 1/2.
+    if ((set->count + 1) * 2 > set->capacity) {
+        if (ip_address_set_grow(set) != 0) {
+            return -1;
+        }
+        ip_address_set_find(set, ip, len, hash, &slot);
+    }
+
+    if (set->bytes_len + 1 + len > set->bytes_cap) {
+        size_t cap = (set->bytes_cap == 0) ? 16 * 1024 : set->bytes_cap;
+        while (cap < set->bytes_len + 1 + len) {
+            cap *= 2;
+        }
+        char *bytes = realloc(set->bytes, cap);
+        if (bytes == NULL) {
+            return -1;
+        }
+        set->bytes = bytes;
+        set->bytes_cap = cap;
+    }
+
+    set->slots[slot] = ((uint64_t)hash << 32) | (uint64_t)(set->bytes_len + 1);
+    set->bytes[set->bytes_len] = (char)len;
+    memcpy(set->bytes + set->bytes_len + 1, ip, len);
+    set->bytes_len += 1 + len;
+    set->count++;
+    return 0;
+}
+
+/*** HELPERS ***/
+
+/*!
+ * @brief Ensures there are entry counts for `count` regions. New counts are zero.
+ * @return 0 on success, -1 on failure in which case the counts are unchanged.
+ */
+static int reserve_region_entry_counts(server_entries_stats *stats, size_t count) {
+    if (count <= stats->region_entry_counts_capacity) {
+        return 0;
+    }
+    size_t capacity = (stats->region_entry_counts_capacity == 0) ? 64 : stats->region_entry_counts_capacity;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    size_t *counts = realloc(stats->region_entry_counts, capacity * sizeof(size_t));
+    if (counts == NULL) {
+        return -1;
+    }
+    memset(counts + stats->region_entry_counts_capacity, 0,
+           (capacity - stats->region_entry_counts_capacity) * sizeof(size_t));
+    stats->region_entry_counts = counts;
+    stats->region_entry_counts_capacity = capacity;
+    return 0;
+}
+
+// See comment in header
+int server_entries_stats_init(server_entries_stats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    server_entry_regions_init(&stats->regions);
+    return ip_address_set_init(&stats->ip_addresses);
+}
+
+// See comment in header
+void server_entries_stats_free(server_entries_stats *stats) {
+    ip_address_set_free(&stats->ip_addresses);
+    server_entry_regions_free(&stats->regions);
+    free(stats->region_entry_counts);
+    memset(stats, 0, sizeof(*stats));
+}
+
+// See comment in header
+int server_entries_stats_add(server_entries_stats *stats, const char *entry, size_t len,
+                             const char *region, size_t region_len) {
+    // IP address is the first legacy field.
+    const char *delim = memchr(entry, ' ', len);
+    if (delim == NULL || delim == entry) {
+        return -1;
+    }
+
+    // Room for a count is made before the region is interned. A region interned here is left
+    // without entries if the IP address cannot be added below.
+    if (reserve_region_entry_counts(stats, stats->regions.count + 1) != 0) {
+        return -1;
+    }
+    const int id = server_entry_regions_intern(&stats->regions, region, region_len);
+    if (id < 0) {
+        return -1;
+    }
+
+    const int inserted = ip_address_set_insert(&stats->ip_addresses, entry, (size_t)(delim - entry));
+    if (inserted < 0) {
+        return -1;
+    }
+    if (inserted == 2) {
+        stats->ip_address_limit_reached = 1;
+    }
+    const int duplicate = (inserted == 1);
+
+    stats->region_entry_counts[id]++;
+    stats->entry_count++;
+    stats->duplicate_count += (size_t)duplicate;
+
+    return duplicate;
+}
+
+// See comment in header
+int server_entries_stats_add_entry(server_entries_stats *stats, const char *entry, size_t len) {
+    const char *json = server_entry_json_n(entry, len);
+    if (json == NULL) {
+        return -1;
+    }
+
+    json_field field = {.key = kServerEntryRegionJsonKey};
+
+    if (server_entry_json_scan(json, len - (size_t)(json - entry), &field, 1) != JSON_SCAN_OK ||
+        field.type != JSON_VALUE_STRING) {
+        return SERVER_ENTRY_TABLE_NEEDS_PARSER;
+    }
+
+    return server_entries_stats_add(stats, entry, len, field.value, field.value_len);
+}
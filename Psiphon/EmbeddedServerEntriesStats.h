@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EmbeddedServerEntriesStats_h
+#define EmbeddedServerEntriesStats_h
+
+#include "EmbeddedServerEntriesTable.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// Maximum number of distinct IP addresses kept for duplicate detection.
+#define IP_ADDRESS_SET_MAX_ADDRESSES (1 << 20)
+
+/*!
+ * @brief Set of IP addresses in an open-addressing table with linear probing.
+ *
+ * Each slot holds 32 bits of the address's hash and the offset of the address in `bytes`, where addresses are
+ * stored length-prefixed. A hash match is confirmed against the stored bytes, so membership is exact. Memory grows
+ * with the number of distinct addresses up to `IP_ADDRESS_SET_MAX_ADDRESSES`, where the slots take 16 MiB and
+ * IPv4 addresses up to 16 MiB more.
+ */
+typedef struct {
+    uint64_t *slots;   // Hash in the high 32 bits, offset in `bytes` plus 1 in the low 32 bits. 0 marks an empty slot.
+    size_t capacity;   // Power of 2.
+    size_t count;
+    char *bytes;
+    size_t bytes_len;
+    size_t bytes_cap;
+} ip_address_set;
+
+/*!
+ * @brief Region histogram and duplicate IP address detection, computed in one pass over the server entries.
+ *
+ * Duplicates are detected exactly with `ip_address_set`. Once it holds `IP_ADDRESS_SET_MAX_ADDRESSES` addresses,
+ * new addresses are no longer added and `ip_address_limit_reached` is set, so later duplicates of those addresses
+ * are not counted. Entries whose address is already in the set are still counted as duplicates.
+ *
+ * Any string region is counted, see `server_entry_regions`.
+ *
+ * Must be initialized with `server_entries_stats_init` and freed with `server_entries_stats_free`.
+ */
+typedef struct {
+    size_t entry_count;
+    size_t duplicate_count;
+    // Set if an address could not be added to `ip_addresses` because it is full.
+    int ip_address_limit_reached;
+
+    // Regions in order of first occurrence, and the number of entries in each, indexed by region id.
+    server_entry_regions regions;
+    size_t *region_entry_counts;
+    size_t region_entry_counts_capacity;
+
+    ip_address_set ip_addresses;
+} server_entries_stats;
+
+/*!
+ * @brief Initializes empty stats.
+ * @return 0 on success, -1 if the IP address set could not be allocated.
+ */
+int server_entries_stats_init(server_entries_stats *stats);
+
+/*!
+ * @brief Frees all memory held by the stats.
+ */
+void server_entries_stats_free(server_entries_stats *stats);
+
+/*!
+ * @brief Counts a server entry whose region has already been extracted by the caller.
+ *
+ * @param stats Stats.
+ * @param entry Decoded server entry. Only the IP address, the first legacy field, is read.
+ * @param len Length of `entry`.
+ * @param region Region code.
+ * @param region_len Length of `region`.
+ * @return 1 if the entry's IP address was already seen, 0 if it was not, or -1 if the entry has no IP address or
+ * the stats could not grow, in which case the entry is not counted. The entry is counted in the histogram whether
+ * or not it is a duplicate.
+ */
+int server_entries_stats_add(server_entries_stats *stats, const char *entry, size_t len,
+                             const char *region, size_t region_len);
+
+/*!
+ * @brief Counts a hex decoded server entry.
+ *
+ * Same as `server_entries_stats_add`, but the region is scanned from the entry's JSON config. Returns
+ * `SERVER_ENTRY_TABLE_NEEDS_PARSER` (-2) if the JSON config could not be scanned without a full JSON
+ * parser, in which case the caller must extract the region and call `server_entries_stats_add`.
+ */
+int server_entries_stats_add_entry(server_entries_stats *stats, const char *entry, size_t len);
+
+#endif /* EmbeddedServerEntriesStats_h */
@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import "EmbeddedServerEntriesTable.h"
+#import "EmbeddedServerEntriesHelpers.h"
+#import <stdlib.h>
+#import <string.h>
+
+#define kServerEntryRegionJsonKey "region"
+#define kServerEntryCapabilitiesJsonKey "capabilities"
+
+/// Number of legacy space delimited fields preceding the JSON config.
+#define SERVER_ENTRY_LEGACY_FIELDS 4
+
+static const struct {
+    const char *name;
+    uint32_t bit;
+} capability_names[] = {
+    {"handshake", SERVER_ENTRY_CAP_HANDSHAKE},
+    {"SSH", SERVER_ENTRY_CAP_SSH},
+    {"OSSH", SERVER_ENTRY_CAP_OSSH},
+    {"FRONTED-MEEK", SERVER_ENTRY_CAP_FRONTED_MEEK},
+    {"FRONTED-MEEK-HTTP", SERVER_ENTRY_CAP_FRONTED_MEEK_HTTP},
+    {"UNFRONTED-MEEK", SERVER_ENTRY_CAP_UNFRONTED_MEEK},
+    {"UNFRONTED-MEEK-HTTPS", SERVER_ENTRY_CAP_UNFRONTED_MEEK_HTTPS},
+    {"UNFRONTED-MEEK-SESSION-TICKET", SERVER_ENTRY_CAP_UNFRONTED_MEEK_SESSION_TICKET},
+    {"QUIC", SERVER_ENTRY_CAP_QUIC},
+    {"FRONTED-MEEK-QUIC", SERVER_ENTRY_CAP_FRONTED_MEEK_QUIC},
+    {"TAPDANCE", SERVER_ENTRY_CAP_TAPDANCE},
+    {"CONJURE", SERVER_ENTRY_CAP_CONJURE},
+    {"VPN", SERVER_ENTRY_CAP_VPN},
+    {"SSH-API-REQUESTS", SERVER_ENTRY_CAP_SSH_API_REQUESTS},
+};
+
+/// Initial number of hash table slots of `server_entry_regions`.
+#define SERVER_ENTRY_REGIONS_MIN_SLOTS 64
+
+/*** REGIONS ***/
+
+static uint32_t region_hash(const char *region, size_t len) {
+    // The low bits of the hash are the least mixed, so the high bits of its product are used.
+    return (uint32_t)((server_entries_content_hash(region, len) * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/*!
+ * @brief Finds the slot of the region, or the empty slot where it would be inserted.
+ * @return Region id if the region is present, otherwise -1.
+ */
+static int regions_find_slot(const server_entry_regions *regions, const char *region, size_t len, size_t *slot) {
+    const size_t mask = regions->slot_capacity - 1;
+    size_t i = region_hash(region, len) & mask;
+    while (regions->slots[i] != 0) {
+        const uint32_t id = regions->slots[i] - 1;
+        if (regions->lens[id] == len && memcmp(regions->codes + regions->offsets[id], region, len) == 0) {
+            *slot = i;
+            return (int)id;
+        }
+        i = (i + 1) & mask;
+    }
+    *slot = i;
+    return -1;
+}
+
+/*!
+ * @brief Ensures there is room for one more region of length `len`.
+ * @return 0 on success, -1 on failure in which case the regions are unchanged.
+ */
+static int regions_reserve(server_entry_regions *regions, size_t len) {
+    if (regions->count >= INT32_MAX || regions->codes_len + len + 1 > UINT32_MAX) {
+        return -1;
+    }
+
+    if (regions->count == regions->capacity) {
+        const size_t capacity = (regions->capacity == 0) ? 64 : regions->capacity * 2;
+        uint32_t *offsets = realloc(regions->offsets, capacity * sizeof(uint32_t));
+        if (offsets == NULL) {
+            return -1;
+        }
+        regions->offsets = offsets;
+        uint32_t *lens = realloc(regions->lens, capacity * sizeof(uint32_t));
+        if (lens == NULL) {
+            return -1;
+        }
+        regions->lens = lens;
+        regions->capacity = capacity;
+    }
+
+    // Load factor is kept at or below 1/2.
+    if ((regions->count + 1) * 2 > regions->slot_capacity) {
+        const size_t slot_capacity = (regions->slot_capacity == 0) ? SERVER_ENTRY_REGIONS_MIN_SLOTS
+                                                                   : regions->slot_capacity * 2;
+        uint32_t *slots = calloc(slot_capacity, sizeof(uint32_t));
+        if (slots == NULL) {
+            return -1;
+        }
+        for (size_t id = 0; id < regions->count; id++) {
+            size_t j = region_hash(regions->codes + regions->offsets[id], regions->lens[id]) & (slot_capacity - 1);
+            while (slots[j] != 0) {
+                j = (j + 1) & (slot_capacity - 1);
+            }
+            slots[j] = (uint32_t)id + 1;
+        }
+        free(regions->slots);
+        regions->slots = slots;
+        regions->slot_capacity = slot_capacity;
+    }
+
+    if (regions->codes_len + len + 1 > regions->codes_capacity) {
+        size_t capacity = (regions->codes_capacity == 0) ? 1024 : regions->codes_capacity;
+        while (capacity < regions->codes_len + len + 1) {
+            capacity *= 2;
+        }
+        char *codes = realloc(regions->codes, capacity);
+        if (codes == NULL) {
+            return -1;
+        }
+        regions->codes = codes;
+        regions->codes_capacity = capacity;
+    }
+
+    return 0;
+}
+
+// See comment in header
+void server_entry_regions_init(server_entry_regions *regions) {
+    memset(regions, 0, sizeof(*regions));
+}
+
+// See comment in header
+void server_entry_regions_free(server_entry_regions *regions) {
+    free(regions->offsets);
+    free(regions->lens);
+    free(regions->slots);
+    free(regions->codes);
+    server_entry_regions_init(regions);
+}
+
+// See comment in header
+int server_entry_regions_find(const server_entry_regions *regions, const char *region, size_t len) {
+    size_t slot;
+    return (regions->count == 0) ? -1 : regions_find_slot(regions, region, len, &slot);
+}
+
+// See comment in header
+int server_entry_regions_intern(server_entry_regions *regions, const char *region, size_t len) {
+    size_t slot;
+    if (regions->count > 0) {
+        const int id = regions_find_slot(regions, region, len, &slot);
+        if (id >= 0) {
+            return id;
+        }
+    }
+
+    // Growing the hash table moves the empty slot, so it is found again.
+    if (regions_reserve(regions, len) != 0) {
+        return -1;
+    }
+    regions_find_slot(regions, region, len, &slot);
+
+    const size_t id = regions->count;
+    regions->offsets[id] = (uint32_t)regions->codes_len;
+    regions->lens[id] = (uint32_t)len;
+    memcpy(regions->codes + regions->codes_len, region, len);
+    regions->codes[regions->codes_len + len] = '\0';
+    regions->codes_len += len + 1;
+    regions->slots[slot] = (uint32_t)id + 1;
+    regions->count++;
+
+    return (int)id;
+}
+
+// See comment in header
+const char *server_entry_regions_code(const server_entry_regions *regions, int id, size_t *len) {
+    *len = regions->lens[id];
+    return regions->codes + regions->offsets[id];
+}
+
+/*** TABLE ***/
+
+// See comment in header
+void server_entry_table_init(server_entry_table *table) {
+    memset(table, 0, sizeof(*table));
+    server_entry_regions_init(&table->regions);
+}
+
+// See comment in header
+void server_entry_table_free(server_entry_table *table) {
+    free(table->ip_address_offset);
+    free(table->ip_address_len);
+    free(table->web_server_port);
+    free(table->web_server_secret_offset);
+    free(table->web_server_secret_len);
+    free(table->web_server_certificate_offset);
+    free(table->web_server_certificate_len);
+    free(table->region_id);
+    free(table->capabilities);
+    free(table->strings);
+    server_entry_regions_free(&table->regions);
+    server_entry_table_init(table);
+}
+
+// See comment in header
+uint32_t server_entry_capability_from_name(const char *name, size_t len) {
+    for (size_t i = 0; i < sizeof(capability_names) / sizeof(capability_names[0]); i++) {
+        if (strlen(capability_names[i].name) == len && memcmp(capability_names[i].name, name, len) == 0) {
+            return capability_names[i].bit;
+        }
+    }
+    return 0;
+}
+
+// See comment in header
+int server_entry_table_region_id(const server_entry_table *table, const char *region, size_t len) {
+    return server_entry_regions_find(&table->regions, region, len);
+}
+
+/*** HELPERS ***/
+
+/*!
+ * @brief Grows array `*p` of elements of size `size` to `capacity` elements.
+ * @return 0 on success, -1 on failure in which case `*p` is unchanged.
+ */
+static int grow_column(void **p, size_t size, size_t capacity) {
+    void *grown = realloc(*p, size * capacity);
+    if (grown == NULL) {
+        return -1;
+    }
+    *p = grown;
+    return 0;
+}
+
+/*!
+ * @brief Ensures there is room for one more entry and `strings_len` more bytes of legacy fields.
+ * @return 0 on success, -1 on failure in which case the table is unchanged.
+ */
+static int reserve(server_entry_table *table, size_t strings_len) {
+    if (table->count == table->capacity) {
+        size_t capacity = (table->capacity == 0) ? 1024 : table->capacity * 2;
+        if (grow_column((void **)&table->ip_address_offset, sizeof(uint32_t), capacity) != 0 ||
+            grow_column((void **)&table->ip_address_len, sizeof(uint8_t), capacity) != 0 ||
+            grow_column((void **)&table->web_server_port, sizeof(uint16_t), capacity) != 0 ||
+            grow_column((void **)&table->web_server_secret_offset, sizeof(uint32_t), capacity) != 0 ||
+            grow_column((void **)&table->web_server_secret_len, sizeof(uint16_t), capacity) != 0 ||
+            grow_column((void **)&table->web_server_certificate_offset, sizeof(uint32_t), capacity) != 0 ||
+            grow_column((void **)&table->web_server_certificate_len, sizeof(uint32_t), capacity) != 0 ||
+            grow_column((void **)&table->region_id, sizeof(uint32_t), capacity) != 0 ||
+            grow_column((void **)&table->capabilities, sizeof(uint32_t), capacity) != 0) {
+            // Columns that did grow keep their larger allocation, which is harmless.
+            return -1;
+        }
+        table->capacity = capacity;
+    }
+
+    if (table->strings_len + strings_len > UINT32_MAX) {
+        return -1;
+    }
+
+    if (table->strings_len + strings_len > table->strings_capacity) {
+        size_t capacity = (table->strings_capacity == 0) ? 64 * 1024 : table->strings_capacity;
+        while (capacity < table->strings_len + strings_len) {
+            capacity *= 2;
+        }
+        if (grow_column((void **)&table->strings, 1, capacity) != 0) {
+            return -1;
+        }
+        table->strings_capacity = capacity;
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief Returns 1 if every byte of `s` is a printable ASCII character other than space, otherwise 0.
+ */
+static int is_printable_ascii(const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] <= ' ' || s[i] > '~') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*!
+ * @brief Parses a decimal port. Returns 0 if the field is not a valid port.
+ */
+static uint16_t parse_port(const char *s, size_t len) {
+    uint32_t port = 0;
+    if (len == 0 || len > 5) {
+        return 0;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return 0;
+        }
+        port = port * 10 + (uint32_t)(s[i] - '0');
+    }
+    return (port > UINT16_MAX) ? 0 : (uint16_t)port;
+}
+
+// See comment in header
+server_entry_table_result server_entry_table_append(server_entry_table *table, const char *entry, size_t len,
+                                                    const char *region, size_t region_len, uint32_t capabilities) {
+    // Split legacy fields.
+    const char *fields[SERVER_ENTRY_LEGACY_FIELDS];
+    size_t field_lens[SERVER_ENTRY_LEGACY_FIELDS];
+    const char *p = entry;
+    const char *end = entry + len;
+
+    for (int i = 0; i < SERVER_ENTRY_LEGACY_FIELDS; i++) {
+        const char *delim = memchr(p, ' ', (size_t)(end - p));
+        if (delim == NULL) {
+            return SERVER_ENTRY_TABLE_ERROR;
+        }
+        fields[i] = p;
+        field_lens[i] = (size_t)(delim - p);
+        p = delim + 1;
+    }
+
+    // IP address, web server secret and web server certificate are stored. The IP address is
+    // returned as a string, so it must be ASCII.
+    if (field_lens[0] > UINT8_MAX || field_lens[2] > UINT16_MAX || !is_printable_ascii(fields[0], field_lens[0])) {
+        return SERVER_ENTRY_TABLE_ERROR;
+    }
+
+    const size_t strings_len = field_lens[0] + field_lens[2] + field_lens[3];
+    if (reserve(table, strings_len) != 0) {
+        return SERVER_ENTRY_TABLE_ERROR;
+    }
+
+    // Interned last, so that the table is unchanged if any step fails.
+    const int id = server_entry_regions_intern(&table->regions, region, region_len);
+    if (id < 0) {
+        return SERVER_ENTRY_TABLE_ERROR;
+    }
+
+    const size_t i = table->count;
+    uint32_t offset = (uint32_t)table->strings_len;
+
+    table->ip_address_offset[i] = offset;
+    table->ip_address_len[i] = (uint8_t)field_lens[0];
+    memcpy(table->strings + offset, fields[0], field_lens[0]);
+    offset += (uint32_t)field_lens[0];
+
+    table->web_server_secret_offset[i] = offset;
+    table->web_server_secret_len[i] = (uint16_t)field_lens[2];
+    memcpy(table->strings + offset, fields[2], field_lens[2]);
+    offset += (uint32_t)field_lens[2];
+
+    table->web_server_certificate_offset[i] = offset;
+    table->web_server_certificate_len[i] = (uint32_t)field_lens[3];
+    memcpy(table->strings + offset, fields[3], field_lens[3]);
+    offset += (uint32_t)field_lens[3];
+
+    table->web_server_port[i] = parse_port(fields[1], field_lens[1]);
+    table->region_id[i] = (uint32_t)id;
+    table->capabilities[i] = capabilities;
+
+    table->strings_len = offset;
+    table->count++;
+
+    return SERVER_ENTRY_TABLE_OK;
+}
+
+// See comment in header
+server_entry_table_result server_entry_table_add(server_entry_table *table, const char *entry, size_t len) {
+    const char *json = server_entry_json_n(entry, len);
+    if (json == NULL) {
+        return SERVER_ENTRY_TABLE_ERROR;
+    }
+
+    json_field fields[] = {
+        {.key = kServerEntryRegionJsonKey},
+        {.key = kServerEntryCapabilitiesJsonKey}
+    };
+
+    if (server_entry_json_scan(json, len - (size_t)(json - entry), fields, 2) != JSON_SCAN_OK ||
+        fields[0].type != JSON_VALUE_STRING ||
+        (fields[1].type != JSON_VALUE_NONE && fields[1].type != JSON_VALUE_ARRAY)) {
+        return SERVER_ENTRY_TABLE_NEEDS_PARSER;
+    }
+
+    uint32_t capabilities = 0;
+    if (fields[1].type == JSON_VALUE_ARRAY) {
+        const char *cursor = fields[1].value;
+        const char *value;
+        size_t value_len;
+        int ret;
+        while ((ret = json_string_array_next(&cursor, fields[1].value + fields[1].value_len,
+                                             &value, &value_len)) == 1) {
+            capabilities |= server_entry_capability_from_name(value, value_len);
+        }
+        if (ret < 0) {
+            return SERVER_ENTRY_TABLE_NEEDS_PARSER;
+        }
+    }
+
+    return server_entry_table_append(table, entry, len, fields[0].value, fields[0].value_len, capabilities);
+}
+
+// See comment in header
+size_t server_entry_table_query(const server_entry_table *table, int region_id, uint32_t capabilities,
+                                uint32_t *indices, size_t max_indices) {
+    size_t matches = 0;
+
+    if (region_id == SERVER_ENTRY_ANY_REGION) {
+        for (size_t i = 0; i < table->count; i++) {
+            if ((table->capabilities[i] & capabilities) == capabilities) {
+                if (matches < max_indices) {
+                    indices[matches] = (uint32_t)i;
+                }
+                matches++;
+            }
+        }
+    } else if (region_id >= 0) {
+        const uint32_t id = (uint32_t)region_id;
+        for (size_t i = 0; i < table->count; i++) {
+            if (table->region_id[i] == id && (table->capabilities[i] & capabilities) == capabilities) {
+                if (matches < max_indices) {
+                    indices[matches] = (uint32_t)i;
+                }
+                matches++;
+            }
+        }
+    }
+
+    return matches;
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EmbeddedServerEntriesTable_h
+#define EmbeddedServerEntriesTable_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Region id which matches entries in any region in `server_entry_table_query`.
+#define SERVER_ENTRY_ANY_REGION (-1)
+
+/*!
+ * @brief Server entry capabilities, as listed in the "capabilities" field of the server entry JSON.
+ *
+ * See https://github.com/Psiphon-Labs/psiphon-tunnel-core/blob/master/psiphon/common/protocol/protocol.go
+ * Capabilities not listed here are ignored.
+ */
+typedef enum {
+    SERVER_ENTRY_CAP_HANDSHAKE                     = 1 << 0,
+    SERVER_ENTRY_CAP_SSH                           = 1 << 1,
+    SERVER_ENTRY_CAP_OSSH                          = 1 << 2,
+    SERVER_ENTRY_CAP_FRONTED_MEEK                  = 1 << 3,
+    SERVER_ENTRY_CAP_FRONTED_MEEK_HTTP             = 1 << 4,
+    SERVER_ENTRY_CAP_UNFRONTED_MEEK                = 1 << 5,
+    SERVER_ENTRY_CAP_UNFRONTED_MEEK_HTTPS          = 1 << 6,
+    SERVER_ENTRY_CAP_UNFRONTED_MEEK_SESSION_TICKET = 1 << 7,
+    SERVER_ENTRY_CAP_QUIC                          = 1 << 8,
+    SERVER_ENTRY_CAP_FRONTED_MEEK_QUIC             = 1 << 9,
+    SERVER_ENTRY_CAP_TAPDANCE                      = 1 << 10,
+    SERVER_ENTRY_CAP_CONJURE                       = 1 << 11,
+    SERVER_ENTRY_CAP_VPN                           = 1 << 12,
+    SERVER_ENTRY_CAP_SSH_API_REQUESTS              = 1 << 13
+} server_entry_capability;
+
+/*!
+ * @brief Region codes interned into ids, which are assigned in order of first occurrence.
+ *
+ * Grows with the number of distinct regions, and any region code, including an empty one, can be interned,
+ * so that an unusual region in one server entry does not stop the others from being read. Codes are stored
+ * back to back in `codes`, each NULL terminated, and found through an open-addressing hash table of ids.
+ *
+ * Must be initialized with `server_entry_regions_init` and freed with `server_entry_regions_free`.
+ */
+typedef struct {
+    size_t count;
+    size_t capacity;
+    uint32_t *offsets;      // Offset of each region code in `codes`.
+    uint32_t *lens;
+
+    uint32_t *slots;        // Region id plus 1. 0 marks an empty slot.
+    size_t slot_capacity;   // Power of 2.
+
+    char *codes;
+    size_t codes_len;
+    size_t codes_capacity;
+} server_entry_regions;
+
+/*!
+ * @brief Compact, struct-of-arrays table of decoded server entries.
+ *
+ * Each column is an array indexed by entry. The legacy space delimited fields (IP address, web server port,
+ * web server secret and web server certificate) are copied into `strings` and referenced by offset. Of the
+ * JSON config only the region, interned into `regions`, and the capabilities, as a bitmask of
+ * `server_entry_capability`, are kept. Any string region is accepted, see `server_entry_regions`, so entries are
+ * only rejected if their legacy fields are malformed.
+ *
+ * Must be initialized with `server_entry_table_init` and freed with `server_entry_table_free`.
+ */
+typedef struct {
+    size_t count;
+    size_t capacity;
+
+    // Columns
+    uint32_t *ip_address_offset;
+    uint8_t *ip_address_len;
+    uint16_t *web_server_port;
+    uint32_t *web_server_secret_offset;
+    uint16_t *web_server_secret_len;
+    uint32_t *web_server_certificate_offset;
+    uint32_t *web_server_certificate_len;
+    uint32_t *region_id;
+    uint32_t *capabilities;
+
+    server_entry_regions regions;
+
+    // Storage for legacy fields.
+    char *strings;
+    size_t strings_len;
+    size_t strings_capacity;
+} server_entry_table;
+
+/*!
+ * @brief Result of adding a server entry with `server_entry_table_add`.
+ */
+typedef enum {
+    SERVER_ENTRY_TABLE_OK = 0,
+    /// The server entry's legacy fields are malformed, e.g. the IP address is not printable ASCII,
+    /// or the table could not grow.
+    SERVER_ENTRY_TABLE_ERROR = -1,
+    /// The JSON config could not be scanned without a full JSON parser. The caller must parse the
+    /// JSON and add the entry with `server_entry_table_append`.
+    SERVER_ENTRY_TABLE_NEEDS_PARSER = -2
+} server_entry_table_result;
+
+/*!
+ * @brief Initializes an empty set of regions.
+ */
+void server_entry_regions_init(server_entry_regions *regions);
+
+/*!
+ * @brief Frees all memory held by the regions and resets them to an empty set.
+ */
+void server_entry_regions_free(server_entry_regions *regions);
+
+/*!
+ * @brief Returns the id of the region code, or -1 if it has not been interned.
+ */
+int server_entry_regions_find(const server_entry_regions *regions, const char *region, size_t len);
+
+/*!
+ * @brief Returns the id of the region code, interning it if it has not been seen.
+ * @return Region id, or -1 if the regions could not grow, in which case they are unchanged.
+ */
+int server_entry_regions_intern(server_entry_regions *regions, const char *region, size_t len);
+
+/*!
+ * @brief Returns the NULL terminated region code with id `id`, which must be less than `regions->count`.
+ * @param len Set to the length of the region code, which may itself contain NULL bytes.
+ */
+const char *server_entry_regions_code(const server_entry_regions *regions, int id, size_t *len);
+
+/*!
+ * @brief Initializes an empty table.
+ */
+void server_entry_table_init(server_entry_table *table);
+
+/*!
+ * @brief Frees all memory held by the table and resets it to an empty table.
+ */
+void server_entry_table_free(server_entry_table *table);
+
+/*!
+ * @brief Returns the capability bit for the capability name, or 0 if the capability is not known.
+ */
+uint32_t server_entry_capability_from_name(const char *name, size_t len);
+
+/*!
+ * @brief Returns the id of the interned region code, or -1 if no entry in the table is in the region.
+ */
+int server_entry_table_region_id(const server_entry_table *table, const char *region, size_t len);
+
+/*!
+ * @brief Adds a hex decoded server entry to the table.
+ *
+ * @param table Table.
+ * @param entry Decoded server entry, i.e. the 4 legacy space delimited fields followed by the JSON config.
+ * Need not be NULL terminated.
+ * @param len Length of `entry`.
+ * @return See `server_entry_table_result`. The table is unchanged unless `SERVER_ENTRY_TABLE_OK` is returned.
+ */
+server_entry_table_result server_entry_table_add(server_entry_table *table, const char *entry, size_t len);
+
+/*!
+ * @brief Adds a server entry to the table whose JSON config has already been parsed by the caller.
+ *
+ * @param table Table.
+ * @param entry Decoded server entry. Only the legacy fields are read.
+ * @param len Length of `entry`.
+ * @param region Region code.
+ * @param region_len Length of `region`.
+ * @param capabilities Bitmask of `server_entry_capability`.
+ * @return `SERVER_ENTRY_TABLE_OK` or `SERVER_ENTRY_TABLE_ERROR`.
+ */
+server_entry_table_result server_entry_table_append(server_entry_table *table, const char *entry, size_t len,
+                                                    const char *region, size_t region_len, uint32_t capabilities);
+
+/*!
+ * @brief Finds entries in a region which support all of the given capabilities.
+ *
+ * @param table Table.
+ * @param region_id Region id, see `server_entry_table_region_id`, or `SERVER_ENTRY_ANY_REGION`.
+ * @param capabilities Bitmask of `server_entry_capability` that matching entries must all support. 0 matches all entries.
+ * @param indices Populated with the indices of up to `max_indices` matching entries in table order. May be NULL
+ * if `max_indices` is 0, e.g. to count matches.
+ * @param max_indices Capacity of `indices`.
+ * @return Total number of matching entries, which may be greater than `max_indices`.
+ */
+size_t server_entry_table_query(const server_entry_table *table, int region_id, uint32_t capabilities,
+                                uint32_t *indices, size_t max_indices);
+
+#endif /* EmbeddedServerEntriesTable_h */
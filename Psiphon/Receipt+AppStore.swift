@@ -50,7 +50,36 @@ extension ReceiptData {
         
         let readDate = getCurrentTime()
         
-        guard let parsedData = AppStoreParsedReceiptData.parseReceiptData(data) else {
+        // Computes whether any of subscription purchases in the receipt
+        // have the "is_in_intro_offer_period" set to true.
+        var hasSubscriptionBeenInIntroOfferPeriod = false
+        
+        // Only subscription purchases that have not expired by `readDate` and consumable
+        // purchases are kept, which are a small part of a long purchase history.
+        // The receipt is only decoded when it has changed since it was last read, and then
+        // every purchase is decoded to be cached.
+        let parsedReceiptData = AppStoreParsedReceiptData.parseReceiptData(
+            data,
+            cachePath: AppStoreParsedReceiptData.defaultCachePath(),
+            iapFilter: {
+                productIdentifier, expiresDate, isInIntroPeriod -> Bool in
+                let productID = ProductID(rawValue: productIdentifier)!
+                switch isSupportedProduct(productID) {
+                case .subscription:
+                    hasSubscriptionBeenInIntroOfferPeriod =
+                        hasSubscriptionBeenInIntroOfferPeriod || isInIntroPeriod
+                    guard let expiresDate = expiresDate else {
+                        return true
+                    }
+                    return compareDates(readDate, expiresDate, .second) == .orderedAscending
+                case .some(let productType):
+                    return productType.isConsumable
+                case .none:
+                    return false
+                }
+            })
+        
+        guard let parsedData = parsedReceiptData else {
             feedbackLogger.immediate(.error, "failed to parse app receipt")
             return .none
         }
@@ -64,15 +93,6 @@ extension ReceiptData {
             originalAppVersion = .production(version: parsedData.originalApplicationVersion)
         }
         
-        // Computes whether any of subscription purchases in the receipt
-        // have the "is_in_intro_offer_period" set to true.
-        let hasSubscriptionBeenInIntroOfferPeriod = parsedData.inAppPurchases.filter {
-            let productID = ProductID(rawValue: $0.productIdentifier)!
-            return isSupportedProduct(productID) == .subscription
-        }.map {
-            $0.isInIntroPeriod
-        }.contains(true)
-
         // Filters out subscription purchases that have already expired at by `readDate`.
         let subscriptionPurchases = Set(parsedData.inAppPurchases
             .compactMap { parsedIAP -> SubscriptionIAPPurchase? in
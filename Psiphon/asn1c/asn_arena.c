@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * Redistribution and modifications are permitted subject to BSD license.
+ */
+#include "asn_internal.h"
+#include "asn_arena.h"
+#include <stdint.h>
+
+#define	ASN_ARENA_DEFAULT_CHUNK_SIZE	(16 * 1024)
+#define	ASN_ARENA_MAX_CHUNK_SIZE	(1024 * 1024)
+#define	ASN_ARENA_ALIGNMENT		16
+/* Allocations of this size or larger are served by the C library. */
+#define	ASN_ARENA_LARGE_SIZE		(4 * 1024)
+
+typedef struct asn_arena_chunk_s {
+	struct asn_arena_chunk_s *next;
+	char *start;	/* First allocation */
+	char *top;	/* Next free byte */
+	char *end;	/* End of chunk */
+	char *last;	/* Most recent allocation, grown or released in place */
+} asn_arena_chunk_t;
+
+/*
+ * Each allocation is preceded by a header holding its size,
+ * which REALLOC needs to copy the allocation.
+ */
+typedef union asn_arena_header_u {
+	size_t size;
+	char align[ASN_ARENA_ALIGNMENT];
+} asn_arena_header_t;
+
+/*
+ * Large allocations are preceded by a header linking them into the arena,
+ * so that they can be resized and freed individually.
+ */
+typedef union asn_arena_large_u {
+	struct {
+		union asn_arena_large_u *next;
+		union asn_arena_large_u *prev;
+		size_t size;
+	} l;
+	char align[2 * ASN_ARENA_ALIGNMENT];
+} asn_arena_large_t;
+
+#define	ALIGN_UP(n)	(((n) + (ASN_ARENA_ALIGNMENT - 1)) & ~(size_t)(ASN_ARENA_ALIGNMENT - 1))
+
+static _Thread_local asn_arena_t *asn_arena_current;
+
+void
+asn_arena_init(asn_arena_t *arena, size_t initial_chunk_size) {
+	arena->chunks = 0;
+	arena->large = 0;
+	arena->next_chunk_size = initial_chunk_size
+		? initial_chunk_size : ASN_ARENA_DEFAULT_CHUNK_SIZE;
+	arena->allocations = 0;
+	arena->chunk_count = 0;
+}
+
+void
+asn_arena_destroy(asn_arena_t *arena) {
+	asn_arena_chunk_t *chunk = arena->chunks;
+	while(chunk) {
+		asn_arena_chunk_t *next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	arena->chunks = 0;
+	while(arena->large) {
+		asn_arena_large_t *next = arena->large->l.next;
+		free(arena->large);
+		arena->large = next;
+	}
+	arena->chunk_count = 0;
+	arena->allocations = 0;
+}
+
+asn_arena_t *
+asn_arena_set_current(asn_arena_t *arena) {
+	asn_arena_t *previous = asn_arena_current;
+	asn_arena_current = arena;
+	return previous;
+}
+
+/*
+ * Returns the chunk holding (ptr), or 0 if (ptr) was not allocated
+ * from the arena. Chunks grow geometrically, so there are few of them.
+ */
+static asn_arena_chunk_t *
+asn_arena_owner(asn_arena_t *arena, const void *ptr) {
+	asn_arena_chunk_t *chunk;
+	for(chunk = arena->chunks; chunk; chunk = chunk->next) {
+		if((const char *)ptr >= chunk->start
+		&& (const char *)ptr < chunk->end)
+			return chunk;
+	}
+	return 0;
+}
+
+/*
+ * Returns the header of the large allocation (ptr), or 0 if (ptr) is not
+ * a large allocation of the arena. There are few large allocations.
+ */
+static asn_arena_large_t *
+asn_arena_large_owner(asn_arena_t *arena, const void *ptr) {
+	asn_arena_large_t *large;
+	for(large = arena->large; large; large = large->l.next) {
+		if(ptr == (const void *)(large + 1))
+			return large;
+	}
+	return 0;
+}
+
+static void
+asn_arena_large_link(asn_arena_t *arena, asn_arena_large_t *large) {
+	large->l.prev = 0;
+	large->l.next = arena->large;
+	if(arena->large)
+		arena->large->l.prev = large;
+	arena->large = large;
+}
+
+static void
+asn_arena_large_unlink(asn_arena_t *arena, asn_arena_large_t *large) {
+	if(large->l.prev)
+		large->l.prev->l.next = large->l.next;
+	else
+		arena->large = large->l.next;
+	if(large->l.next)
+		large->l.next->l.prev = large->l.prev;
+}
+
+static void *
+asn_arena_alloc(asn_arena_t *arena, size_t size) {
+	asn_arena_chunk_t *chunk = arena->chunks;
+	size_t needed;
+	asn_arena_header_t *header;
+
+	if(size > SIZE_MAX / 2)
+		return 0;
+
+	if(size >= ASN_ARENA_LARGE_SIZE) {
+		asn_arena_large_t *large;
+		large = (asn_arena_large_t *)malloc(sizeof(*large) + size);
+		if(!large)
+			return 0;
+		large->l.size = size;
+		asn_arena_large_link(arena, large);
+		arena->allocations++;
+		return large + 1;
+	}
+
+	needed = sizeof(asn_arena_header_t) + ALIGN_UP(size);
+
+	if(!chunk || (size_t)(chunk->end - chunk->top) < needed) {
+		size_t chunk_size = arena->next_chunk_size;
+		size_t header_size = ALIGN_UP(sizeof(asn_arena_chunk_t));
+		if(chunk_size < needed)
+			chunk_size = needed;
+		chunk = (asn_arena_chunk_t *)malloc(header_size + chunk_size);
+		if(!chunk)
+			return 0;
+		chunk->start = (char *)chunk + header_size;
+		chunk->top = chunk->start;
+		chunk->end = chunk->start + chunk_size;
+		chunk->last = 0;
+		chunk->next = arena->chunks;
+		arena->chunks = chunk;
+		arena->chunk_count++;
+		if(arena->next_chunk_size < ASN_ARENA_MAX_CHUNK_SIZE)
+			arena->next_chunk_size *= 2;
+	}
+
+	header = (asn_arena_header_t *)chunk->top;
+	header->size = size;
+	chunk->last = chunk->top;
+	chunk->top += needed;
+	arena->allocations++;
+
+	return header + 1;
+}
+
+void *
+asn_malloc(size_t size) {
+	asn_arena_t *arena = asn_arena_current;
+	if(!arena)
+		return malloc(size);
+	return asn_arena_alloc(arena, size);
+}
+
+void *
+asn_calloc(size_t nmemb, size_t size) {
+	asn_arena_t *arena = asn_arena_current;
+	void *ptr;
+
+	if(!arena)
+		return calloc(nmemb, size);
+
+	if(size && nmemb > SIZE_MAX / size)
+		return 0;
+
+	ptr = asn_arena_alloc(arena, nmemb * size);
+	if(ptr)
+		memset(ptr, 0, nmemb * size);
+	return ptr;
+}
+
+void *
+asn_realloc(void *ptr, size_t size) {
+	asn_arena_t *arena = asn_arena_current;
+	asn_arena_chunk_t *chunk;
+	asn_arena_header_t *header;
+	asn_arena_large_t *large;
+	void *grown;
+
+	if(!arena || !ptr)
+		return arena ? asn_arena_alloc(arena, size) : realloc(ptr, size);
+
+	chunk = asn_arena_owner(arena, ptr);
+	if(!chunk) {
+		large = asn_arena_large_owner(arena, ptr);
+		if(!large)
+			return realloc(ptr, size);
+		/* Large allocations are resized by the C library, which reclaims the old block. */
+		if(size > SIZE_MAX / 2)
+			return 0;
+		asn_arena_large_unlink(arena, large);
+		grown = realloc(large, sizeof(*large) + size);
+		if(!grown) {
+			asn_arena_large_link(arena, large);
+			return 0;
+		}
+		large = (asn_arena_large_t *)grown;
+		large->l.size = size;
+		asn_arena_large_link(arena, large);
+		return large + 1;
+	}
+
+	header = (asn_arena_header_t *)ptr - 1;
+
+	/* The most recent allocation of a chunk is resized in place if it fits. */
+	if((char *)header == chunk->last && size <= SIZE_MAX / 2) {
+		size_t needed = sizeof(asn_arena_header_t) + ALIGN_UP(size);
+		if((size_t)(chunk->end - chunk->last) >= needed) {
+			header->size = size;
+			chunk->top = chunk->last + needed;
+			return ptr;
+		}
+	}
+
+	if(size <= header->size) {
+		header->size = size;
+		return ptr;
+	}
+
+	grown = asn_arena_alloc(arena, size);
+	if(!grown)
+		return 0;
+	memcpy(grown, ptr, header->size);
+
+	/* The old allocation is given back if it was the most recent of its chunk. */
+	if((char *)header == chunk->last) {
+		chunk->top = chunk->last;
+		chunk->last = 0;
+	}
+
+	return grown;
+}
+
+void
+asn_freemem(void *ptr) {
+	asn_arena_t *arena = asn_arena_current;
+	asn_arena_chunk_t *chunk;
+
+	if(!ptr)
+		return;
+
+	if(!arena) {
+		free(ptr);
+		return;
+	}
+
+	chunk = asn_arena_owner(arena, ptr);
+	if(!chunk) {
+		asn_arena_large_t *large = asn_arena_large_owner(arena, ptr);
+		if(large) {
+			asn_arena_large_unlink(arena, large);
+			free(large);
+		} else {
+			free(ptr);
+		}
+		return;
+	}
+
+	/* Only the most recent allocation of a chunk is given back. */
+	if((char *)((asn_arena_header_t *)ptr - 1) == chunk->last) {
+		chunk->top = chunk->last;
+		chunk->last = 0;
+	}
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * Redistribution and modifications are permitted subject to BSD license.
+ */
+/*
+ * Optional per-decode arena for the memory allocated by the ASN.1 support code.
+ *
+ * All allocations of the support code go through the CALLOC, MALLOC, REALLOC
+ * and FREEMEM macros in asn_internal.h, which are served from the arena that
+ * is current on the calling thread, if any, and from the C library otherwise.
+ *
+ * Typical use:
+ *
+ *	asn_arena_t arena;
+ *	asn_arena_init(&arena, 0);
+ *	asn_arena_t *previous = asn_arena_set_current(&arena);
+ *	rval = ber_decode(0, &asn_DEF_SignedData, (void **)&signedData, buf, size);
+ *	asn_arena_set_current(previous);
+ *	... use signedData ...
+ *	asn_arena_destroy(&arena);	// Instead of ASN_STRUCT_FREE.
+ *
+ * Small allocations are carved out of chunks and are only released by
+ * asn_arena_destroy(). Allocations of 4 KiB or more, such as the arrays of
+ * SET OF and the buffers of long OCTET STRINGs that grow by doubling, are
+ * served by the C library instead, and are resized and freed in place so that
+ * their old copies do not accumulate. Structures decoded into an arena must not
+ * be freed with ASN_STRUCT_FREE once the arena is no longer current, and must
+ * not be used after the arena is destroyed.
+ * An arena pays off for structures that are decoded and released together,
+ * so use one arena for each, as ASN_STRUCT_FREE would be called for each.
+ * Memory allocated from the C library before the arena was made current may
+ * still be freed or reallocated while the arena is current.
+ */
+#ifndef	ASN_ARENA_H
+#define	ASN_ARENA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct asn_arena_chunk_s;
+union asn_arena_large_u;
+
+typedef struct asn_arena_s {
+	struct asn_arena_chunk_s *chunks;	/* Most recent chunk first */
+	union asn_arena_large_u *large;	/* Allocations served by the C library */
+	size_t next_chunk_size;
+	size_t allocations;	/* Number of allocations served */
+	size_t chunk_count;	/* Number of chunks allocated */
+} asn_arena_t;
+
+/*
+ * Initializes an empty arena. No memory is allocated until first use.
+ * (initial_chunk_size) of 0 selects the default.
+ */
+void asn_arena_init(asn_arena_t *arena, size_t initial_chunk_size);
+
+/*
+ * Releases all memory of the arena in one go.
+ * The arena may be initialized and used again afterwards.
+ */
+void asn_arena_destroy(asn_arena_t *arena);
+
+/*
+ * Makes (arena) the current arena of the calling thread, or restores the
+ * C library allocator if (arena) is NULL. Returns the previous arena.
+ */
+asn_arena_t *asn_arena_set_current(asn_arena_t *arena);
+
+/*
+ * Allocators used by the CALLOC, MALLOC, REALLOC and FREEMEM macros.
+ */
+void *asn_calloc(size_t nmemb, size_t size);
+void *asn_malloc(size_t size);
+void *asn_realloc(void *ptr, size_t size);
+void asn_freemem(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* ASN_ARENA_H */
@@ -23,10 +23,22 @@ extern "C" {
 #define	ASN1C_ENVIRONMENT_VERSION	923	/* Compile-time version */
 int get_asn1c_environment_version(void);	/* Run-time version */
 
+/*
+ * Allocations are served from the current arena, if any (see asn_arena.h).
+ * Define ASN_DISABLE_ARENA to use the C library allocator directly.
+ */
+#ifdef	ASN_DISABLE_ARENA
 #define	CALLOC(nmemb, size)	calloc(nmemb, size)
 #define	MALLOC(size)		malloc(size)
 #define	REALLOC(oldptr, size)	realloc(oldptr, size)
 #define	FREEMEM(ptr)		free(ptr)
+#else	/* !ASN_DISABLE_ARENA */
+#include "asn_arena.h"
+#define	CALLOC(nmemb, size)	asn_calloc(nmemb, size)
+#define	MALLOC(size)		asn_malloc(size)
+#define	REALLOC(oldptr, size)	asn_realloc(oldptr, size)
+#define	FREEMEM(ptr)		asn_freemem(ptr)
+#endif	/* ASN_DISABLE_ARENA */
 
 #define	asn_debug_indent	0
 #define ASN_DEBUG_INDENT_ADD(i) do{}while(0)
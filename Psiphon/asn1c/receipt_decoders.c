@@ -0,0 +1,667 @@
+/*
+ * Generated by gen_asn1_decoders.py
+ * From ASN.1 module "Simplified-PKCS7"
+ * 	found in "pkcs7-signed-data-simplified.asn1"
+ * Do not edit, regenerate instead.
+ */
+
+#include "asn_internal.h"
+#include "receipt_decoders.h"
+
+/*
+ * The decoders below return the number of bytes consumed, or -1 if the
+ * encoding is one that they leave to the generic decoders.
+ */
+
+/* Arguments for a tags array */
+#define	FD_TAGS(tags)	tags, (int)(sizeof(tags) / sizeof(tags[0]))
+
+/* Maximum nesting of constructed TLVs within an ANY value */
+#define	FD_MAX_ANY_DEPTH	16
+
+/*
+ * Fetches the tag and the length of the TLV at (p).
+ * Returns the combined length of T and L, or -1 if they are malformed or
+ * a definite length value does not end before (end).
+ */
+static ssize_t
+fd_fetch_tl(const uint8_t *p, const uint8_t *end, ber_tlv_tag_t *tag,
+		int *constructed, ber_tlv_len_t *len) {
+	ssize_t tl, ll;
+
+	tl = ber_fetch_tag(p, end - p, tag);
+	if(tl <= 0) return -1;
+	*constructed = BER_TLV_CONSTRUCTED(p);
+	ll = ber_fetch_length(*constructed, p + tl, end - p - tl, len);
+	if(ll <= 0) return -1;
+	if(*len > end - p - tl - ll) return -1;
+
+	return tl + ll;
+}
+
+/*
+ * Checks the chain of (tags_count) tags at (*p), as ber_check_tags() does:
+ * either all lengths are definite and each TLV exactly fills the enclosing
+ * one, or all lengths are indefinite. (form) is the expected form of the
+ * innermost TLV: 0 for primitive, 1 for constructed and -1 for either.
+ * On success, advances (*p) to the contents, sets (*end) to the end of the
+ * contents if the lengths are definite, and returns the number of
+ * end-of-contents octets pairs that follow the contents.
+ */
+static int
+fd_open(const uint8_t **p, const uint8_t **end, const ber_tlv_tag_t *tags,
+		int tags_count, int form, int *constructed) {
+	const uint8_t *ptr = *p;
+	int eocs = 0;
+	int constr = 0;
+	int i;
+
+	for(i = 0; i < tags_count; i++) {
+		ber_tlv_tag_t tag;
+		ber_tlv_len_t len;
+		ssize_t tl;
+
+		tl = fd_fetch_tl(ptr, *end, &tag, &constr, &len);
+		if(tl < 0 || tag != tags[i]) return -1;
+		if(i < tags_count - 1) {
+			if(!constr) return -1;
+		} else if(form != -1 && constr != form) {
+			return -1;
+		}
+
+		if(len < 0) {
+			/* Indefinite lengths may not follow definite ones */
+			if(eocs != i) return -1;
+			eocs++;
+		} else {
+			if(eocs) return -1;
+			if(i > 0 && ptr + tl + len != *end) return -1;
+			*end = ptr + tl + len;
+		}
+
+		ptr += tl;
+	}
+
+	*p = ptr;
+	if(constructed) *constructed = constr;
+
+	return eocs;
+}
+
+/*
+ * Returns 1 if end-of-contents octets are at (p).
+ */
+static int
+fd_at_eoc(const uint8_t *p, const uint8_t *end) {
+	return end - p >= 2 && p[0] == 0 && p[1] == 0;
+}
+
+/*
+ * Reads (eocs) end-of-contents octets pairs at (*p).
+ */
+static int
+fd_close(const uint8_t **p, const uint8_t *end, int eocs) {
+	for(; eocs > 0; eocs--) {
+		if(!fd_at_eoc(*p, end)) return -1;
+		*p += 2;
+	}
+	return 0;
+}
+
+/*
+ * Skips the extensions at the end of an extensible SEQUENCE: up to (end)
+ * if its length is definite, up to its end-of-contents octets otherwise.
+ */
+static int
+fd_skip_extensions(asn_codec_ctx_t *ctx, const uint8_t **p,
+		const uint8_t *end, int eocs) {
+	const uint8_t *ptr = *p;
+
+	while(ptr < end && !(eocs && fd_at_eoc(ptr, end))) {
+		ber_tlv_tag_t tag;
+		ssize_t tl, ll;
+
+		tl = ber_fetch_tag(ptr, end - ptr, &tag);
+		if(tl <= 0) return -1;
+		ll = ber_skip_length(ctx, BER_TLV_CONSTRUCTED(ptr),
+			ptr + tl, end - ptr - tl);
+		if(ll <= 0) return -1;
+		ptr += tl + ll;
+	}
+
+	*p = ptr;
+	return 0;
+}
+
+/*
+ * Copies (size) bytes into a new NUL terminated buffer, as the primitive
+ * decoders do.
+ */
+static int
+fd_copy(uint8_t **buf, int *buf_size, const uint8_t *p, size_t size) {
+	if(size > INT32_MAX - 1) return -1;
+	*buf = (uint8_t *)MALLOC(size + 1);
+	if(*buf == 0) return -1;
+	memcpy(*buf, p, size);
+	(*buf)[size] = '\0';
+	*buf_size = (int)size;
+	return 0;
+}
+
+static ssize_t
+fd_decode_native_integer(long *st, const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+	INTEGER_t tmp;
+
+	if(fd_open(&p, &end, tags, tags_count, 0, 0) != 0) return -1;
+
+	tmp.buf = (uint8_t *)p;
+	tmp.size = (int)(end - p);
+	if(asn_INTEGER2long(&tmp, st)) return -1;
+
+	return end - start;
+}
+
+static ssize_t
+fd_decode_primitive(ASN__PRIMITIVE_TYPE_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+
+	if(fd_open(&p, &end, tags, tags_count, 0, 0) != 0) return -1;
+	if(fd_copy(&st->buf, &st->size, p, end - p)) return -1;
+
+	return end - start;
+}
+
+/*
+ * Decodes an OCTET STRING, either primitive or constructed of primitive
+ * segments. Segments which are themselves constructed are left to the
+ * generic decoder.
+ */
+static ssize_t
+fd_decode_octet_string(OCTET_STRING_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+	const uint8_t *segments;
+	size_t size = 0;
+	int constructed;
+	int eocs;
+
+	eocs = fd_open(&p, &end, tags, tags_count, -1, &constructed);
+	if(eocs < 0) return -1;
+
+	if(!constructed) {
+		if(fd_copy(&st->buf, &st->size, p, end - p)) return -1;
+		return end - start;
+	}
+
+	/* Sizes the segments, then copies them */
+	for(segments = p; eocs ? !fd_at_eoc(p, end) : p < end;) {
+		ber_tlv_tag_t tag;
+		ber_tlv_len_t len;
+		ssize_t tl;
+		int constr;
+
+		tl = fd_fetch_tl(p, end, &tag, &constr, &len);
+		if(tl < 0 || constr
+		|| tag != (ASN_TAG_CLASS_UNIVERSAL | (4 << 2)))
+			return -1;
+		size += len;
+		p += tl + len;
+	}
+	if(eocs == 0 && p != end) return -1;
+
+	/* Like the generic decoder, leaves (buf) NULL if there are no contents */
+	if(size) {
+		uint8_t *buf;
+		if(size > INT32_MAX - 1) return -1;
+		st->buf = buf = (uint8_t *)MALLOC(size + 1);
+		if(buf == 0) return -1;
+		for(p = segments; eocs ? !fd_at_eoc(p, end) : p < end;) {
+			ber_tlv_tag_t tag;
+			ber_tlv_len_t len;
+			int constr;
+			ssize_t tl = fd_fetch_tl(p, end, &tag, &constr, &len);
+			memcpy(buf, p + tl, len);
+			buf += len;
+			p += tl + len;
+		}
+		*buf = '\0';
+		st->size = (int)size;
+	}
+
+	if(fd_close(&p, end, eocs)) return -1;
+
+	return p - start;
+}
+
+/*
+ * Checks that the contents of a constructed definite length TLV are
+ * exactly filled with definite length TLVs, as the ANY decoder does.
+ */
+static int
+fd_check_definite(const uint8_t *p, const uint8_t *end, int depth) {
+	if(depth > FD_MAX_ANY_DEPTH) return -1;
+
+	while(p < end) {
+		ber_tlv_tag_t tag;
+		ber_tlv_len_t len;
+		ssize_t tl;
+		int constr;
+
+		tl = fd_fetch_tl(p, end, &tag, &constr, &len);
+		if(tl < 0 || len < 0) return -1;
+		if(constr && fd_check_definite(p + tl, p + tl + len, depth + 1))
+			return -1;
+		p += tl + len;
+	}
+
+	return 0;
+}
+
+/*
+ * Decodes an untagged ANY, i.e. copies its whole TLV.
+ * Indefinite length values are left to the generic decoder.
+ */
+static ssize_t
+fd_decode_any(ANY_t *st, const uint8_t *p, const uint8_t *end) {
+	ber_tlv_tag_t tag;
+	ber_tlv_len_t len;
+	ssize_t tl;
+	int constr;
+
+	tl = fd_fetch_tl(p, end, &tag, &constr, &len);
+	if(tl < 0 || len < 0) return -1;
+	if(constr && fd_check_definite(p + tl, p + tl + len, 1)) return -1;
+	if(fd_copy(&st->buf, &st->size, p, tl + len)) return -1;
+
+	return tl + len;
+}
+
+static const ber_tlv_tag_t fd_tags_SignedData[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (16 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_SignedData_contentType[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (6 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_SignedData_content[] = {
+	(ASN_TAG_CLASS_CONTEXT | (0 << 2)),
+	(ASN_TAG_CLASS_UNIVERSAL | (16 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_SignedData_content_version[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (2 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_SignedData_content_contentInfo[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (16 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_SignedData_content_contentInfo_contentType[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (6 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_SignedData_content_contentInfo_contentData[] = {
+	(ASN_TAG_CLASS_CONTEXT | (0 << 2)),
+	(ASN_TAG_CLASS_UNIVERSAL | (4 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_ReceiptAttribute[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (16 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_ReceiptAttribute_type[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (2 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_ReceiptAttribute_version[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (2 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_ReceiptAttribute_value[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (4 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_ReceiptAttributes[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (17 << 2))
+};
+
+static const ber_tlv_tag_t fd_tags_ReceiptAttributes_element[] = {
+	(ASN_TAG_CLASS_UNIVERSAL | (16 << 2))
+};
+
+static ssize_t
+fd_decode_SignedData_content_contentInfo(asn_codec_ctx_t *ctx, struct contentInfo *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count);
+
+static ssize_t
+fd_decode_SignedData_content(asn_codec_ctx_t *ctx, struct content *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count);
+
+static ssize_t
+fd_decode_SignedData(asn_codec_ctx_t *ctx, SignedData_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count);
+
+static ssize_t
+fd_decode_ReceiptAttribute(asn_codec_ctx_t *ctx, ReceiptAttribute_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count);
+
+static ssize_t
+fd_decode_ReceiptAttributes(asn_codec_ctx_t *ctx, ReceiptAttributes_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count);
+
+static ssize_t
+fd_decode_SignedData_content_contentInfo(asn_codec_ctx_t *ctx, struct contentInfo *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+	ssize_t n;
+	int eocs;
+
+	(void)ctx;
+
+	eocs = fd_open(&p, &end, tags, tags_count, 1, 0);
+	if(eocs < 0) return -1;
+
+	/* contentType */
+	n = fd_decode_primitive(&st->contentType, p, end,
+		FD_TAGS(fd_tags_SignedData_content_contentInfo_contentType));
+	if(n < 0) return -1;
+	p += n;
+
+	/* contentData */
+	n = fd_decode_octet_string(&st->contentData, p, end,
+		FD_TAGS(fd_tags_SignedData_content_contentInfo_contentData));
+	if(n < 0) return -1;
+	p += n;
+
+	if(eocs == 0 && p != end) return -1;
+
+	if(fd_close(&p, end, eocs)) return -1;
+
+	return p - start;
+}
+
+static ssize_t
+fd_decode_SignedData_content(asn_codec_ctx_t *ctx, struct content *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+	ssize_t n;
+	int eocs;
+
+	eocs = fd_open(&p, &end, tags, tags_count, 1, 0);
+	if(eocs < 0) return -1;
+
+	/* version */
+	n = fd_decode_native_integer(&st->version, p, end,
+		FD_TAGS(fd_tags_SignedData_content_version));
+	if(n < 0) return -1;
+	p += n;
+
+	/* digestAlgorithms */
+	n = fd_decode_any(&st->digestAlgorithms, p, end);
+	if(n < 0) return -1;
+	p += n;
+
+	/* contentInfo */
+	n = fd_decode_SignedData_content_contentInfo(ctx, &st->contentInfo, p, end,
+		FD_TAGS(fd_tags_SignedData_content_contentInfo));
+	if(n < 0) return -1;
+	p += n;
+
+	/* Extensions are skipped */
+	if(fd_skip_extensions(ctx, &p, end, eocs)) return -1;
+
+	if(fd_close(&p, end, eocs)) return -1;
+
+	return p - start;
+}
+
+static ssize_t
+fd_decode_SignedData(asn_codec_ctx_t *ctx, SignedData_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+	ssize_t n;
+	int eocs;
+
+	eocs = fd_open(&p, &end, tags, tags_count, 1, 0);
+	if(eocs < 0) return -1;
+
+	/* contentType */
+	n = fd_decode_primitive(&st->contentType, p, end,
+		FD_TAGS(fd_tags_SignedData_contentType));
+	if(n < 0) return -1;
+	p += n;
+
+	/* content */
+	n = fd_decode_SignedData_content(ctx, &st->content, p, end,
+		FD_TAGS(fd_tags_SignedData_content));
+	if(n < 0) return -1;
+	p += n;
+
+	if(eocs == 0 && p != end) return -1;
+
+	if(fd_close(&p, end, eocs)) return -1;
+
+	return p - start;
+}
+
+static ssize_t
+fd_decode_ReceiptAttribute(asn_codec_ctx_t *ctx, ReceiptAttribute_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+	ssize_t n;
+	int eocs;
+
+	(void)ctx;
+
+	eocs = fd_open(&p, &end, tags, tags_count, 1, 0);
+	if(eocs < 0) return -1;
+
+	/* type */
+	n = fd_decode_native_integer(&st->type, p, end,
+		FD_TAGS(fd_tags_ReceiptAttribute_type));
+	if(n < 0) return -1;
+	p += n;
+
+	/* version */
+	n = fd_decode_native_integer(&st->version, p, end,
+		FD_TAGS(fd_tags_ReceiptAttribute_version));
+	if(n < 0) return -1;
+	p += n;
+
+	/* value */
+	n = fd_decode_octet_string(&st->value, p, end,
+		FD_TAGS(fd_tags_ReceiptAttribute_value));
+	if(n < 0) return -1;
+	p += n;
+
+	if(eocs == 0 && p != end) return -1;
+
+	if(fd_close(&p, end, eocs)) return -1;
+
+	return p - start;
+}
+
+static ssize_t
+fd_decode_ReceiptAttributes(asn_codec_ctx_t *ctx, ReceiptAttributes_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+	ssize_t n;
+	int eocs;
+
+	eocs = fd_open(&p, &end, tags, tags_count, 1, 0);
+	if(eocs < 0) return -1;
+
+	while(eocs ? !fd_at_eoc(p, end) : p < end) {
+		ReceiptAttribute_t *el = (ReceiptAttribute_t *)CALLOC(1, sizeof(*el));
+		if(el == 0) return -1;
+		if(ASN_SET_ADD(&st->list, el)) {
+			FREEMEM(el);
+			return -1;
+		}
+		n = fd_decode_ReceiptAttribute(ctx, el, p, end,
+			FD_TAGS(fd_tags_ReceiptAttributes_element));
+		if(n < 0) return -1;
+		p += n;
+	}
+
+	if(fd_close(&p, end, eocs)) return -1;
+
+	return p - start;
+}
+
+asn_dec_rval_t
+SignedData_decode_fast(asn_codec_ctx_t *opt_codec_ctx,
+		SignedData_t **struct_ptr, const void *buffer, size_t size) {
+	asn_codec_ctx_t s_codec_ctx;
+	SignedData_t *st;
+	ssize_t consumed;
+
+	/*
+	 * Continuing a partial decode is left to the generic decoder.
+	 */
+	if(*struct_ptr)
+		return ber_decode(opt_codec_ctx, &asn_DEF_SignedData,
+			(void **)struct_ptr, buffer, size);
+
+	/*
+	 * Same stack limit as ber_decode() when skipping extensions.
+	 */
+	if(opt_codec_ctx) {
+		s_codec_ctx = *opt_codec_ctx;
+	} else {
+		memset(&s_codec_ctx, 0, sizeof(s_codec_ctx));
+		s_codec_ctx.max_stack_size = ASN__DEFAULT_STACK_MAX;
+	}
+
+	st = (SignedData_t *)CALLOC(1, sizeof(*st));
+	if(st) {
+		consumed = fd_decode_SignedData(
+			s_codec_ctx.max_stack_size ? &s_codec_ctx : 0, st,
+			(const uint8_t *)buffer, (const uint8_t *)buffer + size,
+			FD_TAGS(fd_tags_SignedData));
+		if(consumed >= 0) {
+			asn_dec_rval_t rval;
+			rval.code = RC_OK;
+			rval.consumed = consumed;
+			*struct_ptr = st;
+			return rval;
+		}
+		ASN_STRUCT_FREE(asn_DEF_SignedData, st);
+	}
+
+	/*
+	 * Anything else is decoded, or rejected, by the generic decoder.
+	 */
+	return ber_decode(opt_codec_ctx, &asn_DEF_SignedData,
+		(void **)struct_ptr, buffer, size);
+}
+
+asn_dec_rval_t
+ReceiptAttribute_decode_fast(asn_codec_ctx_t *opt_codec_ctx,
+		ReceiptAttribute_t **struct_ptr, const void *buffer, size_t size) {
+	asn_codec_ctx_t s_codec_ctx;
+	ReceiptAttribute_t *st;
+	ssize_t consumed;
+
+	/*
+	 * Continuing a partial decode is left to the generic decoder.
+	 */
+	if(*struct_ptr)
+		return ber_decode(opt_codec_ctx, &asn_DEF_ReceiptAttribute,
+			(void **)struct_ptr, buffer, size);
+
+	/*
+	 * Same stack limit as ber_decode() when skipping extensions.
+	 */
+	if(opt_codec_ctx) {
+		s_codec_ctx = *opt_codec_ctx;
+	} else {
+		memset(&s_codec_ctx, 0, sizeof(s_codec_ctx));
+		s_codec_ctx.max_stack_size = ASN__DEFAULT_STACK_MAX;
+	}
+
+	st = (ReceiptAttribute_t *)CALLOC(1, sizeof(*st));
+	if(st) {
+		consumed = fd_decode_ReceiptAttribute(
+			s_codec_ctx.max_stack_size ? &s_codec_ctx : 0, st,
+			(const uint8_t *)buffer, (const uint8_t *)buffer + size,
+			FD_TAGS(fd_tags_ReceiptAttribute));
+		if(consumed >= 0) {
+			asn_dec_rval_t rval;
+			rval.code = RC_OK;
+			rval.consumed = consumed;
+			*struct_ptr = st;
+			return rval;
+		}
+		ASN_STRUCT_FREE(asn_DEF_ReceiptAttribute, st);
+	}
+
+	/*
+	 * Anything else is decoded, or rejected, by the generic decoder.
+	 */
+	return ber_decode(opt_codec_ctx, &asn_DEF_ReceiptAttribute,
+		(void **)struct_ptr, buffer, size);
+}
+
+asn_dec_rval_t
+ReceiptAttributes_decode_fast(asn_codec_ctx_t *opt_codec_ctx,
+		ReceiptAttributes_t **struct_ptr, const void *buffer, size_t size) {
+	asn_codec_ctx_t s_codec_ctx;
+	ReceiptAttributes_t *st;
+	ssize_t consumed;
+
+	/*
+	 * Continuing a partial decode is left to the generic decoder.
+	 */
+	if(*struct_ptr)
+		return ber_decode(opt_codec_ctx, &asn_DEF_ReceiptAttributes,
+			(void **)struct_ptr, buffer, size);
+
+	/*
+	 * Same stack limit as ber_decode() when skipping extensions.
+	 */
+	if(opt_codec_ctx) {
+		s_codec_ctx = *opt_codec_ctx;
+	} else {
+		memset(&s_codec_ctx, 0, sizeof(s_codec_ctx));
+		s_codec_ctx.max_stack_size = ASN__DEFAULT_STACK_MAX;
+	}
+
+	st = (ReceiptAttributes_t *)CALLOC(1, sizeof(*st));
+	if(st) {
+		consumed = fd_decode_ReceiptAttributes(
+			s_codec_ctx.max_stack_size ? &s_codec_ctx : 0, st,
+			(const uint8_t *)buffer, (const uint8_t *)buffer + size,
+			FD_TAGS(fd_tags_ReceiptAttributes));
+		if(consumed >= 0) {
+			asn_dec_rval_t rval;
+			rval.code = RC_OK;
+			rval.consumed = consumed;
+			*struct_ptr = st;
+			return rval;
+		}
+		ASN_STRUCT_FREE(asn_DEF_ReceiptAttributes, st);
+	}
+
+	/*
+	 * Anything else is decoded, or rejected, by the generic decoder.
+	 */
+	return ber_decode(opt_codec_ctx, &asn_DEF_ReceiptAttributes,
+		(void **)struct_ptr, buffer, size);
+}
\ No newline at end of file
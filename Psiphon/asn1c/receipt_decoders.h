@@ -0,0 +1,50 @@
+/*
+ * Generated by gen_asn1_decoders.py
+ * From ASN.1 module "Simplified-PKCS7"
+ * 	found in "pkcs7-signed-data-simplified.asn1"
+ * Do not edit, regenerate instead.
+ */
+
+#ifndef	_receipt_decoders_H_
+#define	_receipt_decoders_H_
+
+#include "SignedData.h"
+#include "ReceiptAttribute.h"
+#include "ReceiptAttributes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Decodes a BER encoded SignedData like
+ * ber_decode(opt_codec_ctx, &asn_DEF_SignedData, struct_ptr, buffer, size),
+ * with the same result, but without the generic SEQUENCE and SET OF
+ * decoders for the common encodings.
+ */
+asn_dec_rval_t SignedData_decode_fast(asn_codec_ctx_t *opt_codec_ctx,
+	SignedData_t **struct_ptr, const void *buffer, size_t size);
+
+/*
+ * Decodes a BER encoded ReceiptAttribute like
+ * ber_decode(opt_codec_ctx, &asn_DEF_ReceiptAttribute, struct_ptr, buffer, size),
+ * with the same result, but without the generic SEQUENCE and SET OF
+ * decoders for the common encodings.
+ */
+asn_dec_rval_t ReceiptAttribute_decode_fast(asn_codec_ctx_t *opt_codec_ctx,
+	ReceiptAttribute_t **struct_ptr, const void *buffer, size_t size);
+
+/*
+ * Decodes a BER encoded ReceiptAttributes like
+ * ber_decode(opt_codec_ctx, &asn_DEF_ReceiptAttributes, struct_ptr, buffer, size),
+ * with the same result, but without the generic SEQUENCE and SET OF
+ * decoders for the common encodings.
+ */
+asn_dec_rval_t ReceiptAttributes_decode_fast(asn_codec_ctx_t *opt_codec_ctx,
+	ReceiptAttributes_t **struct_ptr, const void *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* _receipt_decoders_H_ */
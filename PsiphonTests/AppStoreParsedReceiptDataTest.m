@@ -0,0 +1,497 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <XCTest/XCTest.h>
+#import "AppStoreParsedReceiptData.h"
+#import "AppStoreReceiptHelpers.h"
+#import "AppStoreReceiptHelpersTest.h"
+#import "NSDate+PSIDateExtension.h"
+
+// Receipt attribute types, see AppStoreParsedReceiptData.m.
+static const long kBundleIdentifier = 2;
+static const long kInAppPurchaseReceipt = 17;
+static const long kOriginalApplicationVersion = 19;
+static const long kProductIdentifier = 1702;
+static const long kTransactionID = 1703;
+static const long kPurchaseDate = 1704;
+static const long kOriginalTransactionID = 1705;
+static const long kSubscriptionExpirationDate = 1708;
+static const long kWebOrderLineItemID = 1711;
+static const long kCancellationDate = 1712;
+static const long kIsInIntroOfferPeriod = 1719;
+
+// Cache methods of AppStoreParsedReceiptData, which are private.
+@interface AppStoreParsedReceiptData (Cache)
+
++ (NSData *_Nonnull)cacheKeyForReceiptData:(NSData *_Nonnull)data;
+
++ (AppStoreParsedReceiptData *_Nullable)receiptFromCache:(NSString *_Nonnull)cachePath
+                                                     key:(NSData *_Nonnull)key
+                                               iapFilter:(NS_NOESCAPE AppStoreParsedIAPFilter _Nullable)iapFilter;
+
++ (void)writeReceipt:(AppStoreParsedReceiptData *_Nonnull)receipt
+             toCache:(NSString *_Nonnull)cachePath
+                 key:(NSData *_Nonnull)key;
+
+@end
+
+@interface AppStoreParsedReceiptDataTest : XCTestCase
+
+@property (nonatomic, strong) NSString *cachePath;
+
+@end
+
+@implementation AppStoreParsedReceiptDataTest
+
+- (void)setUp {
+    self.cachePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"app_store_receipt_test.cache"];
+    [[NSFileManager defaultManager] removeItemAtPath:self.cachePath error:nil];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath:self.cachePath error:nil];
+}
+
+- (void)testIAPFilter {
+    NSData *receiptData = [AppStoreParsedReceiptDataTest receiptWithIAPs:@[
+        [AppStoreParsedReceiptDataTest subscription:@"product.a" transactionID:@"1"
+                                       purchaseDate:@"2026-01-01T00:00:00Z" expiresDate:@"2026-02-01T00:00:00Z"],
+        [AppStoreParsedReceiptDataTest subscription:@"product.b" transactionID:@"2"
+                                       purchaseDate:@"2026-02-01T00:00:00Z" expiresDate:@"2026-03-01T00:00:00Z"],
+        // Not a subscription, and in intro period.
+        @{@(kProductIdentifier): @"product.c", @(kTransactionID): @"3", @(kOriginalTransactionID): @"3",
+          @(kPurchaseDate): @"2026-02-15T00:00:00Z", @(kIsInIntroOfferPeriod): @1},
+        // Without a product identifier.
+        @{@(kTransactionID): @"4", @(kOriginalTransactionID): @"4", @(kPurchaseDate): @"2026-03-01T00:00:00Z"},
+        [AppStoreParsedReceiptDataTest subscription:@"product.a" transactionID:@"5"
+                                       purchaseDate:@"2026-03-01T00:00:00Z" expiresDate:@"2026-04-01T00:00:00Z"],
+    ]];
+
+    AppStoreParsedReceiptData *all = [AppStoreParsedReceiptData parseReceiptData:receiptData];
+    XCTAssertNotNil(all);
+    XCTAssertEqualObjects(all.bundleIdentifier, @"ca.psiphon.Psiphon");
+    XCTAssertEqualObjects(all.originalApplicationVersion, @"1.0");
+    XCTAssertEqual(all.inAppPurchases.count, 5);
+    XCTAssertEqualObjects(all.inAppPurchases[0].productIdentifier, @"product.a");
+    XCTAssertEqualObjects(all.inAppPurchases[0].expiresDate, [NSDate fromRFC3339String:@"2026-02-01T00:00:00Z"]);
+    XCTAssertNil(all.inAppPurchases[2].expiresDate);
+    XCTAssertTrue(all.inAppPurchases[2].isInIntroPeriod);
+    XCTAssertNil(all.inAppPurchases[3].productIdentifier);
+
+    // The filter is called in receipt order with the fields it is passed,
+    // except for the in-app purchase receipt without a product identifier.
+    NSMutableArray<NSArray *> *calls = [NSMutableArray array];
+    NSMutableArray<NSString *> *productIdentifiers = [NSMutableArray array];
+
+    AppStoreParsedReceiptData *filtered = [AppStoreParsedReceiptData parseReceiptData:receiptData
+                                                                            iapFilter:^BOOL(NSString *productIdentifier,
+                                                                                            NSDate *expiresDate,
+                                                                                            BOOL isInIntroPeriod) {
+        [calls addObject:@[productIdentifier, expiresDate ?: [NSNull null], @(isInIntroPeriod)]];
+        [productIdentifiers addObject:productIdentifier];
+        return [productIdentifier isEqualToString:@"product.a"];
+    }];
+
+    XCTAssertEqualObjects(calls, (@[
+        @[@"product.a", [NSDate fromRFC3339String:@"2026-02-01T00:00:00Z"], @NO],
+        @[@"product.b", [NSDate fromRFC3339String:@"2026-03-01T00:00:00Z"], @NO],
+        @[@"product.c", [NSNull null], @YES],
+        @[@"product.a", [NSDate fromRFC3339String:@"2026-04-01T00:00:00Z"], @NO],
+    ]));
+
+    // Product identifiers read for the filter are shared between in-app purchase receipts.
+    XCTAssertEqual(productIdentifiers[0], productIdentifiers[3]);
+
+    // In-app purchase receipts without a product identifier are always included.
+    XCTAssertNotNil(filtered);
+    XCTAssertEqualObjects(filtered.bundleIdentifier, all.bundleIdentifier);
+    XCTAssertEqualObjects(filtered.originalApplicationVersion, all.originalApplicationVersion);
+    XCTAssertEqual(filtered.inAppPurchases.count, 3);
+    XCTAssertTrue([filtered.inAppPurchases[0] isEqualToIAP:all.inAppPurchases[0]]);
+    XCTAssertTrue([filtered.inAppPurchases[1] isEqualToIAP:all.inAppPurchases[3]]);
+    XCTAssertTrue([filtered.inAppPurchases[2] isEqualToIAP:all.inAppPurchases[4]]);
+
+    // Same as no filter if every in-app purchase receipt is accepted.
+    AppStoreParsedReceiptData *accepted = [AppStoreParsedReceiptData parseReceiptData:receiptData
+                                                                            iapFilter:^BOOL(NSString *productIdentifier,
+                                                                                            NSDate *expiresDate,
+                                                                                            BOOL isInIntroPeriod) {
+        return TRUE;
+    }];
+    XCTAssertTrue([AppStoreParsedReceiptDataTest iaps:accepted.inAppPurchases equal:all.inAppPurchases]);
+
+    AppStoreParsedReceiptData *rejected = [AppStoreParsedReceiptData parseReceiptData:receiptData
+                                                                            iapFilter:^BOOL(NSString *productIdentifier,
+                                                                                            NSDate *expiresDate,
+                                                                                            BOOL isInIntroPeriod) {
+        return FALSE;
+    }];
+    XCTAssertEqual(rejected.inAppPurchases.count, 1);
+    XCTAssertTrue([rejected.inAppPurchases[0] isEqualToIAP:all.inAppPurchases[3]]);
+}
+
+- (void)testCacheReadsBackWrittenReceipt {
+    NSData *receiptData = [AppStoreParsedReceiptDataTest receiptWithIAPs:[AppStoreParsedReceiptDataTest history]];
+    AppStoreParsedReceiptData *receipt = [AppStoreParsedReceiptData parseReceiptData:receiptData];
+    XCTAssertNotNil(receipt);
+
+    NSData *key = [AppStoreParsedReceiptData cacheKeyForReceiptData:receiptData];
+    [AppStoreParsedReceiptData writeReceipt:receipt toCache:self.cachePath key:key];
+
+    AppStoreParsedReceiptData *cached = [AppStoreParsedReceiptData receiptFromCache:self.cachePath key:key iapFilter:nil];
+    XCTAssertNotNil(cached);
+    XCTAssertEqualObjects(cached.bundleIdentifier, receipt.bundleIdentifier);
+    XCTAssertEqualObjects(cached.originalApplicationVersion, receipt.originalApplicationVersion);
+    XCTAssertTrue([AppStoreParsedReceiptDataTest iaps:cached.inAppPurchases equal:receipt.inAppPurchases]);
+
+    // Fields missing from the receipt are still missing.
+    XCTAssertNil(cached.inAppPurchases[2].expiresDate);
+    XCTAssertNil(cached.inAppPurchases[2].webOrderLineItemID);
+    XCTAssertNil(cached.inAppPurchases[3].productIdentifier);
+    XCTAssertEqualObjects(cached.inAppPurchases[1].cancellationDate,
+                          [NSDate fromRFC3339String:@"2026-02-10T00:00:00Z"]);
+}
+
+- (void)testCacheHitMatchesParseWithTimeDependentFilter {
+    NSData *receiptData = [AppStoreParsedReceiptDataTest receiptWithIAPs:[AppStoreParsedReceiptDataTest history]];
+
+    __block NSDate *now = [NSDate fromRFC3339String:@"2026-01-15T00:00:00Z"];
+    AppStoreParsedIAPFilter unexpired = ^BOOL(NSString *productIdentifier, NSDate *expiresDate, BOOL isInIntroPeriod) {
+        return expiresDate == nil || [now compare:expiresDate] == NSOrderedAscending;
+    };
+
+    // Miss, which writes the cache.
+    AppStoreParsedReceiptData *miss = [AppStoreParsedReceiptData parseReceiptData:receiptData
+                                                                       cachePath:self.cachePath
+                                                                       iapFilter:unexpired];
+    XCTAssertTrue([AppStoreParsedReceiptDataTest iaps:miss.inAppPurchases
+                                                equal:[AppStoreParsedReceiptData parseReceiptData:receiptData
+                                                                                        iapFilter:unexpired].inAppPurchases]);
+    NSData *key = [AppStoreParsedReceiptData cacheKeyForReceiptData:receiptData];
+    XCTAssertNotNil([AppStoreParsedReceiptData receiptFromCache:self.cachePath key:key iapFilter:nil]);
+
+    // Hit at a later time, when fewer subscriptions are unexpired.
+    now = [NSDate fromRFC3339String:@"2026-02-15T00:00:00Z"];
+    AppStoreParsedReceiptData *expected = [AppStoreParsedReceiptData parseReceiptData:receiptData iapFilter:unexpired];
+    AppStoreParsedReceiptData *hit = [AppStoreParsedReceiptData parseReceiptData:receiptData
+                                                                      cachePath:self.cachePath
+                                                                      iapFilter:unexpired];
+    XCTAssertNotNil(hit);
+    XCTAssertEqualObjects(hit.bundleIdentifier, expected.bundleIdentifier);
+    XCTAssertEqualObjects(hit.originalApplicationVersion, expected.originalApplicationVersion);
+    XCTAssertTrue(expected.inAppPurchases.count < miss.inAppPurchases.count);
+    XCTAssertTrue([AppStoreParsedReceiptDataTest iaps:hit.inAppPurchases equal:expected.inAppPurchases]);
+}
+
+- (void)testCacheMissesOtherKey {
+    NSData *receiptData = [AppStoreParsedReceiptDataTest receiptWithIAPs:[AppStoreParsedReceiptDataTest history]];
+    NSData *key = [AppStoreParsedReceiptData cacheKeyForReceiptData:receiptData];
+    [AppStoreParsedReceiptData writeReceipt:[AppStoreParsedReceiptData parseReceiptData:receiptData]
+                                    toCache:self.cachePath
+                                        key:key];
+    XCTAssertNotNil([AppStoreParsedReceiptData receiptFromCache:self.cachePath key:key iapFilter:nil]);
+
+    // Key is magic, version, then SHA-256 of the receipt.
+    NSMutableData *otherVersion = [key mutableCopy];
+    ((uint8_t *)otherVersion.mutableBytes)[4] ^= 1;
+    XCTAssertNil([AppStoreParsedReceiptData receiptFromCache:self.cachePath key:otherVersion iapFilter:nil]);
+
+    NSMutableData *otherDigest = [key mutableCopy];
+    ((uint8_t *)otherDigest.mutableBytes)[otherDigest.length - 1] ^= 1;
+    XCTAssertNil([AppStoreParsedReceiptData receiptFromCache:self.cachePath key:otherDigest iapFilter:nil]);
+
+    // A different receipt has a different key.
+    NSData *otherReceiptData = [AppStoreParsedReceiptDataTest receiptWithIAPs:
+                                [[AppStoreParsedReceiptDataTest history] subarrayWithRange:NSMakeRange(0, 2)]];
+    NSData *otherKey = [AppStoreParsedReceiptData cacheKeyForReceiptData:otherReceiptData];
+    XCTAssertFalse([otherKey isEqualToData:key]);
+    XCTAssertNil([AppStoreParsedReceiptData receiptFromCache:self.cachePath key:otherKey iapFilter:nil]);
+
+    // And is decoded on a miss.
+    AppStoreParsedReceiptData *other = [AppStoreParsedReceiptData parseReceiptData:otherReceiptData
+                                                                        cachePath:self.cachePath
+                                                                        iapFilter:^BOOL(NSString *productIdentifier,
+                                                                                        NSDate *expiresDate,
+                                                                                        BOOL isInIntroPeriod) {
+        return TRUE;
+    }];
+    XCTAssertEqual(other.inAppPurchases.count, 2);
+}
+
+- (void)testMalformedCacheFallsBackToDecoding {
+    // The only in-app purchase receipt has no product identifier and no expiration date, so that the record length
+    // is at a known offset.
+    NSData *receiptData = [AppStoreParsedReceiptDataTest receiptWithIAPs:@[
+        @{@(kTransactionID): @"1", @(kOriginalTransactionID): @"1", @(kPurchaseDate): @"2026-01-01T00:00:00Z"},
+    ]];
+    AppStoreParsedReceiptData *receipt = [AppStoreParsedReceiptData parseReceiptData:receiptData];
+    NSData *key = [AppStoreParsedReceiptData cacheKeyForReceiptData:receiptData];
+    [AppStoreParsedReceiptData writeReceipt:receipt toCache:self.cachePath key:key];
+    NSData *cache = [NSData dataWithContentsOfFile:self.cachePath];
+    XCTAssertNotNil([AppStoreParsedReceiptData receiptFromCache:self.cachePath key:key iapFilter:nil]);
+
+    AppStoreParsedIAPFilter acceptAll = ^BOOL(NSString *productIdentifier, NSDate *expiresDate, BOOL isInIntroPeriod) {
+        return TRUE;
+    };
+
+    // Key, bundle identifier and original application version strings, in-app purchase receipt count,
+    // nil product identifier, missing expiration date, is in intro period, then the record length.
+    const size_t lengthOffset = key.length + (4 + strlen("ca.psiphon.Psiphon")) + (4 + strlen("1.0")) + 4 + 4 + 1 + 1;
+    uint32_t recordLength;
+    [cache getBytes:&recordLength range:NSMakeRange(lengthOffset, sizeof(recordLength))];
+    XCTAssertEqual(lengthOffset + sizeof(recordLength) + recordLength, cache.length);
+
+    NSMutableArray<NSData *> *malformed = [NSMutableArray array];
+    // Truncated in the header, and in the record.
+    [malformed addObject:[cache subdataWithRange:NSMakeRange(0, key.length + 2)]];
+    [malformed addObject:[cache subdataWithRange:NSMakeRange(0, cache.length - 1)]];
+    // Record length running past the end.
+    NSMutableData *pastEnd = [cache mutableCopy];
+    uint32_t longLength = recordLength + 1;
+    [pastEnd replaceBytesInRange:NSMakeRange(lengthOffset, sizeof(longLength)) withBytes:&longLength];
+    [malformed addObject:pastEnd];
+    // Record length ending before the record.
+    NSMutableData *beforeEnd = [cache mutableCopy];
+    uint32_t shortLength = recordLength - 1;
+    [beforeEnd replaceBytesInRange:NSMakeRange(lengthOffset, sizeof(shortLength)) withBytes:&shortLength];
+    [malformed addObject:beforeEnd];
+
+    for (NSData *contents in malformed) {
+        [contents writeToFile:self.cachePath atomically:YES];
+        XCTAssertNil([AppStoreParsedReceiptData receiptFromCache:self.cachePath key:key iapFilter:nil]);
+
+        AppStoreParsedReceiptData *decoded = [AppStoreParsedReceiptData parseReceiptData:receiptData
+                                                                              cachePath:self.cachePath
+                                                                              iapFilter:acceptAll];
+        XCTAssertNotNil(decoded);
+        XCTAssertEqualObjects(decoded.bundleIdentifier, receipt.bundleIdentifier);
+        XCTAssertTrue([AppStoreParsedReceiptDataTest iaps:decoded.inAppPurchases equal:receipt.inAppPurchases]);
+
+        // The cache is rewritten.
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:self.cachePath], cache);
+    }
+}
+
+- (void)testDiffAppended {
+    NSArray *history = [AppStoreParsedReceiptDataTest history];
+    AppStoreParsedReceiptData *previous = [AppStoreParsedReceiptData parseReceiptData:
+                                           [AppStoreParsedReceiptDataTest receiptWithIAPs:
+                                            [history subarrayWithRange:NSMakeRange(0, 3)]]];
+    AppStoreParsedReceiptData *current = [AppStoreParsedReceiptData parseReceiptData:
+                                          [AppStoreParsedReceiptDataTest receiptWithIAPs:history]];
+
+    AppStoreParsedReceiptDiff *diff = [current diffFromReceipt:previous];
+    XCTAssertEqual(diff.receipt, current);
+    XCTAssertTrue([AppStoreParsedReceiptDataTest iaps:diff.addedInAppPurchases
+                                                equal:[current.inAppPurchases subarrayWithRange:NSMakeRange(3, 2)]]);
+    XCTAssertEqual(diff.removedInAppPurchases.count, 0);
+    XCTAssertEqual(diff.changedInAppPurchases.count, 0);
+    XCTAssertFalse(diff.isEmpty);
+
+    XCTAssertTrue([current diffFromReceipt:current].isEmpty);
+}
+
+- (void)testDiffNilPrevious {
+    NSData *receiptData = [AppStoreParsedReceiptDataTest receiptWithIAPs:[AppStoreParsedReceiptDataTest history]];
+    AppStoreParsedReceiptData *receipt = [AppStoreParsedReceiptData parseReceiptData:receiptData];
+
+    AppStoreParsedReceiptDiff *diff = [receipt diffFromReceipt:nil];
+    XCTAssertTrue([AppStoreParsedReceiptDataTest iaps:diff.addedInAppPurchases equal:receipt.inAppPurchases]);
+    XCTAssertEqual(diff.removedInAppPurchases.count, 0);
+    XCTAssertEqual(diff.changedInAppPurchases.count, 0);
+
+    diff = [AppStoreParsedReceiptData diffReceiptData:receiptData fromReceipt:nil cachePath:self.cachePath];
+    XCTAssertTrue([AppStoreParsedReceiptDataTest iaps:diff.addedInAppPurchases equal:receipt.inAppPurchases]);
+
+    // Reading the unchanged receipt again, from the cache, gives an empty diff.
+    AppStoreParsedReceiptDiff *again = [AppStoreParsedReceiptData diffReceiptData:receiptData
+                                                                      fromReceipt:diff.receipt
+                                                                        cachePath:self.cachePath];
+    XCTAssertNotNil(again);
+    XCTAssertTrue(again.isEmpty);
+    XCTAssertTrue([AppStoreParsedReceiptDataTest iaps:again.receipt.inAppPurchases equal:receipt.inAppPurchases]);
+
+    XCTAssertNil([AppStoreParsedReceiptData diffReceiptData:[NSData data] fromReceipt:nil cachePath:nil]);
+}
+
+- (void)testDiffCancelled {
+    NSArray *history = [AppStoreParsedReceiptDataTest history];
+    NSArray *renewals = @[
+        [AppStoreParsedReceiptDataTest subscription:@"product.a" transactionID:@"1"
+                                       purchaseDate:@"2026-01-01T00:00:00Z" expiresDate:@"2026-02-01T00:00:00Z"],
+        [AppStoreParsedReceiptDataTest subscription:@"product.a" transactionID:@"2"
+                                       purchaseDate:@"2026-02-01T00:00:00Z" expiresDate:@"2026-03-01T00:00:00Z"],
+    ];
+    AppStoreParsedReceiptData *previous = [AppStoreParsedReceiptData parseReceiptData:
+                                           [AppStoreParsedReceiptDataTest receiptWithIAPs:renewals]];
+    // The second renewal is cancelled in `history`.
+    AppStoreParsedReceiptData *current = [AppStoreParsedReceiptData parseReceiptData:
+                                          [AppStoreParsedReceiptDataTest receiptWithIAPs:
+                                           [history subarrayWithRange:NSMakeRange(0, 2)]]];
+
+    AppStoreParsedReceiptDiff *diff = [current diffFromReceipt:previous];
+    XCTAssertEqual(diff.addedInAppPurchases.count, 0);
+    XCTAssertEqual(diff.removedInAppPurchases.count, 0);
+    XCTAssertEqual(diff.changedInAppPurchases.count, 1);
+    XCTAssertTrue([diff.changedInAppPurchases[0] isEqualToIAP:current.inAppPurchases[1]]);
+    XCTAssertNotNil(diff.changedInAppPurchases[0].cancellationDate);
+}
+
+- (void)testDiffRemoved {
+    NSArray *history = [AppStoreParsedReceiptDataTest history];
+    AppStoreParsedReceiptData *previous = [AppStoreParsedReceiptData parseReceiptData:
+                                           [AppStoreParsedReceiptDataTest receiptWithIAPs:history]];
+    AppStoreParsedReceiptData *current = [AppStoreParsedReceiptData parseReceiptData:
+                                          [AppStoreParsedReceiptDataTest receiptWithIAPs:
+                                           @[history[0], history[2], history[3], history[4]]]];
+
+    AppStoreParsedReceiptDiff *diff = [current diffFromReceipt:previous];
+    XCTAssertEqual(diff.addedInAppPurchases.count, 0);
+    XCTAssertEqual(diff.changedInAppPurchases.count, 0);
+    XCTAssertEqual(diff.removedInAppPurchases.count, 1);
+    XCTAssertTrue([diff.removedInAppPurchases[0] isEqualToIAP:previous.inAppPurchases[1]]);
+}
+
+- (void)testDiffDuplicateKeys {
+    // Two in-app purchase receipts with the same transaction ID and web order line item ID, that differ in purchase date.
+    NSDictionary *first = [AppStoreParsedReceiptDataTest subscription:@"product.a" transactionID:@"7"
+                                                         purchaseDate:@"2026-01-01T00:00:00Z"
+                                                          expiresDate:@"2026-02-01T00:00:00Z"];
+    NSDictionary *second = [AppStoreParsedReceiptDataTest subscription:@"product.a" transactionID:@"7"
+                                                          purchaseDate:@"2026-01-02T00:00:00Z"
+                                                           expiresDate:@"2026-02-01T00:00:00Z"];
+    NSMutableDictionary *secondCancelled = [second mutableCopy];
+    secondCancelled[@(kCancellationDate)] = @"2026-01-10T00:00:00Z";
+    NSDictionary *other = [AppStoreParsedReceiptDataTest subscription:@"product.b" transactionID:@"8"
+                                                         purchaseDate:@"2026-01-03T00:00:00Z"
+                                                          expiresDate:@"2026-02-03T00:00:00Z"];
+    NSDictionary *renewal = [AppStoreParsedReceiptDataTest history][0];
+
+    AppStoreParsedReceiptData *previous = [AppStoreParsedReceiptData parseReceiptData:
+                                           [AppStoreParsedReceiptDataTest receiptWithIAPs:@[renewal, first, second]]];
+    AppStoreParsedReceiptData *current = [AppStoreParsedReceiptData parseReceiptData:
+                                          [AppStoreParsedReceiptDataTest receiptWithIAPs:
+                                           @[renewal, other, first, secondCancelled]]];
+
+    // In-app purchase receipts with the same key are paired in order.
+    AppStoreParsedReceiptDiff *diff = [current diffFromReceipt:previous];
+    XCTAssertEqual(diff.addedInAppPurchases.count, 1);
+    XCTAssertTrue([diff.addedInAppPurchases[0] isEqualToIAP:current.inAppPurchases[1]]);
+    XCTAssertEqual(diff.changedInAppPurchases.count, 1);
+    XCTAssertTrue([diff.changedInAppPurchases[0] isEqualToIAP:current.inAppPurchases[3]]);
+    XCTAssertEqual(diff.removedInAppPurchases.count, 0);
+
+    // An unpaired in-app purchase receipt with a duplicate key is removed.
+    AppStoreParsedReceiptData *withoutSecond = [AppStoreParsedReceiptData parseReceiptData:
+                                                [AppStoreParsedReceiptDataTest receiptWithIAPs:@[renewal, other, first]]];
+    diff = [withoutSecond diffFromReceipt:previous];
+    XCTAssertEqual(diff.addedInAppPurchases.count, 1);
+    XCTAssertEqual(diff.changedInAppPurchases.count, 0);
+    XCTAssertEqual(diff.removedInAppPurchases.count, 1);
+    XCTAssertTrue([diff.removedInAppPurchases[0] isEqualToIAP:previous.inAppPurchases[2]]);
+}
+
+#pragma mark - Helpers
+
+/// Renewals of a monthly subscription, of which the second is cancelled, a consumable in intro period, and an
+/// in-app purchase receipt without a product identifier.
++ (NSArray<NSDictionary<NSNumber*, id>*>*)history {
+    NSMutableDictionary *cancelled = [[AppStoreParsedReceiptDataTest subscription:@"product.a" transactionID:@"2"
+                                                                     purchaseDate:@"2026-02-01T00:00:00Z"
+                                                                      expiresDate:@"2026-03-01T00:00:00Z"] mutableCopy];
+    cancelled[@(kCancellationDate)] = @"2026-02-10T00:00:00Z";
+    return @[
+        [AppStoreParsedReceiptDataTest subscription:@"product.a" transactionID:@"1"
+                                       purchaseDate:@"2026-01-01T00:00:00Z" expiresDate:@"2026-02-01T00:00:00Z"],
+        cancelled,
+        @{@(kProductIdentifier): @"product.c", @(kTransactionID): @"3", @(kOriginalTransactionID): @"3",
+          @(kPurchaseDate): @"2026-02-15T00:00:00Z", @(kIsInIntroOfferPeriod): @1},
+        @{@(kTransactionID): @"4", @(kOriginalTransactionID): @"4", @(kPurchaseDate): @"2026-03-01T00:00:00Z"},
+        [AppStoreParsedReceiptDataTest subscription:@"product.a" transactionID:@"5"
+                                       purchaseDate:@"2026-03-01T00:00:00Z" expiresDate:@"2026-04-01T00:00:00Z"],
+    ];
+}
+
+/// Fields of a monthly subscription renewal, as in `receiptWithIAPs:`.
++ (NSDictionary<NSNumber*, id>*)subscription:(NSString*)productIdentifier
+                               transactionID:(NSString*)transactionID
+                                purchaseDate:(NSString*)purchaseDate
+                                 expiresDate:(NSString*)expiresDate {
+    return @{
+        @(kProductIdentifier): productIdentifier,
+        @(kTransactionID): transactionID,
+        @(kOriginalTransactionID): @"1",
+        @(kPurchaseDate): purchaseDate,
+        @(kSubscriptionExpirationDate): expiresDate,
+        @(kWebOrderLineItemID): @(1000 + transactionID.longLongValue),
+        @(kIsInIntroOfferPeriod): @0,
+    };
+}
+
+/// PKCS#7 SignedData of a receipt of the Psiphon app with the given in-app purchase receipts.
+/// Each in-app purchase receipt maps attribute types to values: strings are encoded as IA5String for dates and
+/// UTF8String otherwise, numbers as INTEGER, and data is used as the attribute value as is.
++ (NSData*)receiptWithIAPs:(NSArray<NSDictionary<NSNumber*, id>*>*)iaps {
+    NSMutableArray<NSData*> *attributes = [NSMutableArray array];
+
+    [attributes addObject:[AppStoreParsedReceiptDataTest attributeWithType:kBundleIdentifier value:@"ca.psiphon.Psiphon"]];
+    [attributes addObject:[AppStoreParsedReceiptDataTest attributeWithType:kOriginalApplicationVersion value:@"1.0"]];
+
+    for (NSDictionary<NSNumber*, id> *iap in iaps) {
+        NSMutableArray<NSData*> *fields = [NSMutableArray array];
+        // Sorted so that the same fields are always encoded the same.
+        for (NSNumber *type in [iap.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+            [fields addObject:[AppStoreParsedReceiptDataTest attributeWithType:type.longValue value:iap[type]]];
+        }
+        [attributes addObject:[AppStoreReceiptHelpersTest attributeWithType:kInAppPurchaseReceipt version:1
+                                                                      value:[AppStoreReceiptHelpersTest setOf:fields]]];
+    }
+
+    NSData *payload = [AppStoreReceiptHelpersTest setOf:attributes];
+    return [AppStoreReceiptHelpersTest signedDataWithContent:[AppStoreReceiptHelpersTest tag:DER_TAG_OCTET_STRING data:payload]
+                                                  indefinite:FALSE];
+}
+
++ (NSData*)attributeWithType:(long)type value:(id)value {
+    NSData *encoded;
+    if ([value isKindOfClass:[NSData class]]) {
+        encoded = value;
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        encoded = [AppStoreReceiptHelpersTest integer:[value longValue]];
+    } else if (type == kPurchaseDate || type == kSubscriptionExpirationDate || type == kCancellationDate) {
+        encoded = [AppStoreReceiptHelpersTest tag:DER_TAG_IA5_STRING string:value];
+    } else {
+        encoded = [AppStoreReceiptHelpersTest tag:DER_TAG_UTF8_STRING string:value];
+    }
+    return [AppStoreReceiptHelpersTest attributeWithType:type version:1 value:encoded];
+}
+
++ (BOOL)iaps:(NSArray<AppStoreParsedIAP*>*)a equal:(NSArray<AppStoreParsedIAP*>*)b {
+    if (a.count != b.count) {
+        return FALSE;
+    }
+    for (NSUInteger i = 0; i < a.count; i++) {
+        if (![a[i] isEqualToIAP:b[i]]) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+@end
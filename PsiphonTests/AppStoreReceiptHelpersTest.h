@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <XCTest/XCTest.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AppStoreReceiptHelpersTest : XCTestCase
+
+/// DER encoded TLV with definite length.
++ (NSData*)tag:(uint8_t)tag data:(NSData*)value;
+
+/// BER encoded TLV with indefinite length.
++ (NSData*)indefinite:(uint8_t)tag data:(NSData*)value;
+
+/// PKCS#7 SignedData with the given encoded content OCTET STRING, and placeholder certificates and signer infos.
++ (NSData*)signedDataWithContent:(NSData*)octetString indefinite:(BOOL)indefinite;
+
++ (NSData*)tag:(uint8_t)tag string:(NSString*)string;
+
++ (NSData*)integer:(long)value;
+
+/// Receipt attribute SEQUENCE of `type`, `version` and the OCTET STRING `value`.
++ (NSData*)attributeWithType:(long)type version:(long)version value:(NSData*)value;
+
++ (NSData*)setOf:(NSArray<NSData*>*)elements;
+
+@end
+
+NS_ASSUME_NONNULL_END
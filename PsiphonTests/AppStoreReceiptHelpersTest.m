@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#import <XCTest/XCTest.h>
+#import "AppStoreReceiptHelpers.h"
+#import "AppStoreReceiptHelpersTest.h"
+
+@implementation AppStoreReceiptHelpersTest
+
+- (void)testReceiptAttributeIterator {
+    NSData *iap = [AppStoreReceiptHelpersTest setOf:@[
+        [AppStoreReceiptHelpersTest attributeWithType:1702 version:1
+                                                value:[AppStoreReceiptHelpersTest tag:DER_TAG_UTF8_STRING string:@"product"]],
+        [AppStoreReceiptHelpersTest attributeWithType:1711 version:1
+                                                value:[AppStoreReceiptHelpersTest integer:1000000000000]],
+    ]];
+    NSData *receipt = [AppStoreReceiptHelpersTest setOf:@[
+        [AppStoreReceiptHelpersTest attributeWithType:2 version:1
+                                                value:[AppStoreReceiptHelpersTest tag:DER_TAG_UTF8_STRING string:@"ca.psiphon.Psiphon"]],
+        [AppStoreReceiptHelpersTest attributeWithType:17 version:1 value:iap],
+        [AppStoreReceiptHelpersTest attributeWithType:-1 version:0 value:[NSData data]],
+    ]];
+
+    XCTAssertEqual(receipt_attributes_validate(receipt.bytes, receipt.length), 3);
+
+    receipt_attribute_iterator it;
+    receipt_attribute attr;
+    XCTAssertEqual(receipt_attribute_iterator_init(&it, receipt.bytes, receipt.length), 0);
+
+    XCTAssertEqual(receipt_attribute_iterator_next(&it, &attr), 1);
+    XCTAssertEqual(attr.type, 2);
+    XCTAssertEqual(attr.version, 1);
+
+    XCTAssertEqual(receipt_attribute_iterator_next(&it, &attr), 1);
+    XCTAssertEqual(attr.type, 17);
+    XCTAssertEqualObjects([NSData dataWithBytes:attr.value length:attr.value_len], iap);
+
+    // Values point into the receipt.
+    XCTAssertTrue(attr.value > (const uint8_t *)receipt.bytes &&
+                  attr.value + attr.value_len <= (const uint8_t *)receipt.bytes + receipt.length);
+
+    receipt_attribute_iterator iap_it;
+    receipt_attribute iap_attr;
+    XCTAssertEqual(receipt_attribute_iterator_init(&iap_it, attr.value, attr.value_len), 0);
+    XCTAssertEqual(receipt_attribute_iterator_next(&iap_it, &iap_attr), 1);
+    XCTAssertEqual(iap_attr.type, 1702);
+    XCTAssertEqual(receipt_attribute_iterator_next(&iap_it, &iap_attr), 1);
+    XCTAssertEqual(iap_attr.type, 1711);
+    XCTAssertEqual(receipt_attribute_iterator_next(&iap_it, &iap_attr), 0);
+
+    XCTAssertEqual(receipt_attribute_iterator_next(&it, &attr), 1);
+    XCTAssertEqual(attr.type, -1);
+    XCTAssertEqual(attr.value_len, 0);
+
+    XCTAssertEqual(receipt_attribute_iterator_next(&it, &attr), 0);
+}
+
+- (void)testReceiptAttributeIteratorMalformed {
+    NSData *receipt = [AppStoreReceiptHelpersTest setOf:@[
+        [AppStoreReceiptHelpersTest attributeWithType:2 version:1
+                                                value:[AppStoreReceiptHelpersTest tag:DER_TAG_UTF8_STRING string:@"ca.psiphon.Psiphon"]],
+    ]];
+
+    // Every truncation is rejected.
+    for (NSUInteger len = 0; len < receipt.length; len++) {
+        XCTAssertEqual(receipt_attributes_validate(receipt.bytes, len), -1);
+    }
+
+    // Trailing bytes after the SET are ignored.
+    NSMutableData *trailing = [NSMutableData dataWithData:receipt];
+    [trailing appendBytes:"\x00\x00" length:2];
+    XCTAssertEqual(receipt_attributes_validate(trailing.bytes, trailing.length), 1);
+
+    // Not a SET.
+    NSData *sequence = [AppStoreReceiptHelpersTest tag:DER_TAG_SEQUENCE data:[NSData data]];
+    XCTAssertEqual(receipt_attributes_validate(sequence.bytes, sequence.length), -1);
+
+    // Indefinite length.
+    const uint8_t indefinite[] = {DER_TAG_SET, 0x80, 0x00, 0x00};
+    XCTAssertEqual(receipt_attributes_validate(indefinite, sizeof(indefinite)), -1);
+
+    // Attribute with an extra element.
+    NSMutableData *extra = [NSMutableData dataWithData:[AppStoreReceiptHelpersTest integer:1]];
+    [extra appendData:[AppStoreReceiptHelpersTest integer:1]];
+    [extra appendData:[AppStoreReceiptHelpersTest tag:DER_TAG_OCTET_STRING data:[NSData data]]];
+    [extra appendData:[AppStoreReceiptHelpersTest integer:1]];
+    NSData *extraSet = [AppStoreReceiptHelpersTest setOf:@[[AppStoreReceiptHelpersTest tag:DER_TAG_SEQUENCE data:extra]]];
+    XCTAssertEqual(receipt_attributes_validate(extraSet.bytes, extraSet.length), -1);
+}
+
+- (void)testDerIntegerValue {
+    long value;
+
+    const uint8_t zero[] = {0x00};
+    XCTAssertEqual(der_integer_value(zero, sizeof(zero), &value), 0);
+    XCTAssertEqual(value, 0);
+
+    XCTAssertEqual(der_integer_value(NULL, 0, &value), 0);
+    XCTAssertEqual(value, 0);
+
+    const uint8_t negative[] = {0xFF, 0x7F};
+    XCTAssertEqual(der_integer_value(negative, sizeof(negative), &value), 0);
+    XCTAssertEqual(value, -129);
+
+    // Leading sign extension octets are insignificant.
+    const uint8_t padded[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80};
+    XCTAssertEqual(der_integer_value(padded, sizeof(padded), &value), 0);
+    XCTAssertEqual(value, 128);
+
+    // Web order line item IDs are 16 digits, which fit a long on the 64-bit targets the app supports.
+    const uint8_t webOrderLineItemID[] = {0x03, 0x8D, 0x7E, 0xA4, 0xC6, 0x80, 0x00};
+    XCTAssertEqual(der_integer_value(webOrderLineItemID, sizeof(webOrderLineItemID), &value), 0);
+    XCTAssertEqual(value, 1000000000000000L);
+
+    const uint8_t tooLarge[] = {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    XCTAssertEqual(der_integer_value(tooLarge, sizeof(tooLarge), &value), -1);
+}
+
+- (void)testReceiptPKCS7Content {
+    NSData *payload = [AppStoreReceiptHelpersTest setOf:@[
+        [AppStoreReceiptHelpersTest attributeWithType:2 version:1
+                                                value:[AppStoreReceiptHelpersTest tag:DER_TAG_UTF8_STRING string:@"ca.psiphon.Psiphon"]],
+    ]];
+    const uint8_t *content;
+    size_t contentLength;
+
+    // DER.
+    NSData *der = [AppStoreReceiptHelpersTest signedDataWithContent:[AppStoreReceiptHelpersTest tag:DER_TAG_OCTET_STRING data:payload]
+                                                         indefinite:FALSE];
+    XCTAssertEqual(receipt_pkcs7_content(der.bytes, der.length, &content, &contentLength), RECEIPT_CONTENT_OK);
+    XCTAssertEqualObjects([NSData dataWithBytes:content length:contentLength], payload);
+    XCTAssertTrue(content > (const uint8_t *)der.bytes && content + contentLength <= (const uint8_t *)der.bytes + der.length);
+
+    // Indefinite lengths with the content in a single segment, as App Store receipts are encoded.
+    NSData *segment = [AppStoreReceiptHelpersTest tag:DER_TAG_OCTET_STRING data:payload];
+    NSData *ber = [AppStoreReceiptHelpersTest signedDataWithContent:[AppStoreReceiptHelpersTest indefinite:DER_TAG_OCTET_STRING | DER_CONSTRUCTED
+                                                                                                     data:segment]
+                                                         indefinite:TRUE];
+    XCTAssertEqual(receipt_pkcs7_content(ber.bytes, ber.length, &content, &contentLength), RECEIPT_CONTENT_OK);
+    XCTAssertEqualObjects([NSData dataWithBytes:content length:contentLength], payload);
+
+    // Definite length constructed OCTET STRING with a single segment.
+    NSData *constructed = [AppStoreReceiptHelpersTest signedDataWithContent:[AppStoreReceiptHelpersTest tag:DER_TAG_OCTET_STRING | DER_CONSTRUCTED
+                                                                                                       data:segment]
+                                                                 indefinite:FALSE];
+    XCTAssertEqual(receipt_pkcs7_content(constructed.bytes, constructed.length, &content, &contentLength), RECEIPT_CONTENT_OK);
+    XCTAssertEqualObjects([NSData dataWithBytes:content length:contentLength], payload);
+
+    // More than one segment is left to the full decode.
+    NSMutableData *segments = [NSMutableData data];
+    [segments appendData:[AppStoreReceiptHelpersTest tag:DER_TAG_OCTET_STRING data:[payload subdataWithRange:NSMakeRange(0, 4)]]];
+    [segments appendData:[AppStoreReceiptHelpersTest tag:DER_TAG_OCTET_STRING
+                                                    data:[payload subdataWithRange:NSMakeRange(4, payload.length - 4)]]];
+    NSData *segmented = [AppStoreReceiptHelpersTest signedDataWithContent:[AppStoreReceiptHelpersTest indefinite:DER_TAG_OCTET_STRING | DER_CONSTRUCTED
+                                                                                                           data:segments]
+                                                               indefinite:TRUE];
+    XCTAssertEqual(receipt_pkcs7_content(segmented.bytes, segmented.length, &content, &contentLength), RECEIPT_CONTENT_SEGMENTED);
+
+    // Every truncation of the definite length encoding is rejected.
+    for (NSUInteger len = 0; len < der.length; len++) {
+        XCTAssertEqual(receipt_pkcs7_content(der.bytes, len, &content, &contentLength), RECEIPT_CONTENT_ERROR);
+    }
+
+    // The certificates and signer infos are not read, so with indefinite
+    // lengths only truncations before the end of the content are rejected.
+    XCTAssertEqual(receipt_pkcs7_content(ber.bytes, ber.length, &content, &contentLength), RECEIPT_CONTENT_OK);
+    const NSUInteger contentEnd = (NSUInteger)(content + contentLength - (const uint8_t *)ber.bytes);
+    for (NSUInteger len = 0; len < ber.length; len++) {
+        XCTAssertEqual(receipt_pkcs7_content(ber.bytes, len, &content, &contentLength),
+                       (len < contentEnd + 2) ? RECEIPT_CONTENT_ERROR : RECEIPT_CONTENT_OK);
+    }
+
+    // Not a SignedData.
+    XCTAssertEqual(receipt_pkcs7_content(payload.bytes, payload.length, &content, &contentLength), RECEIPT_CONTENT_ERROR);
+    XCTAssertEqual(receipt_pkcs7_content(NULL, 0, &content, &contentLength), RECEIPT_CONTENT_ERROR);
+}
+
+- (void)testBerSkipTlv {
+    // Nested indefinite lengths.
+    const uint8_t nested[] = {DER_TAG_SET, 0x80, DER_TAG_SEQUENCE, 0x80, DER_TAG_INTEGER, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0xFF};
+    const uint8_t *p = nested;
+    XCTAssertEqual(ber_skip_tlv(&p, nested + sizeof(nested)), 0);
+    XCTAssertEqual(p, nested + sizeof(nested) - 1);
+
+    // Missing end-of-contents octets.
+    p = nested;
+    XCTAssertEqual(ber_skip_tlv(&p, nested + 8), -1);
+    XCTAssertEqual(p, nested);
+
+    // Primitive TLVs cannot have the indefinite length.
+    const uint8_t primitive[] = {DER_TAG_OCTET_STRING, 0x80, 0x00, 0x00};
+    p = primitive;
+    XCTAssertEqual(ber_skip_tlv(&p, primitive + sizeof(primitive)), -1);
+
+    // Nested too deeply.
+    NSMutableData *deep = [NSMutableData data];
+    for (int i = 0; i < 64; i++) {
+        [deep appendBytes:"\x30\x80" length:2];
+    }
+    for (int i = 0; i < 64; i++) {
+        [deep appendBytes:"\x00\x00" length:2];
+    }
+    p = deep.bytes;
+    XCTAssertEqual(ber_skip_tlv(&p, (const uint8_t *)deep.bytes + deep.length), -1);
+}
+
+#pragma mark - Helpers
+
++ (NSData*)tag:(uint8_t)tag data:(NSData*)value {
+    NSMutableData *data = [NSMutableData dataWithBytes:&tag length:1];
+    NSUInteger len = value.length;
+    if (len < 0x80) {
+        uint8_t b = (uint8_t)len;
+        [data appendBytes:&b length:1];
+    } else {
+        uint8_t octets[sizeof(NSUInteger)];
+        uint8_t n = 0;
+        for (NSUInteger l = len; l > 0; l >>= 8) {
+            octets[sizeof(octets) - 1 - n++] = (uint8_t)l;
+        }
+        uint8_t b = 0x80 | n;
+        [data appendBytes:&b length:1];
+        [data appendBytes:octets + sizeof(octets) - n length:n];
+    }
+    [data appendData:value];
+    return data;
+}
+
++ (NSData*)indefinite:(uint8_t)tag data:(NSData*)value {
+    NSMutableData *data = [NSMutableData dataWithBytes:&tag length:1];
+    [data appendBytes:"\x80" length:1];
+    [data appendData:value];
+    [data appendBytes:"\x00\x00" length:2];
+    return data;
+}
+
++ (NSData*)signedDataWithContent:(NSData*)octetString indefinite:(BOOL)indefinite {
+    NSData *(^wrap)(uint8_t, NSData*) = ^NSData *(uint8_t tag, NSData *value) {
+        return indefinite ? [AppStoreReceiptHelpersTest indefinite:tag data:value] :
+                            [AppStoreReceiptHelpersTest tag:tag data:value];
+    };
+    const uint8_t oidSignedData[] = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02};
+    const uint8_t oidData[] = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x01};
+    const uint8_t oidSHA1[] = {0x2B, 0x0E, 0x03, 0x02, 0x1A};
+
+    NSMutableData *algorithm = [NSMutableData dataWithData:[AppStoreReceiptHelpersTest tag:DER_TAG_OBJECT_IDENTIFIER
+                                                                                      data:[NSData dataWithBytes:oidSHA1 length:sizeof(oidSHA1)]]];
+    [algorithm appendBytes:"\x05\x00" length:2];
+
+    NSMutableData *contentInfo = [NSMutableData dataWithData:[AppStoreReceiptHelpersTest tag:DER_TAG_OBJECT_IDENTIFIER
+                                                                                        data:[NSData dataWithBytes:oidData length:sizeof(oidData)]]];
+    [contentInfo appendData:wrap(DER_TAG_CONTEXT_0, octetString)];
+
+    NSMutableData *signedData = [NSMutableData dataWithData:[AppStoreReceiptHelpersTest integer:1]];
+    [signedData appendData:wrap(DER_TAG_SET, wrap(DER_TAG_SEQUENCE, algorithm))];
+    [signedData appendData:wrap(DER_TAG_SEQUENCE, contentInfo)];
+    // Certificates and signer infos.
+    [signedData appendData:wrap(DER_TAG_CONTEXT_0, [AppStoreReceiptHelpersTest tag:DER_TAG_SEQUENCE data:[NSData data]])];
+    [signedData appendData:wrap(DER_TAG_SET, [NSData data])];
+
+    NSMutableData *contentInfoSignedData = [NSMutableData dataWithData:[AppStoreReceiptHelpersTest tag:DER_TAG_OBJECT_IDENTIFIER
+                                                                                                  data:[NSData dataWithBytes:oidSignedData length:sizeof(oidSignedData)]]];
+    [contentInfoSignedData appendData:wrap(DER_TAG_CONTEXT_0, wrap(DER_TAG_SEQUENCE, signedData))];
+
+    return wrap(DER_TAG_SEQUENCE, contentInfoSignedData);
+}
+
++ (NSData*)tag:(uint8_t)tag string:(NSString*)string {
+    return [AppStoreReceiptHelpersTest tag:tag data:[string dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
++ (NSData*)integer:(long)value {
+    uint8_t octets[sizeof(long)];
+    int n = sizeof(long);
+    for (int i = 0; i < n; i++) {
+        octets[n - 1 - i] = (uint8_t)(value >> (8 * i));
+    }
+    // Minimal encoding.
+    int start = 0;
+    while (start < n - 1 &&
+           ((octets[start] == 0x00 && (octets[start + 1] & 0x80) == 0) ||
+            (octets[start] == 0xFF && (octets[start + 1] & 0x80) != 0))) {
+        start++;
+    }
+    return [AppStoreReceiptHelpersTest tag:DER_TAG_INTEGER
+                                      data:[NSData dataWithBytes:octets + start length:n - start]];
+}
+
++ (NSData*)attributeWithType:(long)type version:(long)version value:(NSData*)value {
+    NSMutableData *data = [NSMutableData data];
+    [data appendData:[AppStoreReceiptHelpersTest integer:type]];
+    [data appendData:[AppStoreReceiptHelpersTest integer:version]];
+    [data appendData:[AppStoreReceiptHelpersTest tag:DER_TAG_OCTET_STRING data:value]];
+    return [AppStoreReceiptHelpersTest tag:DER_TAG_SEQUENCE data:data];
+}
+
++ (NSData*)setOf:(NSArray<NSData*>*)elements {
+    NSMutableData *data = [NSMutableData data];
+    for (NSData *element in elements) {
+        [data appendData:element];
+    }
+    return [AppStoreReceiptHelpersTest tag:DER_TAG_SET data:data];
+}
+
+@end
@@ -19,22 +19,79 @@
 
 #import <XCTest/XCTest.h>
 #import "EmbeddedServerEntries.h"
+#import "EmbeddedServerEntriesHelpers.h"
+
+/// Size of the hex encoded input used by the hex decoding benchmarks.
+#define kHexBenchmarkInputSize (4 * 1024 * 1024)
+
+/// Length of each hex encoded line in the hex decoding benchmarks.
+#define kHexBenchmarkLineLength 4096
+
+/// Reference implementation of `hex_decode` prior to the table driven decoder.
+/// Kept to verify the new decoder and to benchmark against.
+static char * legacy_hex_decode(const char *s) {
+    if (strlen(s) % 2 != 0) {
+        return NULL;
+    }
+
+    unsigned long decoded_len = (strlen(s)/2) + 1;
+    char *decoded = (char*)malloc(sizeof(char) * decoded_len);
+    char *p = decoded;
+
+    for (int i = 0; i < strlen(s); (i+=2)) {
+        char hex[3];
+        memcpy(hex, s + i, sizeof(char) * 2);
+        hex[2] = '\0';
+
+        errno = 0;
+        long val = strtol(hex, NULL, 16);
+        if (val == 0 || errno != 0) {
+            free(decoded);
+            return NULL;
+        }
+        *p = (char)val;
+        p++;
+    }
+
+    decoded[decoded_len-1] = '\0';
+
+    return decoded;
+}
 
 @interface EmbeddedServerEntriesTest : XCTestCase
 
+/// Regions cache used instead of the default cache in the caches directory, removed before and after each test.
+@property (nonatomic, strong) NSString *cachePath;
+
 @end
 
 @implementation EmbeddedServerEntriesTest
 
+- (void)setUp {
+    self.cachePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"embedded_server_entries_regions.cache"];
+    [[NSFileManager defaultManager] removeItemAtPath:self.cachePath error:nil];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath:self.cachePath error:nil];
+}
+
 /// Test decoding server entries embedded in the app target.
 - (void)testEgressRegionsFromFile {
     [self egressRegionsFromFile];
 }
 
 /// Test performance of decoding server entries embedded in the app target.
+/// The regions cache is not used, so that every iteration decodes the file.
 - (void)testPerformanceEgressRegionsFromFile {
     [self measureBlock:^{
-        [self egressRegionsFromFile];
+        NSError *e;
+        NSSet *embeddedEgressRegions =
+            [EmbeddedServerEntries egressRegionsFromFile:[EmbeddedServerEntriesTest embeddedServerEntriesPath]
+                                               cachePath:nil
+                                                   error:&e];
+        XCTAssertNil(e);
+        XCTAssertTrue([embeddedEgressRegions count] > 0);
     }];
 }
 
@@ -59,12 +116,628 @@
     XCTAssertTrue([embeddedEgressRegions count] == 0);
 }
 
+- (void)testEgressRegionsFromBinaryFile {
+    NSError *e;
+    NSSet *expected = [EmbeddedServerEntries egressRegionsFromFile:[EmbeddedServerEntriesTest embeddedServerEntriesPath]
+                                                    maxConcurrency:1
+                                                             error:&e];
+    XCTAssertNil(e);
+
+    NSData *binary = [EmbeddedServerEntriesTest binaryServerEntries];
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"binary_embedded_server_entries"];
+    [[NSFileManager defaultManager] createFileAtPath:filePath contents:binary attributes:nil];
+
+    NSSet *regions = [EmbeddedServerEntries egressRegionsFromFile:filePath maxConcurrency:1 error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqualObjects(expected, regions);
+
+    // Truncated file.
+    [[NSFileManager defaultManager] createFileAtPath:filePath
+                                            contents:[binary subdataWithRange:NSMakeRange(0, [binary length] - 1)]
+                                          attributes:nil];
+    [EmbeddedServerEntries egressRegionsFromFile:filePath maxConcurrency:1 error:&e];
+    XCTAssertNotNil(e);
+    XCTAssertEqual(e.code, EmbeddedServerEntriesErrorDecodingError);
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+- (void)testEgressRegionsCache {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"cached_embedded_server_entries"];
+    NSString *cachePath = self.cachePath;
+    [[NSFileManager defaultManager] createFileAtPath:filePath
+                                            contents:[EmbeddedServerEntriesTest embeddedServerEntriesData]
+                                          attributes:nil];
+
+    NSDictionary *before = [EmbeddedServerEntries cacheStatistics];
+
+    NSError *e;
+    NSSet *miss = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:cachePath error:&e];
+    XCTAssertNil(e);
+    NSSet *hit = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:cachePath error:&e];
+    XCTAssertNil(e);
+
+    NSDictionary *after = [EmbeddedServerEntries cacheStatistics];
+
+    XCTAssertTrue([miss count] > 0);
+    XCTAssertEqualObjects(miss, hit);
+    XCTAssertEqual([after[@"cacheMisses"] integerValue] - [before[@"cacheMisses"] integerValue], 1);
+    XCTAssertEqual([after[@"cacheHits"] integerValue] - [before[@"cacheHits"] integerValue], 1);
+
+    // Rewriting the file invalidates the cache.
+    [[NSFileManager defaultManager] createFileAtPath:filePath contents:[NSData data] attributes:nil];
+    NSSet *empty = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:cachePath error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqual([empty count], 0);
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+- (void)testEgressRegionsFromIndex {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"indexed_embedded_server_entries"];
+    NSString *indexPath = [filePath stringByAppendingString:@".index"];
+    NSData *source = [EmbeddedServerEntriesTest embeddedServerEntriesData];
+    [[NSFileManager defaultManager] removeItemAtPath:indexPath error:nil];
+    [[NSFileManager defaultManager] createFileAtPath:filePath contents:source attributes:nil];
+
+    NSError *e;
+    NSSet *expected = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:nil error:&e];
+    XCTAssertNil(e);
+    XCTAssertTrue([expected count] > 0);
+
+    NSArray *sortedRegions = [[expected allObjects] sortedArrayUsingSelector:@selector(compare:)];
+    [[NSFileManager defaultManager] createFileAtPath:indexPath
+                                            contents:[EmbeddedServerEntriesTest indexForServerEntries:source
+                                                                                              regions:sortedRegions]
+                                          attributes:nil];
+
+    NSDictionary *before = [EmbeddedServerEntries cacheStatistics];
+    NSSet *regions = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:nil error:&e];
+    NSDictionary *after = [EmbeddedServerEntries cacheStatistics];
+    XCTAssertNil(e);
+    XCTAssertEqualObjects(expected, regions);
+    XCTAssertEqual([after[@"indexHits"] integerValue] - [before[@"indexHits"] integerValue], 1);
+
+    // Regions are answered by the index alone, without scanning the server entries.
+    [[NSFileManager defaultManager] createFileAtPath:indexPath
+                                            contents:[EmbeddedServerEntriesTest indexForServerEntries:source
+                                                                                              regions:@[@"XX"]]
+                                          attributes:nil];
+    regions = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:nil error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqualObjects(regions, [NSSet setWithObject:@"XX"]);
+
+    [[NSFileManager defaultManager] removeItemAtPath:indexPath error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+- (void)testEgressRegionsIgnoresStaleIndex {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"stale_embedded_server_entries"];
+    NSString *indexPath = [filePath stringByAppendingString:@".index"];
+
+    // Large enough that a change in the middle is far from either end of the file.
+    NSData *entries = [EmbeddedServerEntriesTest embeddedServerEntriesData];
+    XCTAssertTrue([entries length] > 0);
+    NSMutableData *source = [NSMutableData data];
+    while ([source length] < 1024 * 1024) {
+        [source appendData:entries];
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:indexPath error:nil];
+    [[NSFileManager defaultManager] createFileAtPath:filePath contents:source attributes:nil];
+
+    NSError *e;
+    NSSet *expected = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:nil error:&e];
+    XCTAssertNil(e);
+
+    // Index generated for a file of the same size that only differs in the middle.
+    NSMutableData *changed = [NSMutableData dataWithData:source];
+    ((char *)changed.mutableBytes)[[changed length] / 2] ^= 1;
+    [[NSFileManager defaultManager] createFileAtPath:indexPath
+                                            contents:[EmbeddedServerEntriesTest indexForServerEntries:changed
+                                                                                              regions:@[@"XX"]]
+                                          attributes:nil];
+
+    NSDictionary *before = [EmbeddedServerEntries cacheStatistics];
+    NSSet *regions = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:nil error:&e];
+    NSDictionary *after = [EmbeddedServerEntries cacheStatistics];
+    XCTAssertNil(e);
+    XCTAssertEqualObjects(expected, regions);
+    XCTAssertEqual([after[@"indexHits"] integerValue], [before[@"indexHits"] integerValue]);
+
+    // Index header with an unsupported version.
+    NSMutableData *invalidIndex = [NSMutableData dataWithBytes:"PSEI\x01\0\0\0" length:8];
+    [invalidIndex appendData:[EmbeddedServerEntriesTest randomData]];
+    [[NSFileManager defaultManager] createFileAtPath:indexPath contents:invalidIndex attributes:nil];
+
+    regions = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:nil error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqualObjects(expected, regions);
+
+    [[NSFileManager defaultManager] removeItemAtPath:indexPath error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+- (void)testEgressRegionsConcurrentMatchesSerial {
+    NSData *entries = [EmbeddedServerEntriesTest embeddedServerEntriesData];
+    XCTAssertTrue([entries length] > 0);
+
+    // Repeat the embedded server entries until the file is large enough to be split
+    // into chunks, with an invalid line past the first chunk.
+    NSMutableData *data = [NSMutableData data];
+    while ([data length] < 4 * 1024 * 1024) {
+        [data appendData:entries];
+    }
+    NSUInteger validLength = [data length];
+    [data appendBytes:"zz\n" length:3];
+    while ([data length] < 2 * validLength) {
+        [data appendData:entries];
+    }
+
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"large_embedded_server_entries"];
+
+    for (NSData *contents in @[[data subdataWithRange:NSMakeRange(0, validLength)], data]) {
+        [[NSFileManager defaultManager] createFileAtPath:filePath contents:contents attributes:nil];
+
+        NSError *serialError, *concurrentError;
+        NSSet *serial = [EmbeddedServerEntries egressRegionsFromFile:filePath
+                                                      maxConcurrency:1
+                                                               error:&serialError];
+        NSSet *concurrent = [EmbeddedServerEntries egressRegionsFromFile:filePath
+                                                          maxConcurrency:8
+                                                                   error:&concurrentError];
+
+        XCTAssertTrue([serial count] > 0);
+        XCTAssertEqualObjects(serial, concurrent);
+        XCTAssertEqualObjects(serialError.localizedDescription, concurrentError.localizedDescription);
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+/// Test performance of decoding a large server entries file on a single thread.
+- (void)testPerformanceEgressRegionsFromLargeFileSerial {
+    NSString *filePath = [EmbeddedServerEntriesTest createLargeServerEntriesFile];
+    [self measureBlock:^{
+        NSError *e;
+        [EmbeddedServerEntries egressRegionsFromFile:filePath maxConcurrency:1 error:&e];
+        XCTAssertNil(e);
+    }];
+}
+
+/// Test performance of decoding a large server entries file on all active processors.
+- (void)testPerformanceEgressRegionsFromLargeFileConcurrent {
+    NSString *filePath = [EmbeddedServerEntriesTest createLargeServerEntriesFile];
+    [self measureBlock:^{
+        NSError *e;
+        [EmbeddedServerEntries egressRegionsFromFile:filePath
+                                      maxConcurrency:[[NSProcessInfo processInfo] activeProcessorCount]
+                                               error:&e];
+        XCTAssertNil(e);
+    }];
+}
+
+- (void)testHexDecodeMatchesLegacyDecoder {
+    NSData *input = [EmbeddedServerEntriesTest hexLinesOfLength:kHexBenchmarkLineLength
+                                                    totalLength:kHexBenchmarkLineLength * 64];
+    const char *lines = input.bytes;
+
+    for (NSUInteger i = 0; i < input.length; i += kHexBenchmarkLineLength + 1) {
+        const char *line = lines + i;
+
+        char *expected = legacy_hex_decode(line);
+        char *decoded = hex_decode(line);
+        XCTAssertTrue(expected != NULL && decoded != NULL);
+        XCTAssertEqual(strcmp(expected, decoded), 0);
+
+        // Decoding in place must produce the same bytes.
+        char *inPlace = strdup(line);
+        ssize_t len = hex_decode_buf(inPlace, kHexBenchmarkLineLength, inPlace);
+        XCTAssertEqual(len, kHexBenchmarkLineLength / 2);
+        XCTAssertEqual(memcmp(expected, inPlace, len), 0);
+
+        free(expected);
+        free(decoded);
+        free(inPlace);
+    }
+}
+
+- (void)testHexDecodeInvalidInput {
+    char out[64];
+    XCTAssertEqual(hex_decode_buf("abc", 3, out), -1);
+    XCTAssertEqual(hex_decode_buf("zz", 2, out), -1);
+    XCTAssertEqual(hex_decode_buf("00", 2, out), -1);
+    // Invalid character past the vectorized prefix.
+    XCTAssertEqual(hex_decode_buf("41414141414141414141414141414141414141414141414141414141414141414g", 66, out), -1);
+    // Invalid character inside the vectorized prefix.
+    XCTAssertEqual(hex_decode_buf("4141414141414141414141414141g14141414141414141414141414141414141", 64, out), -1);
+    XCTAssertEqual(hex_decode_buf("4A4a", 4, out), 2);
+    XCTAssertEqual(memcmp(out, "JJ", 2), 0);
+}
+
+- (void)testLineIterator {
+    const char buf[] = "ab\r\ncd\n\nef\r";
+    line_iterator it;
+    line_iterator_init(&it, buf, sizeof(buf) - 1);
+
+    const char *expected[] = {"ab", "cd", "", "ef"};
+    const char *line;
+    size_t len;
+
+    for (int i = 0; i < 4; i++) {
+        XCTAssertEqual(line_iterator_next(&it, &line, &len), 1);
+        XCTAssertEqual(len, strlen(expected[i]));
+        XCTAssertEqual(strncmp(line, expected[i], len), 0);
+    }
+    XCTAssertEqual(line_iterator_next(&it, &line, &len), 0);
+
+    // Trailing newline does not produce an empty final line.
+    line_iterator_init(&it, "ab\n", 3);
+    XCTAssertEqual(line_iterator_next(&it, &line, &len), 1);
+    XCTAssertEqual(line_iterator_next(&it, &line, &len), 0);
+
+    line_iterator_init(&it, NULL, 0);
+    XCTAssertEqual(line_iterator_next(&it, &line, &len), 0);
+}
+
+/// Benchmarks the reference decoder on multi-megabyte input.
+- (void)testPerformanceLegacyHexDecode {
+    NSData *input = [EmbeddedServerEntriesTest hexLinesOfLength:kHexBenchmarkLineLength
+                                                    totalLength:kHexBenchmarkInputSize];
+    const char *lines = input.bytes;
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < input.length; i += kHexBenchmarkLineLength + 1) {
+            free(legacy_hex_decode(lines + i));
+        }
+    }];
+}
+
+/// Benchmarks `hex_decode_buf` on the same input as `testPerformanceLegacyHexDecode`.
+- (void)testPerformanceHexDecode {
+    NSData *input = [EmbeddedServerEntriesTest hexLinesOfLength:kHexBenchmarkLineLength
+                                                    totalLength:kHexBenchmarkInputSize];
+    const char *lines = input.bytes;
+    char *out = malloc(kHexBenchmarkLineLength / 2);
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < input.length; i += kHexBenchmarkLineLength + 1) {
+            hex_decode_buf(lines + i, kHexBenchmarkLineLength, out);
+        }
+    }];
+
+    free(out);
+}
+
+- (void)testJsonScannerMatchesNSJSONSerialization {
+    NSArray<NSData*> *entries = [EmbeddedServerEntriesTest embeddedServerEntriesJson];
+    XCTAssertTrue([entries count] > 0);
+
+    NSUInteger compared = 0;
+
+    for (NSData *entry in entries) {
+        NSDictionary *jsonObject = [NSJSONSerialization JSONObjectWithData:entry options:kNilOptions error:nil];
+
+        // Server entries are ASCII JSON without escapes in these fields or duplicate keys,
+        // so the scanner should never fall back on them.
+        json_field fields[] = { {.key = "region"}, {.key = "ipAddress"}, {.key = "capabilities"} };
+        json_scan_result result = server_entry_json_scan(entry.bytes, entry.length, fields, 3);
+        XCTAssertEqual(result, JSON_SCAN_OK);
+        if (result != JSON_SCAN_OK) {
+            continue;
+        }
+        compared++;
+
+        NSArray *keys = @[@"region", @"ipAddress"];
+        for (int i = 0; i < 2; i++) {
+            NSString *expected = jsonObject[keys[i]];
+            NSString *scanned = [[NSString alloc] initWithBytes:fields[i].value
+                                                         length:fields[i].value_len
+                                                       encoding:NSASCIIStringEncoding];
+            XCTAssertEqualObjects(expected, scanned);
+        }
+
+        NSMutableArray *capabilities = [NSMutableArray array];
+        const char *cursor = fields[2].value;
+        const char *value;
+        size_t len;
+        while (json_string_array_next(&cursor, fields[2].value + fields[2].value_len, &value, &len) == 1) {
+            [capabilities addObject:[[NSString alloc] initWithBytes:value
+                                                             length:len
+                                                           encoding:NSASCIIStringEncoding]];
+        }
+        XCTAssertEqualObjects(jsonObject[@"capabilities"], capabilities);
+    }
+
+    XCTAssertEqual(compared, [entries count]);
+}
+
+- (void)testJsonScannerFallback {
+    json_field field = {.key = "region"};
+
+    const char *fallbacks[] = {
+        "{\"region\":\"U\\u0053\"}",     // escaped value
+        "{\"region\":\"US\",\"region\":\"CA\"}", // duplicate key
+        "{\"region\":\"US\",}",          // trailing comma
+        "{\"x\":\"\xc3\xa9\",\"region\":\"US\"}", // non-ASCII
+        "{\"region\":\"US\"} x",         // trailing garbage
+        "[\"region\"]",                  // not an object
+    };
+    for (int i = 0; i < sizeof(fallbacks) / sizeof(fallbacks[0]); i++) {
+        XCTAssertEqual(server_entry_json_scan(fallbacks[i], strlen(fallbacks[i]), &field, 1), JSON_SCAN_FALLBACK);
+    }
+
+    const char *json = "{ \"a\" : \"q\\\"\\u00e9\" , \"b\":[1,-2.5e+3,{\"c\":null}], \"region\" : \"CA\" }";
+    XCTAssertEqual(server_entry_json_scan(json, strlen(json), &field, 1), JSON_SCAN_OK);
+    XCTAssertEqual(field.type, JSON_VALUE_STRING);
+    XCTAssertEqual(strncmp(field.value, "CA", field.value_len), 0);
+}
+
+/// Benchmarks extracting the region of each embedded server entry with NSJSONSerialization.
+- (void)testPerformanceRegionNSJSONSerialization {
+    NSArray<NSData*> *entries = [EmbeddedServerEntriesTest embeddedServerEntriesJson];
+
+    [self measureBlock:^{
+        for (NSData *entry in entries) {
+            @autoreleasepool {
+                NSDictionary *jsonObject = [NSJSONSerialization JSONObjectWithData:entry
+                                                                           options:kNilOptions
+                                                                             error:nil];
+                XCTAssertNotNil(jsonObject[@"region"]);
+            }
+        }
+    }];
+}
+
+/// Benchmarks extracting the region of each embedded server entry with `server_entry_json_scan`.
+- (void)testPerformanceRegionJsonScanner {
+    NSArray<NSData*> *entries = [EmbeddedServerEntriesTest embeddedServerEntriesJson];
+
+    [self measureBlock:^{
+        for (NSData *entry in entries) {
+            json_field field = {.key = "region"};
+            server_entry_json_scan(entry.bytes, entry.length, &field, 1);
+            XCTAssertEqual(field.type, JSON_VALUE_STRING);
+        }
+    }];
+}
+
+/// Test that the region histogram covers every egress region and that repeated server entries are counted as duplicates.
+- (void)testStatisticsFromFile {
+    NSError *e;
+    NSString *filePath = [EmbeddedServerEntriesTest embeddedServerEntriesPath];
+    EmbeddedServerEntriesStatistics *statistics = [EmbeddedServerEntries statisticsFromFile:filePath error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqual(statistics.entryCount, [[EmbeddedServerEntriesTest embeddedServerEntriesJson] count]);
+
+    NSSet *regions = [EmbeddedServerEntries egressRegionsFromFile:filePath maxConcurrency:1 error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqualObjects([NSSet setWithArray:[statistics.regionCounts allKeys]], regions);
+    XCTAssertEqual([[statistics.regionCounts.allValues valueForKeyPath:@"@sum.self"] unsignedIntegerValue],
+                   statistics.entryCount);
+
+    // Duplicates are exact.
+    NSMutableSet<NSString*> *ipAddresses = [NSMutableSet set];
+    NSUInteger duplicateCount = 0;
+    for (NSData *entry in [EmbeddedServerEntriesTest embeddedServerEntriesJson]) {
+        NSDictionary *json = [NSJSONSerialization JSONObjectWithData:entry options:kNilOptions error:nil];
+        if ([ipAddresses containsObject:json[@"ipAddress"]]) {
+            duplicateCount++;
+        }
+        [ipAddresses addObject:json[@"ipAddress"]];
+    }
+    XCTAssertEqual(statistics.duplicateCount, duplicateCount);
+    XCTAssertFalse(statistics.ipAddressLimitReached);
+
+    // Every entry of the second copy is a duplicate.
+    NSMutableData *twice = [NSMutableData dataWithData:[EmbeddedServerEntriesTest embeddedServerEntriesData]];
+    [twice appendData:[EmbeddedServerEntriesTest embeddedServerEntriesData]];
+    NSString *twicePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"duplicate_embedded_server_entries"];
+    [[NSFileManager defaultManager] createFileAtPath:twicePath contents:twice attributes:nil];
+
+    EmbeddedServerEntriesStatistics *twiceStatistics = [EmbeddedServerEntries statisticsFromFile:twicePath error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqual(twiceStatistics.entryCount, 2 * statistics.entryCount);
+    XCTAssertEqual(twiceStatistics.duplicateCount, statistics.duplicateCount + statistics.entryCount);
+    XCTAssertTrue([twiceStatistics.duplicateIPAddresses count] > 0);
+    XCTAssertTrue([twiceStatistics.duplicateIPAddresses count] <= 100);
+    for (NSString *region in statistics.regionCounts) {
+        XCTAssertEqual([twiceStatistics.regionCounts[region] unsignedIntegerValue],
+                       2 * [statistics.regionCounts[region] unsignedIntegerValue]);
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:twicePath error:nil];
+
+    // Invalid file.
+    [EmbeddedServerEntries statisticsFromFile:[EmbeddedServerEntriesTest createFileWithRandomData] error:&e];
+    XCTAssertNotNil(e);
+    XCTAssertEqual(e.code, EmbeddedServerEntriesErrorDecodingError);
+}
+
+/// Test that unusual regions, which `egressRegionsFromFile:error:` accepts, are counted rather than failing the file.
+- (void)testStatisticsCountsAnyRegion {
+    NSString *filePath = [EmbeddedServerEntriesTest createFileWithRegions:@[@"", @"ABCDEFGH", @"US", @""]];
+
+    NSError *e;
+    EmbeddedServerEntriesStatistics *statistics = [EmbeddedServerEntries statisticsFromFile:filePath error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqual(statistics.entryCount, 4);
+    XCTAssertEqualObjects(statistics.regionCounts, (@{@"": @2, @"ABCDEFGH": @1, @"US": @1}));
+    XCTAssertEqual(statistics.duplicateCount, 0);
+
+    NSSet *regions = [EmbeddedServerEntries egressRegionsFromFile:filePath cachePath:nil error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqualObjects([NSSet setWithArray:[statistics.regionCounts allKeys]], regions);
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+/// Test that the server entry table holds every embedded server entry and that queries match a linear scan.
+- (void)testServerEntryTable {
+    NSError *e;
+    NSString *filePath = [EmbeddedServerEntriesTest embeddedServerEntriesPath];
+    EmbeddedServerEntryTable *table = [EmbeddedServerEntryTable tableFromFile:filePath error:&e];
+    XCTAssertNil(e);
+
+    NSArray<NSData*> *entries = [EmbeddedServerEntriesTest embeddedServerEntriesJson];
+    XCTAssertEqual([table count], [entries count]);
+
+    NSSet *regions = [EmbeddedServerEntries egressRegionsFromFile:filePath maxConcurrency:1 error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqualObjects([NSSet setWithArray:[table regions]], regions);
+
+    for (NSString *region in regions) {
+        NSMutableIndexSet *expected = [NSMutableIndexSet indexSet];
+        [entries enumerateObjectsUsingBlock:^(NSData *entry, NSUInteger i, BOOL *stop) {
+            NSDictionary *json = [NSJSONSerialization JSONObjectWithData:entry options:kNilOptions error:nil];
+            if ([json[@"region"] isEqualToString:region] && [json[@"capabilities"] containsObject:@"OSSH"]) {
+                [expected addIndex:i];
+            }
+        }];
+
+        NSIndexSet *matches = [table entriesInRegion:region supportingCapabilities:@[@"OSSH"]];
+        XCTAssertEqualObjects(matches, expected);
+
+        [matches enumerateIndexesUsingBlock:^(NSUInteger i, BOOL *stop) {
+            XCTAssertEqualObjects([table regionAtIndex:i], region);
+            XCTAssertTrue([[table ipAddressAtIndex:i] length] > 0);
+        }];
+    }
+
+    XCTAssertEqual([[table entriesInRegion:nil supportingCapabilities:@[]] count], [table count]);
+    XCTAssertEqual([[table entriesInRegion:@"XX" supportingCapabilities:@[]] count], 0);
+    XCTAssertEqual([[table entriesInRegion:nil supportingCapabilities:@[@"UNKNOWN"]] count], 0);
+
+    // Binary file.
+    NSString *binaryPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"table_embedded_server_entries"];
+    [[NSFileManager defaultManager] createFileAtPath:binaryPath
+                                            contents:[EmbeddedServerEntriesTest binaryServerEntries]
+                                          attributes:nil];
+    EmbeddedServerEntryTable *binaryTable = [EmbeddedServerEntryTable tableFromFile:binaryPath error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqual([binaryTable count], [table count]);
+
+    // Binary files with a truncated header or an unsupported version.
+    NSArray<NSData*> *unsupportedBinaries = @[
+        [NSData dataWithBytes:"PSEB\x01\0" length:6],
+        [NSData dataWithBytes:"PSEB\x02\0\0\0\0\0\0\0" length:12]
+    ];
+    for (NSData *unsupported in unsupportedBinaries) {
+        [[NSFileManager defaultManager] createFileAtPath:binaryPath contents:unsupported attributes:nil];
+
+        EmbeddedServerEntryTable *unsupportedTable = [EmbeddedServerEntryTable tableFromFile:binaryPath error:&e];
+        XCTAssertNotNil(e);
+        XCTAssertEqual(e.code, EmbeddedServerEntriesErrorDecodingError);
+        XCTAssertEqual([unsupportedTable count], 0);
+
+        [EmbeddedServerEntries statisticsFromFile:binaryPath error:&e];
+        XCTAssertNotNil(e);
+        XCTAssertEqual(e.code, EmbeddedServerEntriesErrorDecodingError);
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:binaryPath error:nil];
+
+    // Invalid file.
+    [EmbeddedServerEntryTable tableFromFile:[EmbeddedServerEntriesTest createFileWithRandomData] error:&e];
+    XCTAssertNotNil(e);
+    XCTAssertEqual(e.code, EmbeddedServerEntriesErrorDecodingError);
+}
+
+/// Test that unusual regions, which `egressRegionsFromFile:error:` accepts, do not stop the table from being built.
+- (void)testServerEntryTableAcceptsAnyRegion {
+    NSArray<NSString*> *regions = @[@"", @"ABCDEFGH", @"US"];
+    NSString *filePath = [EmbeddedServerEntriesTest createFileWithRegions:regions];
+
+    NSError *e;
+    EmbeddedServerEntryTable *table = [EmbeddedServerEntryTable tableFromFile:filePath error:&e];
+    XCTAssertNil(e);
+    XCTAssertEqual([table count], [regions count]);
+    XCTAssertEqualObjects([table regions], regions);
+
+    for (NSUInteger i = 0; i < [regions count]; i++) {
+        XCTAssertEqualObjects([table regionAtIndex:i], regions[i]);
+        XCTAssertEqualObjects([table entriesInRegion:regions[i] supportingCapabilities:@[]],
+                              [NSIndexSet indexSetWithIndex:i]);
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+/// Test that a server entry whose IP address is not ASCII is rejected, so that `ipAddressAtIndex:` is never nil.
+- (void)testServerEntryTableRejectsNonASCIIIPAddress {
+    // Hex encoded "\xff 80 s c {"region":"US"}".
+    NSString *entry = @"ff20383020732063207b22726567696f6e223a225553227d\n";
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"non_ascii_embedded_server_entries"];
+    [[NSFileManager defaultManager] createFileAtPath:filePath
+                                            contents:[entry dataUsingEncoding:NSUTF8StringEncoding]
+                                          attributes:nil];
+
+    NSError *e;
+    EmbeddedServerEntryTable *table = [EmbeddedServerEntryTable tableFromFile:filePath error:&e];
+    XCTAssertNotNil(e);
+    XCTAssertEqual(e.code, EmbeddedServerEntriesErrorDecodingError);
+    XCTAssertEqual([table count], 0);
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+/// Benchmarks filtering a table built from a large server entries file.
+- (void)testPerformanceServerEntryTableQuery {
+    NSError *e;
+    NSString *filePath = [EmbeddedServerEntriesTest createLargeServerEntriesFile];
+    EmbeddedServerEntryTable *table = [EmbeddedServerEntryTable tableFromFile:filePath error:&e];
+    XCTAssertNil(e);
+    NSArray<NSString*> *regions = [table regions];
+
+    [self measureBlock:^{
+        for (NSString *region in regions) {
+            [table entriesInRegion:region supportingCapabilities:@[@"OSSH", @"QUIC"]];
+        }
+    }];
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
 #pragma mark - Helpers
 
+/// Returns the hex decoded JSON of each server entry embedded in the test target.
++ (NSArray<NSData*>*)embeddedServerEntriesJson {
+    NSMutableArray<NSData*> *entries = [NSMutableArray array];
+
+    server_entries_file file;
+    if (server_entries_file_map([[EmbeddedServerEntriesTest embeddedServerEntriesPath] UTF8String], &file) != 0) {
+        return entries;
+    }
+
+    line_iterator it;
+    line_iterator_init(&it, file.data, file.len);
+
+    const char *line;
+    size_t len;
+    while (line_iterator_next(&it, &line, &len) == 1) {
+        NSMutableData *decoded = [NSMutableData dataWithLength:(len / 2) + 1];
+        ssize_t decoded_len = hex_decode_buf(line, len, decoded.mutableBytes);
+        if (decoded_len < 0) {
+            break;
+        }
+        ((char *)decoded.mutableBytes)[decoded_len] = '\0';
+
+        const char *json = server_entry_json(decoded.bytes);
+        if (json == NULL) {
+            break;
+        }
+        [entries addObject:[NSData dataWithBytes:json length:strlen(json)]];
+    }
+
+    server_entries_file_unmap(&file);
+
+    return entries;
+}
+
+/// Decodes the embedded server entries with an empty cache at `cachePath`, so that the file is always scanned.
 - (void)egressRegionsFromFile {
     NSError *e;
     NSSet *embeddedEgressRegions =
         [EmbeddedServerEntries egressRegionsFromFile:[EmbeddedServerEntriesTest embeddedServerEntriesPath]
+                                           cachePath:self.cachePath
                                                error:&e];
     XCTAssertNil(e);
     XCTAssertNotNil(embeddedEgressRegions);
@@ -86,6 +759,170 @@
     return newFilePath;
 }
 
+/// Creates a server entries file in the hex line format with one server entry in each of `regions`, in order.
++ (NSString*)createFileWithRegions:(NSArray<NSString*>*)regions {
+    NSMutableData *data = [NSMutableData data];
+    for (NSUInteger i = 0; i < [regions count]; i++) {
+        NSDictionary *json = @{@"ipAddress": [NSString stringWithFormat:@"10.0.0.%lu", (unsigned long)i + 1],
+                               @"region": regions[i]};
+        NSMutableData *entry = [NSMutableData data];
+        [entry appendData:[[NSString stringWithFormat:@"%@ 80 secret certificate ", json[@"ipAddress"]]
+                           dataUsingEncoding:NSUTF8StringEncoding]];
+        [entry appendData:[NSJSONSerialization dataWithJSONObject:json options:kNilOptions error:nil]];
+
+        const unsigned char *bytes = entry.bytes;
+        NSMutableString *line = [NSMutableString stringWithCapacity:2 * [entry length] + 1];
+        for (NSUInteger j = 0; j < [entry length]; j++) {
+            [line appendFormat:@"%02x", bytes[j]];
+        }
+        [line appendString:@"\n"];
+        [data appendData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"regions_embedded_server_entries"];
+    [[NSFileManager defaultManager] createFileAtPath:filePath contents:data attributes:nil];
+    return filePath;
+}
+
+/// Returns the server entries embedded in the test target, terminated by a newline so that copies can be concatenated.
++ (NSData*)embeddedServerEntriesData {
+    NSMutableData *data = [NSMutableData dataWithContentsOfFile:[EmbeddedServerEntriesTest embeddedServerEntriesPath]];
+    if ([data length] > 0 && ((const char *)data.bytes)[[data length] - 1] != '\n') {
+        [data appendBytes:"\n" length:1];
+    }
+    return data;
+}
+
+/// Returns the server entries embedded in the test target converted to the binary container format.
++ (NSData*)binaryServerEntries {
+    NSMutableData *entries = [NSMutableData data];
+    uint32_t count = 0;
+
+    server_entries_file file;
+    if (server_entries_file_map([[EmbeddedServerEntriesTest embeddedServerEntriesPath] UTF8String], &file) != 0) {
+        return entries;
+    }
+
+    line_iterator it;
+    line_iterator_init(&it, file.data, file.len);
+
+    const char *line;
+    size_t len;
+    while (line_iterator_next(&it, &line, &len) == 1) {
+        NSMutableData *decoded = [NSMutableData dataWithLength:len / 2];
+        if (hex_decode_buf(line, len, decoded.mutableBytes) < 0) {
+            break;
+        }
+
+        // Unsigned LEB128 length.
+        size_t n = [decoded length];
+        do {
+            uint8_t b = n & 0x7F;
+            n >>= 7;
+            if (n != 0) {
+                b |= 0x80;
+            }
+            [entries appendBytes:&b length:1];
+        } while (n != 0);
+
+        [entries appendData:decoded];
+        count++;
+    }
+
+    server_entries_file_unmap(&file);
+
+    uint32_t version = CFSwapInt32HostToLittle(1);
+    count = CFSwapInt32HostToLittle(count);
+
+    NSMutableData *data = [NSMutableData dataWithBytes:"PSEB" length:4];
+    [data appendBytes:&version length:sizeof(version)];
+    [data appendBytes:&count length:sizeof(count)];
+    [data appendData:entries];
+
+    return data;
+}
+
+/// Returns an index in the layout written by `gen_server_entries_index.py` for the server entries file `source`,
+/// with `regions` as its region table. `regions` must be sorted. Each region has a single entry at offset 0.
++ (NSData*)indexForServerEntries:(NSData*)source regions:(NSArray<NSString*>*)regions {
+    NSMutableData *regionTable = [NSMutableData data];
+    NSMutableData *strings = [NSMutableData data];
+    NSMutableData *offsets = [NSMutableData data];
+
+    for (NSUInteger i = 0; i < [regions count]; i++) {
+        NSData *name = [regions[i] dataUsingEncoding:NSUTF8StringEncoding];
+        uint32_t region[4] = {
+            CFSwapInt32HostToLittle((uint32_t)[strings length]),
+            CFSwapInt32HostToLittle((uint32_t)[name length]),
+            CFSwapInt32HostToLittle(1),
+            CFSwapInt32HostToLittle((uint32_t)i)
+        };
+        [regionTable appendBytes:region length:sizeof(region)];
+        [strings appendData:name];
+
+        uint64_t offset = 0;
+        [offsets appendBytes:&offset length:sizeof(offset)];
+    }
+
+    uint32_t stringsSize = CFSwapInt32HostToLittle((uint32_t)[strings length]);
+    [strings increaseLengthBy:(8 - [strings length] % 8) % 8];
+
+    uint32_t version = CFSwapInt32HostToLittle(2);
+    uint64_t sourceSize = CFSwapInt64HostToLittle([source length]);
+    uint64_t sourceHash = CFSwapInt64HostToLittle(server_entries_content_hash(source.bytes, [source length]));
+    uint32_t counts[2] = {
+        CFSwapInt32HostToLittle((uint32_t)[regions count]),
+        CFSwapInt32HostToLittle((uint32_t)[regions count])
+    };
+    uint32_t reserved = 0;
+
+    NSMutableData *index = [NSMutableData dataWithBytes:"PSEI" length:4];
+    [index appendBytes:&version length:sizeof(version)];
+    [index appendBytes:&sourceSize length:sizeof(sourceSize)];
+    [index appendBytes:&sourceHash length:sizeof(sourceHash)];
+    [index appendBytes:counts length:sizeof(counts)];
+    [index appendBytes:&stringsSize length:sizeof(stringsSize)];
+    [index appendBytes:&reserved length:sizeof(reserved)];
+    [index appendData:regionTable];
+    [index appendData:strings];
+    [index appendData:offsets];
+
+    return index;
+}
+
+/// Creates a server entries file of at least 16 MB by repeating the embedded server entries.
++ (NSString*)createLargeServerEntriesFile {
+    NSData *entries = [EmbeddedServerEntriesTest embeddedServerEntriesData];
+    NSMutableData *data = [NSMutableData data];
+    while ([entries length] > 0 && [data length] < 16 * 1024 * 1024) {
+        [data appendData:entries];
+    }
+
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"large_embedded_server_entries"];
+    [[NSFileManager defaultManager] createFileAtPath:filePath contents:data attributes:nil];
+    return filePath;
+}
+
+/// Returns NULL terminated lines of random hex characters, none of which decode to a NULL byte.
++ (NSData*)hexLinesOfLength:(NSUInteger)lineLength totalLength:(NSUInteger)totalLength {
+    static const char hexChars[] = "0123456789abcdefABCDEF";
+    NSUInteger numLines = totalLength / lineLength;
+    NSMutableData *data = [NSMutableData dataWithLength:numLines * (lineLength + 1)];
+    char *p = data.mutableBytes;
+
+    for (NSUInteger i = 0; i < numLines; i++) {
+        for (NSUInteger j = 0; j < lineLength; j += 2) {
+            // High nibble is never zero.
+            p[j] = hexChars[1 + arc4random_uniform(sizeof(hexChars) - 2)];
+            p[j + 1] = hexChars[arc4random_uniform(sizeof(hexChars) - 1)];
+        }
+        p[lineLength] = '\0';
+        p += lineLength + 1;
+    }
+
+    return data;
+}
+
 + (NSData*)randomData {
     int capacity = 1048576; // 1 MB
     NSMutableData *data = [NSMutableData dataWithCapacity:capacity];
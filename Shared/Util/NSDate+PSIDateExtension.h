@@ -21,10 +21,27 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Length of the timestamps of `nowRFC3339Milli` and `RFC3339MilliString`, e.g. "2006-01-02T15:04:05.999Z".
+#define PSI_RFC3339_MILLI_LENGTH 24
+
 @interface NSDate (PSIDateExtension)
 
+/**
+ * Formats the current date with precision of 3 decimal points on the second.
+ * The date and time up to the second are cached per thread, so that only the
+ * milliseconds are formatted for consecutive calls within the same second.
+ * @return RFC3339 timestamp.
+ */
 + (NSString *)nowRFC3339Milli;
 
+/**
+ * Same as `nowRFC3339Milli`, but writes the timestamp into `buffer` without allocating.
+ * @param buffer Buffer that the NUL terminated timestamp is written to.
+ * @param length Length of `buffer`, which must be at least PSI_RFC3339_MILLI_LENGTH + 1.
+ * @return Length of the timestamp, or 0 if `buffer` is too small.
+ */
++ (size_t)writeNowRFC3339Milli:(char *)buffer length:(size_t)length;
+
 /**
  * Create NSDate object from RFC3339 formatted timestamp.
  * @param timestamp RFC3339 formatted timestamp.
@@ -18,22 +18,78 @@
  */
 
 #import "NSDate+PSIDateExtension.h"
-#import "timestamp.h"
+@import Rfc3339CTimestamp;
 #import "Asserts.h"
 #import "Nullity.h"
+#import <sys/time.h>
 
 // 10^9
 #define POW_10_9 1000000000.0
 
 #define SECOND_PRECISION 0
-#define MILLISECOND_PRECISION 3
 
 #define TIME_ZONE_OFFSET_UTC_MINUTES 0
 
+/// Length of "YYYY-MM-DDThh:mm:ss".
+#define RFC3339_SECOND_PREFIX_LENGTH 19
+
+/// Date and time of the last second formatted by `FormatRFC3339Milli` on the current thread.
+typedef struct {
+    BOOL valid;
+    int64_t sec;
+    char prefix[RFC3339_SECOND_PREFIX_LENGTH];
+} rfc3339_second_cache;
+
+static _Thread_local rfc3339_second_cache secondCache;
+
+/// Writes the UTC timestamp of `sec` and `nsec` with millisecond precision into `buffer`, as
+/// `psi_timestamp_format_precision` does. Only the milliseconds are formatted if `sec` is the second
+/// last formatted on the current thread. Returns 0 if the timestamp is invalid or `buffer` is too small.
+static size_t FormatRFC3339Milli(int64_t sec, int32_t nsec, char *buffer, size_t length) {
+    if (length < PSI_RFC3339_MILLI_LENGTH + 1 || nsec < 0 || nsec >= POW_10_9) {
+        return 0;
+    }
+
+    if (!secondCache.valid || secondCache.sec != sec) {
+        const psi_timestamp_t ts = {.sec = sec, .offset = TIME_ZONE_OFFSET_UTC_MINUTES};
+        char buf[40];
+        if (psi_timestamp_format_precision(buf, sizeof(buf), &ts, SECOND_PRECISION) == 0) {
+            return 0;
+        }
+        memcpy(secondCache.prefix, buf, RFC3339_SECOND_PREFIX_LENGTH);
+        secondCache.sec = sec;
+        secondCache.valid = TRUE;
+    }
+
+    const int32_t milli = nsec / 1000000;
+    char *p = buffer;
+    memcpy(p, secondCache.prefix, RFC3339_SECOND_PREFIX_LENGTH);
+    p += RFC3339_SECOND_PREFIX_LENGTH;
+    *p++ = '.';
+    *p++ = '0' + milli / 100;
+    *p++ = '0' + milli / 10 % 10;
+    *p++ = '0' + milli % 10;
+    *p++ = 'Z';
+    *p = '\0';
+
+    return PSI_RFC3339_MILLI_LENGTH;
+}
+
 @implementation NSDate (PSIDateExtension)
 
 + (NSString *)nowRFC3339Milli {
-    return [[NSDate date] RFC3339MilliString];
+    char buf[PSI_RFC3339_MILLI_LENGTH + 1];
+    size_t length = [NSDate writeNowRFC3339Milli:buf length:sizeof(buf)];
+
+    PSIAssert(length > 0);
+
+    return [[NSString alloc] initWithBytes:buf length:length encoding:NSUTF8StringEncoding];
+}
+
++ (size_t)writeNowRFC3339Milli:(char *)buffer length:(size_t)length {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return FormatRFC3339Milli(tv.tv_sec, (int32_t)tv.tv_usec * 1000, buffer, length);
 }
 
 + (NSDate *_Nullable)fromRFC3339String:(NSString *)timestamp {
@@ -42,9 +98,9 @@
         return nil;
     }
 
-    dup_timestamp_t ts;
+    psi_timestamp_t ts;
 
-    int result = dup_timestamp_parse([timestamp UTF8String], [timestamp lengthOfBytesUsingEncoding:NSUTF8StringEncoding], &ts);
+    int result = psi_timestamp_parse([timestamp UTF8String], [timestamp lengthOfBytesUsingEncoding:NSUTF8StringEncoding], &ts);
 
     if (result != 0) {
         return nil;
@@ -62,11 +118,11 @@
     double sec_integral, sec_fraction;
     sec_fraction = modf(interval, &sec_integral);
 
-    const dup_timestamp_t ts = {.sec = (int64_t) sec_integral,
+    const psi_timestamp_t ts = {.sec = (int64_t) sec_integral,
                             .offset = TIME_ZONE_OFFSET_UTC_MINUTES};
 
     char buf[40];
-    size_t length = dup_timestamp_format_precision(buf, sizeof(buf), &ts, SECOND_PRECISION);
+    size_t length = psi_timestamp_format_precision(buf, sizeof(buf), &ts, SECOND_PRECISION);
 
     PSIAssert(length > 0);
 
@@ -81,11 +137,9 @@
     sec_fraction = modf(interval, &sec_integral);
 
     int32_t nsec = (int32_t) (sec_fraction * POW_10_9);
-    
-    const dup_timestamp_t ts = {.sec = (int64_t) sec_integral, .nsec = nsec, .offset = TIME_ZONE_OFFSET_UTC_MINUTES};
 
-    char buf[40];
-    size_t length = dup_timestamp_format_precision(buf, sizeof(buf), &ts, MILLISECOND_PRECISION);
+    char buf[PSI_RFC3339_MILLI_LENGTH + 1];
+    size_t length = FormatRFC3339Milli((int64_t) sec_integral, nsec, buf, sizeof(buf));
 
     PSIAssert(length > 0);
 
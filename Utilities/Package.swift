@@ -14,6 +14,10 @@ let package = Package(
         .library(
             name: "Utilities",
             targets: ["Utilities", "Rfc3339CTimestamp"]),
+        // RFC 3339 timestamps for Objective-C targets that do not link the Swift "Utilities" module.
+        .library(
+            name: "Rfc3339CTimestamp",
+            targets: ["Rfc3339CTimestamp"]),
     ],
     dependencies: [
         // Dependencies declare other packages that this package depends on.
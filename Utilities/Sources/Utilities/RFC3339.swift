@@ -29,20 +29,74 @@ extension Date {
         case nine = 9
     }
     
+    /// Date of a timestamp parsed by `psi_timestamp_parse`.
+    private init(rfc3339Timestamp ts: psi_timestamp_t) {
+        let secondFraction: Double = Double(ts.nsec) / pow(10, 9)
+        let timeIntervalSince1970: TimeInterval = Double(ts.sec) + secondFraction
+        self.init(timeIntervalSince1970: timeIntervalSince1970)
+    }
+    
     public static func parse(rfc3339Date: String) -> Date? {
-        var ts = timestamp_t()
-        let result = timestamp_parse(rfc3339Date,
-                                     rfc3339Date.lengthOfBytes(using: .utf8),
-                                     &ts)
+        // Native strings are parsed in place, other strings are copied once.
+        if let parsed = rfc3339Date.utf8.withContiguousStorageIfAvailable({
+            parse(rfc3339Date: UnsafeRawBufferPointer($0))
+        }) {
+            return parsed
+        }
+        return Array(rfc3339Date.utf8).withUnsafeBytes { parse(rfc3339Date: $0) }
+    }
+    
+    public static func parse(rfc3339Date: Substring) -> Date? {
+        if let parsed = rfc3339Date.utf8.withContiguousStorageIfAvailable({
+            parse(rfc3339Date: UnsafeRawBufferPointer($0))
+        }) {
+            return parsed
+        }
+        return Array(rfc3339Date.utf8).withUnsafeBytes { parse(rfc3339Date: $0) }
+    }
+    
+    /// Parses the UTF-8 bytes of `rfc3339Date`, which can be a slice of a larger buffer.
+    public static func parse(rfc3339Date: Data) -> Date? {
+        return rfc3339Date.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) in
+            parse(rfc3339Date: buffer)
+        }
+    }
+    
+    /// Parses the UTF-8 bytes of `rfc3339Date`, which need not be NUL terminated.
+    public static func parse(rfc3339Date: UnsafeRawBufferPointer) -> Date? {
+        guard let baseAddress = rfc3339Date.baseAddress else {
+            return nil
+        }
+        
+        var ts = psi_timestamp_t()
+        let result = psi_timestamp_parse(baseAddress.assumingMemoryBound(to: CChar.self),
+                                         rfc3339Date.count,
+                                         &ts)
         
         // 0 success case
         guard result == 0 else {
             return nil
         }
         
-        let secondFraction: Double = Double(ts.nsec) / pow(10, 9)
-        let timeIntervalSince1970: TimeInterval = Double(ts.sec) + secondFraction
-        return Date(timeIntervalSince1970: timeIntervalSince1970)
+        return Date(rfc3339Timestamp: ts)
+    }
+    
+    /// Parses each of `rfc3339Dates` with `psi_timestamp_parse_batch`, which has a fast path
+    /// for the `YYYY-MM-DDTHH:MM:SS.mmmZ` timestamps of notices.
+    /// Returns the dates in the same order, with `nil` for each timestamp that fails to parse.
+    public static func parse(rfc3339Dates: [UnsafeRawBufferPointer]) -> [Date?] {
+        let strs = rfc3339Dates.map {
+            psi_timestamp_str_t(str: $0.baseAddress?.assumingMemoryBound(to: CChar.self),
+                                len: $0.count)
+        }
+        var timestamps = Array(repeating: psi_timestamp_t(), count: strs.count)
+        var results = Array<Int32>(repeating: 0, count: strs.count)
+        
+        psi_timestamp_parse_batch(strs, strs.count, &timestamps, &results)
+        
+        return zip(timestamps, results).map { ts, result -> Date? in
+            result == 0 ? Date(rfc3339Timestamp: ts) : nil
+        }
     }
     
     public func formatRFC3339(
@@ -60,12 +114,12 @@ extension Date {
         let sec_fraction_integer = (sec_fraction * 1_000_000).rounded()
         let nsec = sec_fraction_integer * 1_000
         
-        var ts = timestamp_t(sec: Int64(sec_integral),
-                             nsec: Int32(nsec),
-                             offset: timezoneOffsetUTCMinutes)
+        var ts = psi_timestamp_t(sec: Int64(sec_integral),
+                                 nsec: Int32(nsec),
+                                 offset: timezoneOffsetUTCMinutes)
         
         var buf = Array<Int8>(repeating: 0, count: 40)
-        let length = timestamp_format_precision(&buf, buf.count, &ts, precision)
+        let length = psi_timestamp_format_precision(&buf, buf.count, &ts, precision)
                 
         guard length > 0 else {
             return nil
@@ -34,19 +34,30 @@
 extern "C" {
 #endif
 
+// Fork of c-timestamp shared by the Swift and Objective-C code of the app and
+// the network extension, with symbols prefixed with "psi_" so that they can not
+// clash with other copies of c-timestamp linked into the same binary.
+
 typedef struct {
     int64_t sec;    /* Number of seconds since the epoch of 1970-01-01T00:00:00Z */
     int32_t nsec;   /* Nanoseconds [0, 999999999] */
     int16_t offset; /* Offset from UTC in minutes [-1439, 1439] */
-} timestamp_t;
+} psi_timestamp_t;
+
+typedef struct {
+    const char *str; /* Timestamp, not necessarily NUL terminated */
+    size_t      len; /* Length of str in bytes */
+} psi_timestamp_str_t;
 
-int         timestamp_parse            (const char *str, size_t len, timestamp_t *tsp);
-size_t      timestamp_format           (char *dst, size_t len, const timestamp_t *tsp);
-size_t      timestamp_format_precision (char *dst, size_t len, const timestamp_t *tsp, int precision);
-int         timestamp_compare          (const timestamp_t *tsp1, const timestamp_t *tsp2);
-bool        timestamp_valid            (const timestamp_t *tsp);
-struct tm * timestamp_to_tm_utc        (const timestamp_t *tsp, struct tm *tmp);
-struct tm * timestamp_to_tm_local      (const timestamp_t *tsp, struct tm *tmp);
+int         psi_timestamp_parse            (const char *str, size_t len, psi_timestamp_t *tsp);
+size_t      psi_timestamp_parse_batch      (const psi_timestamp_str_t *strs, size_t count, psi_timestamp_t *tsps, int *results);
+size_t      psi_timestamp_format           (char *dst, size_t len, const psi_timestamp_t *tsp);
+size_t      psi_timestamp_format_precision (char *dst, size_t len, const psi_timestamp_t *tsp, int precision);
+int         psi_timestamp_compare          (const psi_timestamp_t *tsp1, const psi_timestamp_t *tsp2);
+int         psi_timestamp_compare_str      (const char *str1, size_t len1, const char *str2, size_t len2, int *result);
+bool        psi_timestamp_valid            (const psi_timestamp_t *tsp);
+struct tm * psi_timestamp_to_tm_utc        (const psi_timestamp_t *tsp, struct tm *tmp);
+struct tm * psi_timestamp_to_tm_local      (const psi_timestamp_t *tsp, struct tm *tmp);
 
 #ifdef __cplusplus
 }
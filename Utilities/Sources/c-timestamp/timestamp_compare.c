@@ -23,10 +23,12 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#include <stddef.h>
+#include <string.h>
 #include "timestamp.h"
 
 int
-timestamp_compare(const timestamp_t *t1, const timestamp_t *t2) {
+psi_timestamp_compare(const psi_timestamp_t *t1, const psi_timestamp_t *t2) {
     if (t1->sec < t2->sec)
         return -1;
     if (t1->sec > t2->sec)
@@ -38,3 +40,127 @@ timestamp_compare(const timestamp_t *t1, const timestamp_t *t2) {
     return 0;
 }
 
+static int
+leap_year(uint16_t y) {
+    return ((y & 3) == 0 && (y % 100 != 0 || y % 400 == 0));
+}
+
+static unsigned char
+month_days(uint16_t y, uint16_t m) {
+    static const unsigned char days[2][13] = {
+        {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31},
+        {0, 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31}
+    };
+    return days[m == 2 && leap_year(y)][m];
+}
+
+static int
+parse_2d(const unsigned char * const p, size_t i, uint16_t *vp) {
+    unsigned char d0, d1;
+    if (((d0 = p[i + 0] - '0') > 9) ||
+        ((d1 = p[i + 1] - '0') > 9))
+        return 1;
+    *vp = d0 * 10 + d1;
+    return 0;
+}
+
+static int
+parse_4d(const unsigned char * const p, size_t i, uint16_t *vp) {
+    unsigned char d0, d1, d2, d3;
+    if (((d0 = p[i + 0] - '0') > 9) ||
+        ((d1 = p[i + 1] - '0') > 9) ||
+        ((d2 = p[i + 2] - '0') > 9) ||
+        ((d3 = p[i + 3] - '0') > 9))
+        return 1;
+    *vp = d0 * 1000 + d1 * 100 + d2 * 10 + d3;
+    return 0;
+}
+
+/*
+ * Returns 0 if `p` is a timestamp accepted by psi_timestamp_parse that is
+ * in UTC without an offset, with any number of fraction digits:
+ *
+ *           1         2
+ * 012345678901234567890123456789
+ * 2013-12-31T23:59:59.123456789Z
+ *
+ * Fields are range checked as psi_timestamp_parse does, but no time is
+ * computed from them.
+ */
+static int
+check_utc(const unsigned char *p, size_t len) {
+    uint16_t year, month, day, hour, min, sec;
+    unsigned char ch;
+    size_t i;
+
+    if (len < 20 || len == 21 || len > 30 ||
+        p[4]  != '-' || p[7]  != '-' ||
+        p[13] != ':' || p[16] != ':')
+        return 1;
+
+    ch = p[10];
+    if (!(ch == 'T' || ch == ' ' || ch == 't'))
+        return 1;
+
+    ch = p[len - 1];
+    if (!(ch == 'Z' || ch == 'z'))
+        return 1;
+
+    if (len > 20) {
+        if (p[19] != '.')
+            return 1;
+        for (i = 20; i < len - 1; i++) {
+            if ((unsigned char)(p[i] - '0') > 9)
+                return 1;
+        }
+    }
+
+    if (parse_4d(p,  0, &year)  || year  <  1 ||
+        parse_2d(p,  5, &month) || month <  1 || month > 12 ||
+        parse_2d(p,  8, &day)   || day   <  1 || day   > 31 ||
+        parse_2d(p, 11, &hour)  || hour  > 23 ||
+        parse_2d(p, 14, &min)   || min   > 59 ||
+        parse_2d(p, 17, &sec)   || sec   > 59)
+        return 1;
+
+    if (day > 28 && day > month_days(year, month))
+        return 1;
+
+    return 0;
+}
+
+/*
+ * Compares two timestamps without converting them when possible. Two UTC
+ * timestamps of the same length, with the same separator and zone designator,
+ * have every field at the same position with the same number of digits, so
+ * their bytes order them as their times do. This is the case of all notice
+ * timestamps. Any others are parsed with psi_timestamp_parse and compared with
+ * psi_timestamp_compare.
+ *
+ * Returns 0 and sets *result to -1, 0 or 1 as psi_timestamp_compare does, or
+ * returns 1 if either timestamp is not accepted by psi_timestamp_parse.
+ */
+int
+psi_timestamp_compare_str(const char *str1, size_t len1, const char *str2, size_t len2, int *result) {
+    const unsigned char *p1, *p2;
+    psi_timestamp_t t1, t2;
+    int cmp;
+
+    p1 = (const unsigned char *)str1;
+    p2 = (const unsigned char *)str2;
+    if (len1 == len2 && len1 >= 20 &&
+        p1[10] == p2[10] && p1[len1 - 1] == p2[len2 - 1] &&
+        check_utc(p1, len1) == 0 && check_utc(p2, len2) == 0) {
+        cmp = memcmp(p1, p2, len1);
+        *result = (cmp > 0) - (cmp < 0);
+        return 0;
+    }
+
+    if (psi_timestamp_parse(str1, len1, &t1) ||
+        psi_timestamp_parse(str2, len2, &t2))
+        return 1;
+
+    *result = psi_timestamp_compare(&t1, &t2);
+    return 0;
+}
+
@@ -24,6 +24,7 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <stddef.h>
+#include <string.h>
 #include "timestamp.h"
 
 static int
@@ -70,8 +71,16 @@ static const uint16_t DayOffset[13] = {
     0, 306, 337, 0, 31, 61, 92, 122, 153, 184, 214, 245, 275
 };
 
+/* Rata Die day number of a valid date */
+static uint32_t
+rdn_from_date(uint16_t year, uint16_t month, uint16_t day) {
+    if (month < 3)
+        year--;
+    return (1461 * year)/4 - year/100 + year/400 + DayOffset[month] + day - 306;
+}
+
 int
-timestamp_parse(const char *str, size_t len, timestamp_t *tsp) {
+psi_timestamp_parse(const char *str, size_t len, psi_timestamp_t *tsp) {
     const unsigned char *cur, *end;
     unsigned char ch;
     uint16_t year, month, day, hour, min, sec;
@@ -104,10 +113,7 @@ timestamp_parse(const char *str, size_t len, timestamp_t *tsp) {
     if (day > 28 && day > month_days(year, month))
         return 1;
 
-    if (month < 3)
-        year--;
-
-    rdn = (1461 * year)/4 - year/100 + year/400 + DayOffset[month] + day - 306;
+    rdn = rdn_from_date(year, month, day);
     sod = hour * 3600 + min * 60 + sec;
     end = cur + len;
     cur = cur + 19;
@@ -143,7 +149,7 @@ timestamp_parse(const char *str, size_t len, timestamp_t *tsp) {
          *  01234
          * ±00:00
          */
-        if (cur + 5 < end || !(ch == '+' || ch == '-') || cur[2] != ':')
+        if (cur + 5 != end || !(ch == '+' || ch == '-') || cur[2] != ':')
             return 1;
 
         if (parse_2d(cur, 0, &hour) || hour > 23 ||
@@ -166,3 +172,128 @@ timestamp_parse(const char *str, size_t len, timestamp_t *tsp) {
     return 0;
 }
 
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+/*
+ * SWAR parser of the fixed shape written by the loggers, which is all
+ * notice timestamps. Each 8 byte word of the timestamp is validated at once,
+ * and each two digit field is combined without a per-digit loop.
+ *
+ *           1         2
+ * 012345678901234567890123
+ * 2013-12-31T23:59:59.999Z
+ */
+
+#define SWAR_HIGH_NIBBLES UINT64_C(0xF0F0F0F0F0F0F0F0)
+#define SWAR_ZEROS        UINT64_C(0x3030303030303030)
+#define SWAR_SIXES        UINT64_C(0x0606060606060606)
+
+/* Digit lanes and separators of the three words, little endian */
+#define MILLI_DIGITS_0 UINT64_C(0x00FFFF00FFFFFFFF) /* YYYY-MM- */
+#define MILLI_SEPS_0   UINT64_C(0x2D00002D00000000)
+#define MILLI_DIGITS_1 UINT64_C(0xFFFF00FFFF00FFFF) /* DDTHH:MM */
+#define MILLI_SEPS_1   UINT64_C(0x00003A0000540000)
+#define MILLI_DIGITS_2 UINT64_C(0x00FFFFFF00FFFF00) /* :SS.mmmZ */
+#define MILLI_SEPS_2   UINT64_C(0x5A0000002E00003A)
+
+static uint64_t
+load_64(const unsigned char *p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/*
+ * Returns the digit values in the lanes of `w` selected by `digits`, with
+ * zero in the other lanes, or UINT64_MAX if a digit lane is not an ASCII
+ * digit or the other lanes are not `seps`. A lane is a digit if its high
+ * nibble is 3 both before and after adding 6, so there are no carries
+ * between lanes.
+ */
+static uint64_t
+swar_digits(uint64_t w, uint64_t digits, uint64_t seps) {
+    const uint64_t d = w & digits;
+    if ((w & ~digits) != seps ||
+        (d & (SWAR_HIGH_NIBBLES & digits)) != (SWAR_ZEROS & digits) ||
+        ((d + (SWAR_SIXES & digits)) & (SWAR_HIGH_NIBBLES & digits)) != (SWAR_ZEROS & digits))
+        return UINT64_MAX;
+    return d - (SWAR_ZEROS & digits);
+}
+
+/*
+ * Lane i of the result is the two digit number in lanes i and i + 1 of
+ * `d`. Lanes hold at most 9 * 10 + 9, so there are no carries between lanes.
+ */
+#define SWAR_PAIRS(d) ((d) * 10 + ((d) >> 8))
+#define SWAR_LANE(w, i) ((uint16_t)(((w) >> (8 * (i))) & 0xFF))
+
+static int
+parse_milli_utc(const unsigned char *p, size_t len, psi_timestamp_t *tsp) {
+    uint64_t d0, d1, d2, t0, t1, t2;
+    uint16_t year, month, day, hour, min, sec, msec;
+
+    if (len != 24)
+        return 1;
+
+    d0 = swar_digits(load_64(p),      MILLI_DIGITS_0, MILLI_SEPS_0);
+    d1 = swar_digits(load_64(p + 8),  MILLI_DIGITS_1, MILLI_SEPS_1);
+    d2 = swar_digits(load_64(p + 16), MILLI_DIGITS_2, MILLI_SEPS_2);
+    if (d0 == UINT64_MAX || d1 == UINT64_MAX || d2 == UINT64_MAX)
+        return 1;
+
+    t0 = SWAR_PAIRS(d0);
+    t1 = SWAR_PAIRS(d1);
+    t2 = SWAR_PAIRS(d2);
+
+    year  = SWAR_LANE(t0, 0) * 100 + SWAR_LANE(t0, 2);
+    month = SWAR_LANE(t0, 5);
+    day   = SWAR_LANE(t1, 0);
+    hour  = SWAR_LANE(t1, 3);
+    min   = SWAR_LANE(t1, 6);
+    sec   = SWAR_LANE(t2, 1);
+    msec  = SWAR_LANE(t2, 4) * 10 + SWAR_LANE(d2, 6);
+
+    if (year < 1 || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || min > 59 || sec > 59)
+        return 1;
+
+    if (day > 28 && day > month_days(year, month))
+        return 1;
+
+    tsp->sec    = ((int64_t)rdn_from_date(year, month, day) - 719163) * 86400 + hour * 3600 + min * 60 + sec;
+    tsp->nsec   = msec * 1000000;
+    tsp->offset = 0;
+    return 0;
+}
+
+#else
+
+static int
+parse_milli_utc(const unsigned char *p, size_t len, psi_timestamp_t *tsp) {
+    (void)p; (void)len; (void)tsp;
+    return 1;
+}
+
+#endif
+
+/*
+ * Same results as psi_timestamp_parse on each timestamp. Timestamps of the
+ * shape above are parsed by parse_milli_utc, and any other by
+ * psi_timestamp_parse. results[i] is set to the result of timestamp i, and
+ * tsps[i] is only set if it is 0. Returns the number of timestamps parsed.
+ */
+size_t
+psi_timestamp_parse_batch(const psi_timestamp_str_t *strs, size_t count, psi_timestamp_t *tsps, int *results) {
+    size_t i, parsed;
+
+    parsed = 0;
+    for (i = 0; i < count; i++) {
+        const unsigned char *p = (const unsigned char *)strs[i].str;
+
+        results[i] = parse_milli_utc(p, strs[i].len, &tsps[i]) &&
+                     psi_timestamp_parse(strs[i].str, strs[i].len, &tsps[i]);
+        parsed += (results[i] == 0);
+    }
+    return parsed;
+}
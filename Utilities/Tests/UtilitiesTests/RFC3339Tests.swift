@@ -108,5 +108,101 @@ class RFC3339Tests: XCTestCase {
         }
         
     }
+    
+    func testConformance() throws {
+        // Conformance vectors shared with dev/TimestampBenchmark, which checks the same
+        // vectors against the C entry points. See rfc3339_conformance.tsv for the format.
+        
+        let vectorsURL = URL(fileURLWithPath: #file)
+            .deletingLastPathComponent()
+            .appendingPathComponent("rfc3339_conformance.tsv")
+        let vectors = try String(contentsOf: vectorsURL, encoding: .utf8)
+        
+        for line in vectors.split(separator: "\n") where !line.hasPrefix("#") {
+            
+            let fields = line.split(separator: "\t", omittingEmptySubsequences: false).map(String.init)
+            
+            switch (fields[0], fields.count) {
+            case ("parse", 3), ("parse", 6):
+                let input = fields[1]
+                let parsed = Date.parse(rfc3339Date: input)
+                
+                // Parses the input as a slice of a larger buffer with each of the other overloads.
+                let line = "\"\(input)\""
+                let data = Data(line.utf8)
+                XCTAssertEqual(Date.parse(rfc3339Date: line.dropFirst().dropLast()), parsed)
+                XCTAssertEqual(Date.parse(rfc3339Date: data[1..<(data.count - 1)]), parsed)
+                data.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) in
+                    let slice = UnsafeRawBufferPointer(rebasing: buffer[1..<(buffer.count - 1)])
+                    XCTAssertEqual(Date.parse(rfc3339Date: slice), parsed)
+                    XCTAssertEqual(Date.parse(rfc3339Dates: [slice, slice]), [parsed, parsed])
+                }
+                
+                var ts = psi_timestamp_t()
+                var result: Int32 = 0
+                let parsedCount = input.withCString { str -> Int in
+                    var timestamp = psi_timestamp_str_t(str: str, len: strlen(str))
+                    return psi_timestamp_parse_batch(&timestamp, 1, &ts, &result)
+                }
+                
+                if fields[2] == "0" {
+                    let sec = Int64(fields[3])!
+                    let nsec = Int32(fields[4])!
+                    XCTAssert(parsedCount == 1 && result == 0, "'\(input)' is not parsed by batch")
+                    XCTAssert(ts.sec == sec && ts.nsec == nsec && ts.offset == Int16(fields[5])!,
+                              "'\(input)' is not parsed to \(fields[3...5])")
+                    
+                    guard let parsed = parsed else {
+                        XCTFatal()
+                    }
+                    XCTAssertEqual(parsed.timeIntervalSince1970,
+                                   Double(sec) + Double(nsec) / pow(10, 9),
+                                   accuracy: 0.0001)
+                } else {
+                    XCTAssert(parsedCount == 0 && result != 0, "'\(input)' is parsed by batch")
+                    XCTAssertNil(parsed, "'\(input)' is parsed")
+                }
+                
+            case ("format", 5), ("format", 6):
+                var ts = psi_timestamp_t(sec: Int64(fields[1])!,
+                                         nsec: Int32(fields[2])!,
+                                         offset: Int16(fields[3])!)
+                var buf = Array<Int8>(repeating: 0, count: 40)
+                let length = psi_timestamp_format_precision(&buf, buf.count, &ts, Int32(fields[4])!)
+                
+                if fields.count == 6 {
+                    XCTAssert(length == fields[5].utf8.count && String(cString: buf) == fields[5],
+                              "'\(String(cString: buf))' is not equal to '\(fields[5])'")
+                } else {
+                    XCTAssert(length == 0, "\(fields[1...4]) is formatted")
+                }
+                
+            case ("compare", 3), ("compare", 4):
+                var result: Int32 = 0
+                let compared = psi_timestamp_compare_str(fields[1], fields[1].utf8.count,
+                                                         fields[2], fields[2].utf8.count,
+                                                         &result)
+                
+                guard fields.count == 4 else {
+                    XCTAssert(compared != 0, "'\(fields[1])' is compared to '\(fields[2])'")
+                    break
+                }
+                
+                XCTAssert(compared == 0 && result == Int32(fields[3])!,
+                          "'\(fields[1])' compared as a string to '\(fields[2])' is not \(fields[3])")
+                
+                var ts1 = psi_timestamp_t()
+                var ts2 = psi_timestamp_t()
+                XCTAssert(psi_timestamp_parse(fields[1], fields[1].utf8.count, &ts1) == 0)
+                XCTAssert(psi_timestamp_parse(fields[2], fields[2].utf8.count, &ts2) == 0)
+                XCTAssert(psi_timestamp_compare(&ts1, &ts2).signum() == Int32(fields[3])!,
+                          "'\(fields[1])' compared to '\(fields[2])' is not \(fields[3])")
+                
+            default:
+                XCTFail("malformed vector '\(line)'")
+            }
+        }
+        
+    }
 
 }
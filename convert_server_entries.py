@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (c) 2026, Psiphon Inc.
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+Converts an embedded server entries file from the hex line format to the
+binary container format read by `binary_entries_iterator_next` in
+`Psiphon/EmbeddedServerEntriesHelpers.h`.
+
+Layout:
+
+    char[4]  magic "PSEB"
+    uint32   version (little-endian)
+    uint32   entry count (little-endian)
+    For each entry:
+        varint   length of entry (unsigned LEB128)
+        bytes    hex decoded server entry
+"""
+
+import argparse
+import struct
+import sys
+
+BINARY_MAGIC = b'PSEB'
+BINARY_VERSION = 1
+
+
+def encode_varint(n):
+    out = bytearray()
+    while True:
+        b = n & 0x7f
+        n >>= 7
+        if n:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def convert(data):
+    entries = []
+    for line_number, line in enumerate(data.split(b'\n'), start=1):
+        line = line.rstrip(b'\r')
+        if not line:
+            continue
+        try:
+            entries.append(bytes.fromhex(line.decode('ascii')))
+        except ValueError as e:
+            raise ValueError('line {}: {}'.format(line_number, e))
+
+    out = bytearray(struct.pack('<4sII', BINARY_MAGIC, BINARY_VERSION, len(entries)))
+    for entry in entries:
+        out += encode_varint(len(entry))
+        out += entry
+
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Convert an embedded server entries file from the hex line format to the binary format.')
+    parser.add_argument('source', help='Path to embedded server entries file in the hex line format.')
+    parser.add_argument('output', help='Path to write the binary format file to.')
+    args = parser.parse_args()
+
+    with open(args.source, 'rb') as f:
+        data = f.read()
+
+    try:
+        converted = convert(data)
+    except ValueError as e:
+        print('error: failed to convert {}: {}'.format(args.source, e), file=sys.stderr)
+        return 1
+
+    with open(args.output, 'wb') as f:
+        f.write(converted)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
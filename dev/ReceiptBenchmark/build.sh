@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+
+# Builds the receipt parsing benchmark. See README.md.
+
+set -euo pipefail
+
+cd "$(dirname "$0")"
+
+PSIPHON_DIR=../../Psiphon
+ASN1C_DIR=${PSIPHON_DIR}/asn1c
+TIMESTAMP_DIR=../../Utilities/Sources/c-timestamp
+OUTPUT=${OUTPUT:-./receipt_benchmark}
+CC=${CC:-cc}
+
+CFLAGS=(-O2 -std=gnu11 -D_DEFAULT_SOURCE -I"${PSIPHON_DIR}" -I"${ASN1C_DIR}" -I"${TIMESTAMP_DIR}/include")
+LDFLAGS=()
+
+# Benchmark and app sources. App sources use #import.
+WARNINGS=(-Wall -Wextra -Wno-deprecated)
+
+OBJ_DIR=$(mktemp -d)
+trap 'rm -rf "${OBJ_DIR}"' EXIT
+
+# Compiles sources into objects in a directory of their own.
+# Usage: compile_objects <directory> <flags...> -- <sources...>
+compile_objects() {
+    local dir=$1
+    shift
+    local flags=()
+    while [ "$1" != "--" ]; do
+        flags+=("$1")
+        shift
+    done
+    shift
+
+    mkdir -p "${dir}"
+    for source in "$@"; do
+        "${CC}" "${flags[@]}" -c -o "${dir}/$(basename "${source%.c}").o" "${source}"
+    done
+}
+
+# Allocations and heap usage are measured by wrapping the allocator, which requires GNU ld.
+if [ "$(uname -s)" = "Linux" ]; then
+    CFLAGS+=(-DBENCH_COUNT_ALLOCATIONS)
+    LDFLAGS+=(-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free)
+fi
+
+# asn1c sources are compiled as they are in the app, with warnings silenced. c-timestamp is compiled
+# as it is by the timestamp benchmark.
+compile_objects "${OBJ_DIR}/benchmark/asn1c" "${CFLAGS[@]}" -w -- "${ASN1C_DIR}"/*.c
+compile_objects "${OBJ_DIR}/benchmark/c-timestamp" "${CFLAGS[@]}" -Wall -- "${TIMESTAMP_DIR}"/*.c
+
+"${CC}" "${CFLAGS[@]}" "${WARNINGS[@]}" -o "${OUTPUT}" \
+    main.c \
+    receipt_generator.c \
+    "${PSIPHON_DIR}"/AppStoreReceiptHelpers.c \
+    "${OBJ_DIR}"/benchmark/*/*.o \
+    ${LDFLAGS[@]+"${LDFLAGS[@]}"}
+
+echo "Built ${OUTPUT}"
+
+# Differential test of the generated decoders, built with the sanitizers where available.
+TEST_OUTPUT=${TEST_OUTPUT:-./receipt_decoders_test}
+TEST_CFLAGS=(-O1 -g -std=gnu11 -D_DEFAULT_SOURCE -I"${PSIPHON_DIR}" -I"${ASN1C_DIR}")
+if "${CC}" -fsanitize=address -x c -o /dev/null - <<< 'int main(void) { return 0; }' 2>/dev/null; then
+    TEST_CFLAGS+=(-fsanitize=address)
+fi
+
+compile_objects "${OBJ_DIR}/test/asn1c" "${TEST_CFLAGS[@]}" -w -- "${ASN1C_DIR}"/*.c
+
+"${CC}" "${TEST_CFLAGS[@]}" "${WARNINGS[@]}" -o "${TEST_OUTPUT}" \
+    decoders_test.c \
+    receipt_generator.c \
+    "${PSIPHON_DIR}"/AppStoreReceiptHelpers.c \
+    "${OBJ_DIR}"/test/asn1c/*.o
+
+echo "Built ${TEST_OUTPUT}"
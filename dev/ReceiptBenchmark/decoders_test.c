@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Differential test of the generated decoders in Psiphon/asn1c/receipt_decoders.c against the generic
+// asn1c decoders. See README.md.
+//
+// Receipts are generated in the DER and BER encodings that the generated decoders handle themselves,
+// then mutated at random. For every input both decoders must return the same code, consume the same
+// number of bytes and, on success, decode identical structures.
+//
+// The SignedData inputs are also scanned with `receipt_pkcs7_content` from Psiphon/AppStoreReceiptHelpers.c.
+// Where both succeed, the content it locates must be identical to the decoded content.
+
+#include "receipt_generator.h"
+#include "receipt_decoders.h"
+#include "AppStoreReceiptHelpers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_CASES 20000
+#define DEFAULT_SEED 1
+
+/// splitmix64.
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*** ENCODING ***/
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+} buffer;
+
+static void append(buffer *b, const void *p, size_t len) {
+    if (b->len + len > b->cap) {
+        b->cap = (b->len + len) * 2;
+        b->buf = realloc(b->buf, b->cap);
+        if (b->buf == NULL) {
+            abort();
+        }
+    }
+    memcpy(b->buf + b->len, p, len);
+    b->len += len;
+}
+
+static void append_byte(buffer *b, uint8_t byte) {
+    append(b, &byte, 1);
+}
+
+/// Appends a definite length, in the shortest form or, if `long_form`, with a redundant length octet.
+static void append_length(buffer *b, size_t len, int long_form) {
+    uint8_t octets[sizeof(size_t)];
+    int n = 0;
+    for (size_t l = len; l > 0; l >>= 8) {
+        octets[n++] = (uint8_t)l;
+    }
+    if (len < 0x80 && !long_form) {
+        append_byte(b, (uint8_t)len);
+        return;
+    }
+    if (long_form) {
+        octets[n++] = 0;
+    }
+    append_byte(b, (uint8_t)(0x80 | n));
+    while (n > 0) {
+        append_byte(b, octets[--n]);
+    }
+}
+
+/// Appends a TLV with a definite length.
+static void append_tlv(buffer *b, uint8_t tag, const uint8_t *value, size_t len, int long_form) {
+    append_byte(b, tag);
+    append_length(b, len, long_form);
+    append(b, value, len);
+}
+
+static const uint8_t oid_signed_data[] = {0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02};
+static const uint8_t oid_data[] = {0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x01};
+static const uint8_t version[] = {0x02, 0x01, 0x01};
+static const uint8_t digest_algorithms[] = {0x31, 0x0B, 0x30, 0x09, 0x06, 0x05, 0x2B, 0x0E, 0x03, 0x02, 0x1A, 0x05, 0x00};
+static const uint8_t certificates[] = {0xA0, 0x06, 0x30, 0x04, 0x02, 0x02, 0x01, 0x00};
+static const uint8_t signer_infos[] = {0x31, 0x05, 0x30, 0x03, 0x02, 0x01, 0x01};
+
+typedef enum {
+    /// DER, as produced by the asn1c encoder.
+    ENCODING_DER,
+    /// DER, but with redundant long form lengths.
+    ENCODING_DER_LONG_LENGTHS,
+    /// Definite lengths, with the content split into segments of a constructed OCTET STRING.
+    ENCODING_DEFINITE_SEGMENTED,
+    /// Indefinite lengths, as App Store receipts are encoded.
+    ENCODING_INDEFINITE,
+    ENCODING_COUNT
+} encoding;
+
+/// Wraps `payload` in a PKCS#7 SignedData with certificates and signer infos.
+static void encode_signed_data(buffer *out, const uint8_t *payload, size_t payload_len, encoding enc,
+                               size_t segment_len) {
+    const int long_form = (enc == ENCODING_DER_LONG_LENGTHS);
+    buffer content_data = {0};
+    buffer content_info = {0};
+    buffer content = {0};
+    buffer signed_data = {0};
+
+    if (enc == ENCODING_INDEFINITE) {
+        // [0] { OCTET STRING (constructed) { segments } }
+        append(&content_data, "\xA0\x80\x24\x80", 4);
+        for (size_t off = 0; off < payload_len; off += segment_len) {
+            size_t len = (payload_len - off < segment_len) ? payload_len - off : segment_len;
+            append_tlv(&content_data, 0x04, payload + off, len, 0);
+        }
+        append(&content_data, "\0\0\0\0", 4);
+
+        append(out, "\x30\x80", 2);
+        append(out, oid_signed_data, sizeof(oid_signed_data));
+        append(out, "\xA0\x80\x30\x80", 4);
+        append(out, version, sizeof(version));
+        append(out, digest_algorithms, sizeof(digest_algorithms));
+        append(out, "\x30\x80", 2);
+        append(out, oid_data, sizeof(oid_data));
+        append(out, content_data.buf, content_data.len);
+        append(out, "\0\0", 2);
+        append(out, certificates, sizeof(certificates));
+        append(out, signer_infos, sizeof(signer_infos));
+        append(out, "\0\0\0\0\0\0", 6);
+        free(content_data.buf);
+        return;
+    }
+
+    if (enc == ENCODING_DEFINITE_SEGMENTED) {
+        buffer segments = {0};
+        for (size_t off = 0; off < payload_len; off += segment_len) {
+            size_t len = (payload_len - off < segment_len) ? payload_len - off : segment_len;
+            append_tlv(&segments, 0x04, payload + off, len, 0);
+        }
+        buffer octet_string = {0};
+        append_tlv(&octet_string, 0x24, segments.buf, segments.len, 0);
+        append_tlv(&content_data, 0xA0, octet_string.buf, octet_string.len, 0);
+        free(segments.buf);
+        free(octet_string.buf);
+    } else {
+        buffer octet_string = {0};
+        append_tlv(&octet_string, 0x04, payload, payload_len, long_form);
+        append_tlv(&content_data, 0xA0, octet_string.buf, octet_string.len, long_form);
+        free(octet_string.buf);
+    }
+
+    append(&content_info, oid_data, sizeof(oid_data));
+    append(&content_info, content_data.buf, content_data.len);
+
+    append(&content, version, sizeof(version));
+    append(&content, digest_algorithms, sizeof(digest_algorithms));
+    append_tlv(&content, 0x30, content_info.buf, content_info.len, long_form);
+    append(&content, certificates, sizeof(certificates));
+    append(&content, signer_infos, sizeof(signer_infos));
+
+    buffer content_sequence = {0};
+    append_tlv(&content_sequence, 0x30, content.buf, content.len, long_form);
+
+    append(&signed_data, oid_signed_data, sizeof(oid_signed_data));
+    append_tlv(&signed_data, 0xA0, content_sequence.buf, content_sequence.len, long_form);
+    append_tlv(out, 0x30, signed_data.buf, signed_data.len, long_form);
+
+    free(content_data.buf);
+    free(content_info.buf);
+    free(content.buf);
+    free(content_sequence.buf);
+    free(signed_data.buf);
+}
+
+/*** COMPARISON ***/
+
+static int same_bytes(const uint8_t *a, int a_size, const uint8_t *b, int b_size) {
+    if (a_size != b_size || (a == NULL) != (b == NULL)) {
+        return 0;
+    }
+    return a_size == 0 || memcmp(a, b, (size_t)a_size) == 0;
+}
+
+static int same_receipt_attribute(const ReceiptAttribute_t *a, const ReceiptAttribute_t *b) {
+    return a->type == b->type && a->version == b->version &&
+           same_bytes(a->value.buf, a->value.size, b->value.buf, b->value.size);
+}
+
+static int same_receipt_attributes(const ReceiptAttributes_t *a, const ReceiptAttributes_t *b) {
+    if (a->list.count != b->list.count) {
+        return 0;
+    }
+    for (int i = 0; i < a->list.count; i++) {
+        if (!same_receipt_attribute(a->list.array[i], b->list.array[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int same_signed_data(const SignedData_t *a, const SignedData_t *b) {
+    const struct content *ac = &a->content;
+    const struct content *bc = &b->content;
+    return same_bytes(a->contentType.buf, a->contentType.size, b->contentType.buf, b->contentType.size) &&
+           ac->version == bc->version &&
+           same_bytes(ac->digestAlgorithms.buf, ac->digestAlgorithms.size,
+                      bc->digestAlgorithms.buf, bc->digestAlgorithms.size) &&
+           same_bytes(ac->contentInfo.contentType.buf, ac->contentInfo.contentType.size,
+                      bc->contentInfo.contentType.buf, bc->contentInfo.contentType.size) &&
+           same_bytes(ac->contentInfo.contentData.buf, ac->contentInfo.contentData.size,
+                      bc->contentInfo.contentData.buf, bc->contentInfo.contentData.size);
+}
+
+typedef struct {
+    unsigned long cases;
+    unsigned long decoded;
+    unsigned long mismatches;
+    /// SignedData inputs decoded by ber_decode whose content was located by the scan.
+    unsigned long scanned;
+} results;
+
+static void report_mismatch(results *r, const char *type, const uint8_t *input, size_t len,
+                            asn_dec_rval_t generic, asn_dec_rval_t fast) {
+    r->mismatches++;
+    if (r->mismatches > 10) {
+        return;
+    }
+    fprintf(stderr, "%s mismatch: generic %d/%zd, generated %d/%zd, input (%zu bytes):", type,
+            generic.code, generic.consumed, fast.code, fast.consumed, len);
+    for (size_t i = 0; i < len && i < 64; i++) {
+        fprintf(stderr, " %02x", input[i]);
+    }
+    fprintf(stderr, "%s\n", len > 64 ? " ..." : "");
+}
+
+#define DIFFERENTIAL(TYPE, SAME)                                                                    \
+    static void differential_##TYPE(results *r, const uint8_t *input, size_t len) {              \
+        TYPE##_t *generic = NULL;                                                                   \
+        TYPE##_t *fast = NULL;                                                                      \
+        asn_dec_rval_t generic_rval = ber_decode(0, &asn_DEF_##TYPE, (void **)&generic, input, len); \
+        asn_dec_rval_t fast_rval = TYPE##_decode_fast(0, &fast, input, len);                        \
+        r->cases++;                                                                                 \
+        if (generic_rval.code != fast_rval.code ||                                                  \
+            (generic_rval.code == RC_OK &&                                                          \
+             (generic_rval.consumed != fast_rval.consumed || !SAME(generic, fast)))) {              \
+            report_mismatch(r, #TYPE, input, len, generic_rval, fast_rval);                          \
+        } else if (generic_rval.code == RC_OK) {                                                    \
+            r->decoded++;                                                                           \
+        }                                                                                           \
+        ASN_STRUCT_FREE(asn_DEF_##TYPE, generic);                                                   \
+        ASN_STRUCT_FREE(asn_DEF_##TYPE, fast);                                                      \
+    }
+
+DIFFERENTIAL(SignedData, same_signed_data)
+
+/// Compares the content located by `receipt_pkcs7_content` with the content decoded by ber_decode.
+/// The scan does not read past the content, so it may succeed where ber_decode fails; and it leaves
+/// encodings it does not handle to the full decode, so it may fail where ber_decode succeeds.
+static void differential_content_scan(results *r, const uint8_t *input, size_t len) {
+    SignedData_t *generic = NULL;
+    asn_dec_rval_t rval = ber_decode(0, &asn_DEF_SignedData, (void **)&generic, input, len);
+
+    const uint8_t *content = NULL;
+    size_t content_len = 0;
+    receipt_content_result scan = receipt_pkcs7_content(input, len, &content, &content_len);
+
+    if (rval.code == RC_OK && scan == RECEIPT_CONTENT_OK) {
+        const OCTET_STRING_t *data = &generic->content.contentInfo.contentData;
+        if (!same_bytes(data->buf, data->size, content, (int)content_len)) {
+            asn_dec_rval_t scan_rval = {RC_OK, (ssize_t)content_len};
+            report_mismatch(r, "Content scan", input, len, rval, scan_rval);
+        } else {
+            r->scanned++;
+        }
+    }
+
+    ASN_STRUCT_FREE(asn_DEF_SignedData, generic);
+}
+DIFFERENTIAL(ReceiptAttributes, same_receipt_attributes)
+DIFFERENTIAL(ReceiptAttribute, same_receipt_attribute)
+
+/*** MUTATION ***/
+
+/// Applies a random mutation to `b` which tends to keep it close to a valid encoding.
+static void mutate(buffer *b, uint64_t *state) {
+    if (b->len == 0) {
+        return;
+    }
+    size_t at = next_random(state) % b->len;
+    switch (next_random(state) % 7) {
+        case 0: // Flip a bit
+            b->buf[at] ^= (uint8_t)(1 << (next_random(state) % 8));
+            break;
+        case 1: // Nudge a byte, e.g. a length
+            b->buf[at] += (next_random(state) & 1) ? 1 : -1;
+            break;
+        case 2: // Interesting byte
+        {
+            static const uint8_t interesting[] = {0x00, 0x80, 0x81, 0x82, 0xFF, 0x04, 0x24, 0x30, 0xA0, 0x1F};
+            b->buf[at] = interesting[next_random(state) % sizeof(interesting)];
+            break;
+        }
+        case 3: // Truncate
+            b->len = at;
+            break;
+        case 4: // Insert end-of-contents octets
+            append(b, "\0\0", 2);
+            memmove(b->buf + at + 2, b->buf + at, b->len - at - 2);
+            b->buf[at] = 0;
+            b->buf[at + 1] = 0;
+            break;
+        case 5: // Delete a byte
+            memmove(b->buf + at, b->buf + at + 1, b->len - at - 1);
+            b->len--;
+            break;
+        case 6: // Duplicate a run of bytes
+        {
+            size_t run = 1 + next_random(state) % 8;
+            if (at + run > b->len) {
+                run = b->len - at;
+            }
+            uint8_t tmp[8];
+            memcpy(tmp, b->buf + at, run);
+            append(b, tmp, run);
+            memmove(b->buf + at + run, b->buf + at, b->len - at - run);
+            memcpy(b->buf + at, tmp, run);
+            break;
+        }
+    }
+}
+
+/*** MAIN ***/
+
+int main(int argc, char *argv[]) {
+    unsigned long cases = DEFAULT_CASES;
+    uint64_t seed = DEFAULT_SEED;
+
+    if (argc > 1) {
+        cases = strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        seed = strtoull(argv[2], NULL, 10);
+    }
+
+    results r = {0};
+    uint64_t state = seed;
+
+    for (unsigned long i = 0; i < cases; i++) {
+        uint8_t *payload;
+        size_t payload_len;
+        size_t num_iaps = next_random(&state) % 4;
+        if (generate_receipt_payload(num_iaps, next_random(&state), &payload, &payload_len) != 0) {
+            fprintf(stderr, "failed to generate receipt\n");
+            return 1;
+        }
+
+        encoding enc = (encoding)(next_random(&state) % ENCODING_COUNT);
+        size_t segment_len = 1 + next_random(&state) % (payload_len + 1);
+        buffer signed_data = {0};
+        encode_signed_data(&signed_data, payload, payload_len, enc, segment_len);
+
+        buffer attributes = {0};
+        append(&attributes, payload, payload_len);
+
+        // Unmutated inputs first, so that each is also checked once as generated.
+        int mutations = (i % 4 == 0) ? 0 : 1 + (int)(next_random(&state) % 3);
+        for (int m = 0; m < mutations; m++) {
+            mutate(&signed_data, &state);
+            mutate(&attributes, &state);
+        }
+
+        differential_SignedData(&r, signed_data.buf, signed_data.len);
+        differential_content_scan(&r, signed_data.buf, signed_data.len);
+        differential_ReceiptAttributes(&r, attributes.buf, attributes.len);
+
+        // Each attribute of the set on its own.
+        const uint8_t *p = payload;
+        const uint8_t *end = payload + payload_len;
+        if (payload_len > 4 && (p[1] & 0x80)) {
+            p += 2 + (p[1] & 0x7F);
+        } else {
+            p += 2;
+        }
+        while (p < end) {
+            ReceiptAttribute_t *attribute = NULL;
+            asn_dec_rval_t rval = ber_decode(0, &asn_DEF_ReceiptAttribute, (void **)&attribute, p, end - p);
+            ASN_STRUCT_FREE(asn_DEF_ReceiptAttribute, attribute);
+            if (rval.code != RC_OK) {
+                break;
+            }
+            buffer element = {0};
+            append(&element, p, rval.consumed);
+            if (mutations > 0) {
+                mutate(&element, &state);
+            }
+            differential_ReceiptAttribute(&r, element.buf, element.len);
+            free(element.buf);
+            p += rval.consumed;
+        }
+
+        free(payload);
+        free(signed_data.buf);
+        free(attributes.buf);
+    }
+
+    printf("%lu cases, %lu decoded, %lu mismatches, %lu contents scanned\n", r.cases, r.decoded, r.mismatches,
+           r.scanned);
+
+    return r.mismatches == 0 ? 0 : 1;
+}
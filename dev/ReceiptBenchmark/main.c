@@ -0,0 +1,576 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Standalone benchmark of App Store receipt parsing with the asn1c runtime in Psiphon/asn1c. See README.md.
+
+#include "receipt_generator.h"
+#include "AppStoreReceiptHelpers.h"
+#include "IA5String.h"
+#include "INTEGER.h"
+#include "ReceiptAttributes.h"
+#include "SignedData.h"
+#include "UTF8String.h"
+#include "receipt_decoders.h"
+#include "asn_arena.h"
+#include "timestamp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 5
+#define DEFAULT_SEED 1
+
+// Receipt field types read by AppStoreParsedReceiptData.m.
+#define RECEIPT_TYPE_BUNDLE_IDENTIFIER 2
+#define RECEIPT_TYPE_IN_APP_PURCHASE_RECEIPT 17
+#define RECEIPT_TYPE_ORIGINAL_APPLICATION_VERSION 19
+#define RECEIPT_TYPE_PRODUCT_IDENTIFIER 1702
+#define RECEIPT_TYPE_TRANSACTION_ID 1703
+#define RECEIPT_TYPE_PURCHASE_DATE 1704
+#define RECEIPT_TYPE_ORIGINAL_TRANSACTION_ID 1705
+#define RECEIPT_TYPE_SUBSCRIPTION_EXPIRATION_DATE 1708
+#define RECEIPT_TYPE_WEB_ORDER_LINE_ITEM_ID 1711
+#define RECEIPT_TYPE_CANCELLATION_DATE 1712
+#define RECEIPT_TYPE_IS_IN_INTRO_OFFER_PERIOD 1719
+
+/*** ALLOCATION COUNTING ***/
+
+// Allocations are counted by linking with `-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free`,
+// see build.sh. Only allocations made by code compiled into the benchmark are counted. The heap bytes
+// allocated are tracked with `malloc_usable_size`, so that the peak of each stage can be reported.
+
+static unsigned long allocations;
+static long heap_bytes;
+static long peak_heap_bytes;
+
+#if defined(BENCH_COUNT_ALLOCATIONS)
+
+#include <malloc.h>
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *p, size_t size);
+void __real_free(void *p);
+
+static void *track_allocation(void *p) {
+    if (p != NULL) {
+        heap_bytes += (long)malloc_usable_size(p);
+        if (heap_bytes > peak_heap_bytes) {
+            peak_heap_bytes = heap_bytes;
+        }
+    }
+    return p;
+}
+
+void *__wrap_malloc(size_t size) {
+    allocations++;
+    return track_allocation(__real_malloc(size));
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return track_allocation(__real_calloc(count, size));
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+    allocations++;
+    long previous = (p != NULL) ? (long)malloc_usable_size(p) : 0;
+    void *q = __real_realloc(p, size);
+    if (q == NULL) {
+        return NULL;
+    }
+    heap_bytes -= previous;
+    return track_allocation(q);
+}
+
+void __wrap_free(void *p) {
+    if (p != NULL) {
+        heap_bytes -= (long)malloc_usable_size(p);
+    }
+    __real_free(p);
+}
+
+#endif
+
+/*** MEASUREMENT ***/
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// Peak resident set size of the process in KiB.
+static long peak_rss_kib(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024; // Bytes on macOS.
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+typedef struct {
+    /// PKCS#7 SignedData, as read from the app's receipt URL.
+    const uint8_t *signed_data;
+    size_t signed_data_len;
+    /// The receipt attributes in the content of `signed_data`.
+    const uint8_t *payload;
+    size_t payload_len;
+    size_t num_iaps;
+} receipt;
+
+/// A benchmarked stage. Returns the number of in-app purchase receipts decoded, or -1 on failure.
+typedef long (*stage_fn)(const receipt *r);
+
+/// Decoder of `ReceiptAttributes` with the signature of the generated decoders.
+typedef asn_dec_rval_t (*decode_fn)(asn_codec_ctx_t *opt_codec_ctx, ReceiptAttributes_t **attributes,
+                                    const void *buffer, size_t size);
+
+static asn_dec_rval_t generic_decode(asn_codec_ctx_t *opt_codec_ctx, ReceiptAttributes_t **attributes,
+                                     const void *buffer, size_t size) {
+    return ber_decode(opt_codec_ctx, &asn_DEF_ReceiptAttributes, (void **)attributes, buffer, size);
+}
+
+/// Decodes the payload and every in-app purchase receipt with `decode`. Structures are freed with
+/// `ASN_STRUCT_FREE`, unless `arena` is set in which case they are allocated from arenas that are each freed at once:
+/// one for the payload, and one for each in-app purchase receipt.
+static long decode_receipt(const receipt *r, decode_fn decode, int arena) {
+    asn_arena_t a;
+    asn_arena_t *previous = NULL;
+    if (arena) {
+        asn_arena_init(&a, 0);
+        previous = asn_arena_set_current(&a);
+    }
+
+    ReceiptAttributes_t *attributes = NULL;
+    long iaps = 0;
+
+    asn_dec_rval_t rval = decode(0, &attributes, r->payload, r->payload_len);
+    if (rval.code != RC_OK) {
+        iaps = -1;
+    }
+
+    for (int i = 0; iaps >= 0 && i < attributes->list.count; i++) {
+        ReceiptAttribute_t *attribute = attributes->list.array[i];
+        if (attribute->type != RECEIPT_TYPE_IN_APP_PURCHASE_RECEIPT) {
+            continue;
+        }
+        // Each in-app purchase receipt is released before the next is decoded,
+        // into its own arena if `arena` is set.
+        asn_arena_t iap_arena;
+        if (arena) {
+            asn_arena_init(&iap_arena, 0);
+            asn_arena_set_current(&iap_arena);
+        }
+        ReceiptAttributes_t *iap = NULL;
+        rval = decode(0, &iap, attribute->value.buf, attribute->value.size);
+        iaps = (rval.code == RC_OK) ? iaps + 1 : -1;
+        if (arena) {
+            asn_arena_set_current(&a);
+            asn_arena_destroy(&iap_arena);
+        } else {
+            ASN_STRUCT_FREE(asn_DEF_ReceiptAttributes, iap);
+        }
+    }
+
+    if (arena) {
+        asn_arena_set_current(previous);
+        asn_arena_destroy(&a);
+    } else {
+        ASN_STRUCT_FREE(asn_DEF_ReceiptAttributes, attributes);
+    }
+
+    return iaps;
+}
+
+/// As `AppStoreParsedReceiptData` did before the DER iterator.
+static long stage_ber_decode(const receipt *r) {
+    return decode_receipt(r, generic_decode, 0);
+}
+
+static long stage_ber_decode_arena(const receipt *r) {
+    return decode_receipt(r, generic_decode, 1);
+}
+
+/// With the decoders generated by gen_asn1_decoders.py.
+static long stage_decode_fast(const receipt *r) {
+    return decode_receipt(r, ReceiptAttributes_decode_fast, 0);
+}
+
+static long stage_decode_fast_arena(const receipt *r) {
+    return decode_receipt(r, ReceiptAttributes_decode_fast, 1);
+}
+
+/// The fallback of `AppStoreParsedReceiptData` when the content cannot be located in place: decoding the
+/// SignedData with `SignedData_decode_fast` and freeing it, with `ASN_STRUCT_FREE` or at once from an arena.
+static long decode_signed_data(const receipt *r, int arena) {
+    asn_arena_t a;
+    asn_arena_t *previous = NULL;
+    if (arena) {
+        asn_arena_init(&a, 0);
+        previous = asn_arena_set_current(&a);
+    }
+
+    SignedData_t *signed_data = NULL;
+    asn_dec_rval_t rval = SignedData_decode_fast(0, &signed_data, r->signed_data, r->signed_data_len);
+
+    if (arena) {
+        asn_arena_set_current(previous);
+        asn_arena_destroy(&a);
+    } else {
+        ASN_STRUCT_FREE(asn_DEF_SignedData, signed_data);
+    }
+
+    return (rval.code == RC_OK) ? (long)r->num_iaps : -1;
+}
+
+static long stage_signed_data(const receipt *r) {
+    return decode_signed_data(r, 0);
+}
+
+static long stage_signed_data_arena(const receipt *r) {
+    return decode_signed_data(r, 1);
+}
+
+/*** FULL PARSE ***/
+
+// The fields that AppStoreParsedReceiptData.m reads, and how their values are encoded.
+typedef enum {
+    FIELD_NONE,
+    FIELD_UTF8_STRING,
+    FIELD_DATE,
+    FIELD_INTEGER,
+} field_kind;
+
+static field_kind receipt_field_kind(long type) {
+    switch (type) {
+        case RECEIPT_TYPE_BUNDLE_IDENTIFIER:
+        case RECEIPT_TYPE_ORIGINAL_APPLICATION_VERSION:
+            return FIELD_UTF8_STRING;
+        default:
+            return FIELD_NONE;
+    }
+}
+
+static field_kind iap_field_kind(long type) {
+    switch (type) {
+        case RECEIPT_TYPE_PRODUCT_IDENTIFIER:
+        case RECEIPT_TYPE_TRANSACTION_ID:
+        case RECEIPT_TYPE_ORIGINAL_TRANSACTION_ID:
+            return FIELD_UTF8_STRING;
+        case RECEIPT_TYPE_PURCHASE_DATE:
+        case RECEIPT_TYPE_SUBSCRIPTION_EXPIRATION_DATE:
+        case RECEIPT_TYPE_CANCELLATION_DATE:
+            return FIELD_DATE;
+        case RECEIPT_TYPE_WEB_ORDER_LINE_ITEM_ID:
+        case RECEIPT_TYPE_IS_IN_INTRO_OFFER_PERIOD:
+            return FIELD_INTEGER;
+        default:
+            return FIELD_NONE;
+    }
+}
+
+/// Decodes a field value with `ber_decode`, as `AppStoreParsedReceiptData` did before the DER iterator.
+/// Empty values, such as the cancellation date of a transaction that was not cancelled, are skipped.
+static int decode_field_ber(field_kind kind, const uint8_t *value, size_t len) {
+    if (kind == FIELD_NONE || len == 0) {
+        return 0;
+    }
+
+    int ret = 0;
+    if (kind == FIELD_UTF8_STRING) {
+        UTF8String_t *string = NULL;
+        asn_dec_rval_t rval = ber_decode(0, &asn_DEF_UTF8String, (void **)&string, value, len);
+        ret = (rval.code == RC_OK) ? 0 : -1;
+        ASN_STRUCT_FREE(asn_DEF_UTF8String, string);
+    } else if (kind == FIELD_DATE) {
+        IA5String_t *string = NULL;
+        psi_timestamp_t ts;
+        asn_dec_rval_t rval = ber_decode(0, &asn_DEF_IA5String, (void **)&string, value, len);
+        ret = (rval.code == RC_OK && psi_timestamp_parse((const char *)string->buf, string->size, &ts) == 0) ? 0 : -1;
+        ASN_STRUCT_FREE(asn_DEF_IA5String, string);
+    } else {
+        INTEGER_t *integer = NULL;
+        long l;
+        asn_dec_rval_t rval = ber_decode(0, &asn_DEF_INTEGER, (void **)&integer, value, len);
+        ret = (rval.code == RC_OK && asn_INTEGER2long(integer, &l) == 0) ? 0 : -1;
+        ASN_STRUCT_FREE(asn_DEF_INTEGER, integer);
+    }
+    return ret;
+}
+
+/// Decodes a field value in place, as the `ASN1Read` functions of `AppStoreParsedReceiptData.m` do.
+static int decode_field_der(field_kind kind, const uint8_t *value, size_t len) {
+    if (kind == FIELD_NONE || len == 0) {
+        return 0;
+    }
+
+    static const uint8_t tags[] = {
+        [FIELD_UTF8_STRING] = DER_TAG_UTF8_STRING,
+        [FIELD_DATE] = DER_TAG_IA5_STRING,
+        [FIELD_INTEGER] = DER_TAG_INTEGER,
+    };
+    der_tlv tlv;
+    const uint8_t *p = value;
+    if (der_read_tlv(&p, value + len, &tlv) != 0 || tlv.tag != tags[kind]) {
+        return -1;
+    }
+
+    if (kind == FIELD_DATE) {
+        psi_timestamp_t ts;
+        return psi_timestamp_parse((const char *)tlv.value, tlv.len, &ts);
+    } else if (kind == FIELD_INTEGER) {
+        long l;
+        return der_integer_value(tlv.value, tlv.len, &l);
+    }
+    return 0;
+}
+
+/// The parse of `AppStoreParsedReceiptData` before the DER iterator: the SignedData, the payload and every
+/// in-app purchase receipt are decoded with `ber_decode`, and then each field value with `decode_field_ber`.
+static long stage_full_parse_ber_decode(const receipt *r) {
+    SignedData_t *signed_data = NULL;
+    ReceiptAttributes_t *attributes = NULL;
+    long iaps = 0;
+
+    asn_dec_rval_t rval = ber_decode(0, &asn_DEF_SignedData, (void **)&signed_data, r->signed_data,
+                                     r->signed_data_len);
+    if (rval.code != RC_OK) {
+        iaps = -1;
+    } else {
+        OCTET_STRING_t *content = &signed_data->content.contentInfo.contentData;
+        rval = ber_decode(0, &asn_DEF_ReceiptAttributes, (void **)&attributes, content->buf, content->size);
+        iaps = (rval.code == RC_OK) ? 0 : -1;
+    }
+
+    for (int i = 0; iaps >= 0 && i < attributes->list.count; i++) {
+        ReceiptAttribute_t *attribute = attributes->list.array[i];
+        if (attribute->type != RECEIPT_TYPE_IN_APP_PURCHASE_RECEIPT) {
+            if (decode_field_ber(receipt_field_kind(attribute->type), attribute->value.buf,
+                                 attribute->value.size) != 0) {
+                iaps = -1;
+            }
+            continue;
+        }
+
+        ReceiptAttributes_t *iap = NULL;
+        rval = ber_decode(0, &asn_DEF_ReceiptAttributes, (void **)&iap, attribute->value.buf,
+                          attribute->value.size);
+        iaps = (rval.code == RC_OK) ? iaps + 1 : -1;
+        for (int j = 0; iaps >= 0 && j < iap->list.count; j++) {
+            ReceiptAttribute_t *field = iap->list.array[j];
+            if (decode_field_ber(iap_field_kind(field->type), field->value.buf, field->value.size) != 0) {
+                iaps = -1;
+            }
+        }
+        ASN_STRUCT_FREE(asn_DEF_ReceiptAttributes, iap);
+    }
+
+    ASN_STRUCT_FREE(asn_DEF_ReceiptAttributes, attributes);
+    ASN_STRUCT_FREE(asn_DEF_SignedData, signed_data);
+    return iaps;
+}
+
+/// Enumerates the receipt attributes of `data` as `enumerateReceiptAttributes` does: the SET is validated
+/// and then iterated. Each attribute is passed to `fn`, which returns -1 to stop the enumeration.
+static long enumerate_attributes(const uint8_t *data, size_t len,
+                                 int (*fn)(const receipt_attribute *attr, void *ctx), void *ctx) {
+    if (receipt_attributes_validate(data, len) < 0) {
+        return -1;
+    }
+
+    receipt_attribute_iterator it;
+    receipt_attribute attr;
+    receipt_attribute_iterator_init(&it, data, len);
+    while (receipt_attribute_iterator_next(&it, &attr) == 1) {
+        if (fn(&attr, ctx) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    /// Set to decode field values with `decode_field_der`, otherwise attributes are only enumerated.
+    int decode_fields;
+    long iaps;
+} enumeration;
+
+static int enumerate_iap_field(const receipt_attribute *attr, void *ctx) {
+    enumeration *e = ctx;
+    return e->decode_fields ? decode_field_der(iap_field_kind(attr->type), attr->value, attr->value_len) : 0;
+}
+
+static int enumerate_receipt_field(const receipt_attribute *attr, void *ctx) {
+    enumeration *e = ctx;
+    if (attr->type != RECEIPT_TYPE_IN_APP_PURCHASE_RECEIPT) {
+        return e->decode_fields ? decode_field_der(receipt_field_kind(attr->type), attr->value, attr->value_len) : 0;
+    }
+    if (enumerate_attributes(attr->value, attr->value_len, enumerate_iap_field, e) != 0) {
+        return -1;
+    }
+    e->iaps++;
+    return 0;
+}
+
+/// The parse of `AppStoreParsedReceiptData`: the payload is located with `receipt_pkcs7_content`, and the
+/// receipt and every in-app purchase receipt are enumerated with the DER iterator.
+static long parse_iterator(const receipt *r, int decode_fields) {
+    const uint8_t *content;
+    size_t content_len;
+    if (receipt_pkcs7_content(r->signed_data, r->signed_data_len, &content, &content_len) != RECEIPT_CONTENT_OK) {
+        return -1;
+    }
+
+    enumeration e = {.decode_fields = decode_fields};
+    if (enumerate_attributes(content, content_len, enumerate_receipt_field, &e) != 0) {
+        return -1;
+    }
+    return e.iaps;
+}
+
+static long stage_attribute_enumeration(const receipt *r) {
+    return parse_iterator(r, 0);
+}
+
+static long stage_full_parse_iterator(const receipt *r) {
+    return parse_iterator(r, 1);
+}
+
+static const struct {
+    const char *name;
+    stage_fn fn;
+} stages[] = {
+    {"ber_decode", stage_ber_decode},
+    {"ber_decode (arena)", stage_ber_decode_arena},
+    {"decode_fast", stage_decode_fast},
+    {"decode_fast (arena)", stage_decode_fast_arena},
+    {"SignedData", stage_signed_data},
+    {"SignedData (arena)", stage_signed_data_arena},
+    {"full parse (ber_decode)", stage_full_parse_ber_decode},
+    {"attribute enumeration", stage_attribute_enumeration},
+    {"full parse (iterator)", stage_full_parse_iterator},
+};
+
+/*** MAIN ***/
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-n iaps,...] [-s seed] [-i iterations]\n"
+            "\n"
+            "  -n iaps        Comma separated numbers of in-app purchase receipts (default 1,10,100,1000,5000).\n"
+            "  -s seed        Generator seed (default %d).\n"
+            "  -i iterations  Iterations of each stage; the fastest is reported (default %d).\n",
+            argv0, DEFAULT_SEED, DEFAULT_ITERATIONS);
+}
+
+int main(int argc, char *argv[]) {
+    const char *sizes = "1,10,100,1000,5000";
+    uint64_t seed = DEFAULT_SEED;
+    int iterations = DEFAULT_ITERATIONS;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || value == NULL) {
+            usage(argv[0]);
+            return 2;
+        }
+        switch (arg[1]) {
+            case 'n': sizes = value; break;
+            case 's': seed = strtoull(value, NULL, 10); break;
+            case 'i': iterations = atoi(value); break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+        i++;
+    }
+
+    if (iterations <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+#if !defined(BENCH_COUNT_ALLOCATIONS)
+    printf("allocations and peak heap are not measured on this platform\n");
+#endif
+    printf("%8s %10s  %-28s %10s %12s %12s %12s\n", "iaps", "bytes", "stage", "ms", "iaps/s", "allocations",
+           "peak KiB");
+
+    const char *p = sizes;
+    while (*p != '\0') {
+        char *end;
+        size_t num_iaps = strtoul(p, &end, 10);
+        if (end == p || num_iaps == 0) {
+            usage(argv[0]);
+            return 2;
+        }
+        p = (*end == ',') ? end + 1 : end;
+
+        receipt r = {.num_iaps = num_iaps};
+        uint8_t *signed_data;
+        if (generate_receipt(num_iaps, seed, &signed_data, &r.signed_data_len) != 0 ||
+            receipt_pkcs7_content(signed_data, r.signed_data_len, &r.payload, &r.payload_len) != RECEIPT_CONTENT_OK) {
+            fprintf(stderr, "failed to generate receipt with %zu in-app purchases\n", num_iaps);
+            return 1;
+        }
+        r.signed_data = signed_data;
+
+        for (size_t s = 0; s < sizeof(stages) / sizeof(stages[0]); s++) {
+            double best = 0;
+            unsigned long stage_allocations = 0;
+            long stage_peak_heap_bytes = 0;
+
+            for (int i = 0; i < iterations; i++) {
+                unsigned long start_allocations = allocations;
+                long start_heap_bytes = heap_bytes;
+                peak_heap_bytes = heap_bytes;
+                double start = now_seconds();
+                long iaps = stages[s].fn(&r);
+                double elapsed = now_seconds() - start;
+
+                if (iaps != (long)num_iaps) {
+                    fprintf(stderr, "%s: decoded %ld of %zu in-app purchases\n", stages[s].name, iaps, num_iaps);
+                    return 1;
+                }
+                if (i == 0 || elapsed < best) {
+                    best = elapsed;
+                }
+                stage_allocations = allocations - start_allocations;
+                stage_peak_heap_bytes = peak_heap_bytes - start_heap_bytes;
+            }
+
+            printf("%8zu %10zu  %-28s %10.3f %12.0f %12lu %12ld\n", num_iaps, r.signed_data_len, stages[s].name,
+                   best * 1e3, num_iaps / best, stage_allocations, stage_peak_heap_bytes / 1024);
+        }
+
+        free(signed_data);
+    }
+
+    printf("peak RSS: %ld KiB\n", peak_rss_kib());
+
+    return 0;
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Receipts are encoded with the asn1c DER encoder compiled into the app.
+
+#include "receipt_generator.h"
+#include "IA5String.h"
+#include "NativeInteger.h"
+#include "ReceiptAttributes.h"
+#include "SignedData.h"
+#include "UTF8String.h"
+#include "asn_SET_OF.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Receipt field types, see AppStoreParsedReceiptData.m.
+#define RECEIPT_TYPE_BUNDLE_IDENTIFIER 2
+#define RECEIPT_TYPE_APPLICATION_VERSION 3
+#define RECEIPT_TYPE_OPAQUE_VALUE 4
+#define RECEIPT_TYPE_SHA1_HASH 5
+#define RECEIPT_TYPE_CREATION_DATE 12
+#define RECEIPT_TYPE_IN_APP_PURCHASE_RECEIPT 17
+#define RECEIPT_TYPE_ORIGINAL_APPLICATION_VERSION 19
+#define RECEIPT_TYPE_QUANTITY 1701
+#define RECEIPT_TYPE_PRODUCT_IDENTIFIER 1702
+#define RECEIPT_TYPE_TRANSACTION_ID 1703
+#define RECEIPT_TYPE_PURCHASE_DATE 1704
+#define RECEIPT_TYPE_ORIGINAL_TRANSACTION_ID 1705
+#define RECEIPT_TYPE_ORIGINAL_PURCHASE_DATE 1706
+#define RECEIPT_TYPE_SUBSCRIPTION_EXPIRATION_DATE 1708
+#define RECEIPT_TYPE_WEB_ORDER_LINE_ITEM_ID 1711
+#define RECEIPT_TYPE_CANCELLATION_DATE 1712
+#define RECEIPT_TYPE_IS_IN_INTRO_OFFER_PERIOD 1719
+
+/// splitmix64.
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+} buffer;
+
+static int buffer_write(const void *bytes, size_t size, void *key) {
+    buffer *b = key;
+    if (b->len + size > b->cap) {
+        size_t cap = (b->cap == 0) ? 256 : b->cap;
+        while (cap < b->len + size) {
+            cap *= 2;
+        }
+        uint8_t *data = realloc(b->data, cap);
+        if (data == NULL) {
+            return -1;
+        }
+        b->data = data;
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, bytes, size);
+    b->len += size;
+    return 0;
+}
+
+/// DER encodes `value` of type `td` into a new buffer.
+static int encode(asn_TYPE_descriptor_t *td, void *value, buffer *out) {
+    memset(out, 0, sizeof(*out));
+    asn_enc_rval_t rval = der_encode(td, value, buffer_write, out);
+    if (rval.encoded < 0) {
+        free(out->data);
+        return -1;
+    }
+    return 0;
+}
+
+/// Adds an attribute whose value is the DER encoding of `value` of type `td`.
+static int add_attribute(ReceiptAttributes_t *attributes, long type, asn_TYPE_descriptor_t *td, void *value) {
+    buffer encoded;
+    if (encode(td, value, &encoded) != 0) {
+        return -1;
+    }
+
+    ReceiptAttribute_t *attribute = calloc(1, sizeof(*attribute));
+    if (attribute == NULL) {
+        free(encoded.data);
+        return -1;
+    }
+    attribute->type = type;
+    attribute->version = 1;
+    int ret = OCTET_STRING_fromBuf(&attribute->value, (const char *)encoded.data, (int)encoded.len);
+    free(encoded.data);
+
+    if (ret != 0 || ASN_SET_ADD(&attributes->list, attribute) != 0) {
+        ASN_STRUCT_FREE(asn_DEF_ReceiptAttribute, attribute);
+        return -1;
+    }
+    return 0;
+}
+
+static int add_string(ReceiptAttributes_t *attributes, long type, asn_TYPE_descriptor_t *td, const char *string) {
+    OCTET_STRING_t value = {0};
+    if (OCTET_STRING_fromString(&value, string) != 0) {
+        return -1;
+    }
+    int ret = add_attribute(attributes, type, td, &value);
+    ASN_STRUCT_FREE_CONTENTS_ONLY(*td, &value);
+    return ret;
+}
+
+static int add_integer(ReceiptAttributes_t *attributes, long type, long value) {
+    return add_attribute(attributes, type, &asn_DEF_NativeInteger, &value);
+}
+
+static int add_date(ReceiptAttributes_t *attributes, long type, time_t t) {
+    char date[32];
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    return add_string(attributes, type, &asn_DEF_IA5String, date);
+}
+
+static int add_bytes(ReceiptAttributes_t *attributes, long type, size_t len, uint64_t *state) {
+    ReceiptAttribute_t *attribute = calloc(1, sizeof(*attribute));
+    if (attribute == NULL) {
+        return -1;
+    }
+    attribute->type = type;
+    attribute->version = 1;
+    attribute->value.buf = malloc(len);
+    attribute->value.size = (int)len;
+    if (attribute->value.buf == NULL || ASN_SET_ADD(&attributes->list, attribute) != 0) {
+        ASN_STRUCT_FREE(asn_DEF_ReceiptAttribute, attribute);
+        return -1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        attribute->value.buf[i] = (uint8_t)next_random(state);
+    }
+    return 0;
+}
+
+/// Encodes the in-app purchase receipt of the `i`th monthly renewal of a subscription.
+static int encode_iap(size_t i, uint64_t *state, buffer *out) {
+    ReceiptAttributes_t iap;
+    memset(&iap, 0, sizeof(iap));
+    const time_t original_purchase = 1500000000;
+    const time_t purchase = original_purchase + (time_t)i * 30 * 24 * 3600;
+    char transaction_id[32];
+    snprintf(transaction_id, sizeof(transaction_id), "%llu", 100000000000000ULL + (unsigned long long)i);
+
+    int ret = 0;
+    ret |= add_integer(&iap, RECEIPT_TYPE_QUANTITY, 1);
+    ret |= add_string(&iap, RECEIPT_TYPE_PRODUCT_IDENTIFIER, &asn_DEF_UTF8String, "ca.psiphon.Psiphon.Consumable.Subscription.1month");
+    ret |= add_string(&iap, RECEIPT_TYPE_TRANSACTION_ID, &asn_DEF_UTF8String, transaction_id);
+    ret |= add_string(&iap, RECEIPT_TYPE_ORIGINAL_TRANSACTION_ID, &asn_DEF_UTF8String, "100000000000000");
+    ret |= add_date(&iap, RECEIPT_TYPE_PURCHASE_DATE, purchase);
+    ret |= add_date(&iap, RECEIPT_TYPE_ORIGINAL_PURCHASE_DATE, original_purchase);
+    ret |= add_date(&iap, RECEIPT_TYPE_SUBSCRIPTION_EXPIRATION_DATE, purchase + 30 * 24 * 3600);
+    ret |= add_integer(&iap, RECEIPT_TYPE_WEB_ORDER_LINE_ITEM_ID, 1000000000000L + (long)i);
+    ret |= add_integer(&iap, RECEIPT_TYPE_IS_IN_INTRO_OFFER_PERIOD, i == 0);
+    // Cancellation date is only present for some transactions, and is empty otherwise.
+    if (next_random(state) % 50 == 0) {
+        ret |= add_date(&iap, RECEIPT_TYPE_CANCELLATION_DATE, purchase + 24 * 3600);
+    } else {
+        ret |= add_bytes(&iap, RECEIPT_TYPE_CANCELLATION_DATE, 0, state);
+    }
+
+    if (ret == 0) {
+        ret = encode(&asn_DEF_ReceiptAttributes, &iap, out);
+    }
+    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_ReceiptAttributes, &iap);
+    return ret;
+}
+
+// See comment in header
+int generate_receipt_payload(size_t num_iaps, uint64_t seed, uint8_t **out, size_t *out_len) {
+    ReceiptAttributes_t receipt;
+    memset(&receipt, 0, sizeof(receipt));
+    uint64_t state = seed;
+
+    int ret = 0;
+    ret |= add_string(&receipt, RECEIPT_TYPE_BUNDLE_IDENTIFIER, &asn_DEF_UTF8String, "ca.psiphon.Psiphon");
+    ret |= add_string(&receipt, RECEIPT_TYPE_APPLICATION_VERSION, &asn_DEF_UTF8String, "180");
+    ret |= add_string(&receipt, RECEIPT_TYPE_ORIGINAL_APPLICATION_VERSION, &asn_DEF_UTF8String, "120");
+    ret |= add_bytes(&receipt, RECEIPT_TYPE_OPAQUE_VALUE, 16, &state);
+    ret |= add_bytes(&receipt, RECEIPT_TYPE_SHA1_HASH, 20, &state);
+    ret |= add_date(&receipt, RECEIPT_TYPE_CREATION_DATE, 1700000000);
+
+    for (size_t i = 0; i < num_iaps && ret == 0; i++) {
+        buffer iap;
+        if (encode_iap(i, &state, &iap) != 0) {
+            ret = -1;
+            break;
+        }
+
+        ReceiptAttribute_t *attribute = calloc(1, sizeof(*attribute));
+        if (attribute == NULL) {
+            free(iap.data);
+            ret = -1;
+            break;
+        }
+        attribute->type = RECEIPT_TYPE_IN_APP_PURCHASE_RECEIPT;
+        attribute->version = 1;
+        attribute->value.buf = iap.data;
+        attribute->value.size = (int)iap.len;
+        if (ASN_SET_ADD(&receipt.list, attribute) != 0) {
+            ASN_STRUCT_FREE(asn_DEF_ReceiptAttribute, attribute);
+            ret = -1;
+        }
+    }
+
+    buffer encoded = {0};
+    if (ret == 0) {
+        ret = encode(&asn_DEF_ReceiptAttributes, &receipt, &encoded);
+    }
+    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_ReceiptAttributes, &receipt);
+
+    if (ret != 0) {
+        return -1;
+    }
+
+    *out = encoded.data;
+    *out_len = encoded.len;
+    return 0;
+}
+
+// See comment in header
+int generate_receipt(size_t num_iaps, uint64_t seed, uint8_t **out, size_t *out_len) {
+    // id-signedData and id-data, see RFC 2315.
+    static const unsigned long oid_signed_data[] = {1, 2, 840, 113549, 1, 7, 2};
+    static const unsigned long oid_data[] = {1, 2, 840, 113549, 1, 7, 1};
+    // SET { AlgorithmIdentifier { sha1, NULL } }
+    static const uint8_t digest_algorithms[] = {0x31, 0x0B, 0x30, 0x09, 0x06, 0x05, 0x2B, 0x0E,
+                                                0x03, 0x02, 0x1A, 0x05, 0x00};
+
+    uint8_t *payload;
+    size_t payload_len;
+    if (generate_receipt_payload(num_iaps, seed, &payload, &payload_len) != 0) {
+        return -1;
+    }
+
+    SignedData_t signed_data;
+    memset(&signed_data, 0, sizeof(signed_data));
+    signed_data.content.version = 1;
+    signed_data.content.digestAlgorithms.buf = (uint8_t *)digest_algorithms;
+    signed_data.content.digestAlgorithms.size = sizeof(digest_algorithms);
+    signed_data.content.contentInfo.contentData.buf = payload;
+    signed_data.content.contentInfo.contentData.size = (int)payload_len;
+
+    int ret = 0;
+    ret |= OBJECT_IDENTIFIER_set_arcs(&signed_data.contentType, oid_signed_data, sizeof(oid_signed_data[0]),
+                                      sizeof(oid_signed_data) / sizeof(oid_signed_data[0]));
+    ret |= OBJECT_IDENTIFIER_set_arcs(&signed_data.content.contentInfo.contentType, oid_data, sizeof(oid_data[0]),
+                                      sizeof(oid_data) / sizeof(oid_data[0]));
+
+    buffer encoded = {0};
+    if (ret == 0) {
+        ret = encode(&asn_DEF_SignedData, &signed_data, &encoded);
+    }
+
+    // The digest algorithms and payload are not owned by the structure.
+    free(signed_data.contentType.buf);
+    free(signed_data.content.contentInfo.contentType.buf);
+    free(payload);
+
+    if (ret != 0) {
+        return -1;
+    }
+
+    *out = encoded.data;
+    *out_len = encoded.len;
+    return 0;
+}
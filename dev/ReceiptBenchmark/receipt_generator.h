@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef receipt_generator_h
+#define receipt_generator_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * @brief Generates a synthetic App Store receipt payload with `num_iaps` in-app purchase receipts.
+ *
+ * The payload is the DER encoded `ReceiptAttributes` SET that the PKCS#7 content of a receipt holds,
+ * with the attributes of a real receipt. Each in-app purchase receipt is an auto-renewable subscription
+ * renewal with the fields of a real one. The same seed always generates the same payload.
+ *
+ * @param num_iaps Number of in-app purchase receipts.
+ * @param seed Generator seed.
+ * @param out Set to the payload, which the caller must free.
+ * @param out_len Set to the length of the payload.
+ * @return 0 on success, -1 on failure.
+ */
+int generate_receipt_payload(size_t num_iaps, uint64_t seed, uint8_t **out, size_t *out_len);
+
+/*!
+ * @brief Generates a synthetic App Store receipt: the payload of `generate_receipt_payload` in a DER encoded
+ * PKCS#7 SignedData.
+ *
+ * The SignedData is encoded with the `SignedData` type of pkcs7-signed-data-simplified.asn1, so the
+ * certificates and signer infos of a real receipt are omitted. Both decoders skip them as extensions.
+ *
+ * @param num_iaps Number of in-app purchase receipts.
+ * @param seed Generator seed.
+ * @param out Set to the receipt, which the caller must free.
+ * @param out_len Set to the length of the receipt.
+ * @return 0 on success, -1 on failure.
+ */
+int generate_receipt(size_t num_iaps, uint64_t seed, uint8_t **out, size_t *out_len);
+
+#endif /* receipt_generator_h */
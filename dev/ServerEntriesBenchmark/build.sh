@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+
+# Builds the server entries benchmark. See README.md.
+
+set -euo pipefail
+
+cd "$(dirname "$0")"
+
+PSIPHON_DIR=../../Psiphon
+OUTPUT=${OUTPUT:-./server_entries_benchmark}
+CC=${CC:-cc}
+
+CFLAGS=(-O2 -std=c11 -D_GNU_SOURCE -Wall -Wno-deprecated -Wno-unknown-pragmas -I"${PSIPHON_DIR}")
+LDFLAGS=()
+
+# Allocations are counted by wrapping the allocator, which requires GNU ld.
+if [ "$(uname -s)" = "Linux" ]; then
+    CFLAGS+=(-DBENCH_COUNT_ALLOCATIONS)
+    LDFLAGS+=(-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc)
+fi
+
+"${CC}" "${CFLAGS[@]}" -o "${OUTPUT}" \
+    main.c \
+    "${PSIPHON_DIR}/EmbeddedServerEntriesHelpers.c" \
+    "${PSIPHON_DIR}/EmbeddedServerEntriesTable.c" \
+    ${LDFLAGS[@]+"${LDFLAGS[@]}"}
+
+echo "Built ${OUTPUT}"
@@ -0,0 +1,705 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Standalone benchmark of the embedded server entries parsing in
+// Psiphon/EmbeddedServerEntriesHelpers.c. See README.md.
+
+#include "EmbeddedServerEntriesHelpers.h"
+#include "EmbeddedServerEntriesTable.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_LINES 10000
+#define DEFAULT_ITERATIONS 5
+#define DEFAULT_SEED 1
+#define DEFAULT_REGIONS "US:30,DE:12,NL:10,GB:9,CA:8,FR:6,JP:5,SG:5,AT:3,CH:3,IN:2,ES:2,SE:2,IT:1,BR:1,AU:1"
+
+#define MAX_REGIONS 64
+
+// Size of the buffer the per-line inputs of a stage are built in, so that memory use does not grow with the corpus.
+#define BATCH_BYTES (16 << 20)
+
+/*** ALLOCATION COUNTING ***/
+
+// Allocations are counted by linking with `-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc`,
+// see build.sh. Only allocations made by code compiled into the benchmark are counted.
+
+static unsigned long allocations;
+
+#if defined(BENCH_COUNT_ALLOCATIONS)
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+    allocations++;
+    return __real_realloc(p, size);
+}
+
+#endif
+
+/*** CORPUS GENERATOR ***/
+
+typedef struct {
+    char code[8];
+    unsigned weight;
+} region_weight;
+
+typedef struct {
+    region_weight regions[MAX_REGIONS];
+    size_t region_count;
+    unsigned total_weight;
+} region_distribution;
+
+/// splitmix64, so that a seed always generates the same corpus on every platform.
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/// Parses a distribution such as "US:30,DE:12". Returns 0 on success, -1 on failure.
+static int parse_regions(const char *spec, region_distribution *dist) {
+    memset(dist, 0, sizeof(*dist));
+
+    const char *p = spec;
+    while (*p != '\0') {
+        if (dist->region_count == MAX_REGIONS) {
+            return -1;
+        }
+        region_weight *r = &dist->regions[dist->region_count];
+
+        const char *colon = strchr(p, ':');
+        if (colon == NULL || colon == p || (size_t)(colon - p) >= sizeof(r->code)) {
+            return -1;
+        }
+        memcpy(r->code, p, (size_t)(colon - p));
+
+        char *end;
+        errno = 0;
+        unsigned long weight = strtoul(colon + 1, &end, 10);
+        if (errno != 0 || end == colon + 1 || weight == 0 || weight > 1000000) {
+            return -1;
+        }
+        r->weight = (unsigned)weight;
+        dist->total_weight += r->weight;
+        dist->region_count++;
+
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return -1;
+        }
+    }
+
+    return (dist->region_count > 0) ? 0 : -1;
+}
+
+static const char *pick_region(const region_distribution *dist, uint64_t *state) {
+    unsigned n = (unsigned)(next_random(state) % dist->total_weight);
+    for (size_t i = 0; i < dist->region_count; i++) {
+        if (n < dist->regions[i].weight) {
+            return dist->regions[i].code;
+        }
+        n -= dist->regions[i].weight;
+    }
+    return dist->regions[dist->region_count - 1].code;
+}
+
+static void random_hex(char *out, size_t len, uint64_t *state) {
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < len; i++) {
+        out[i] = hex[next_random(state) & 0xF];
+    }
+    out[len] = '\0';
+}
+
+static void random_base64(char *out, size_t len, uint64_t *state) {
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (size_t i = 0; i < len; i++) {
+        out[i] = b64[next_random(state) & 0x3F];
+    }
+    out[len] = '\0';
+}
+
+/// Writes one hex encoded server entry line. Field names and sizes follow real server entries.
+static void generate_entry(FILE *out, size_t i, const region_distribution *dist, double crlf_ratio, uint64_t *state) {
+    static const char *capabilities[] = {
+        "handshake", "SSH", "OSSH", "FRONTED-MEEK", "UNFRONTED-MEEK", "UNFRONTED-MEEK-HTTPS",
+        "UNFRONTED-MEEK-SESSION-TICKET", "QUIC", "FRONTED-MEEK-QUIC", "TAPDANCE", "CONJURE", "VPN"
+    };
+    const size_t num_capabilities = sizeof(capabilities) / sizeof(capabilities[0]);
+
+    char ip[16];
+    snprintf(ip, sizeof(ip), "%u.%u.%u.%u",
+             (unsigned)(1 + (next_random(state) % 223)), (unsigned)((i >> 16) & 0xFF),
+             (unsigned)((i >> 8) & 0xFF), (unsigned)(i & 0xFF));
+
+    char web_secret[65], web_cert[1201], ssh_host_key[373], ssh_obfuscated_key[65];
+    char meek_key[45], tactics_key[45], signature[89];
+    random_hex(web_secret, 64, state);
+    random_base64(web_cert, 1200, state);
+    random_base64(ssh_host_key, 372, state);
+    random_hex(ssh_obfuscated_key, 64, state);
+    random_base64(meek_key, 44, state);
+    random_base64(tactics_key, 44, state);
+    random_base64(signature, 88, state);
+
+    char caps[256] = "";
+    size_t caps_len = 0;
+    for (size_t c = 0; c < num_capabilities; c++) {
+        if (next_random(state) & 1) {
+            caps_len += (size_t)snprintf(caps + caps_len, sizeof(caps) - caps_len, "%s\"%s\"",
+                                         (caps_len == 0) ? "" : ",", capabilities[c]);
+        }
+    }
+
+    char entry[4096];
+    int len = snprintf(entry, sizeof(entry),
+                       "%s 8080 %s %s "
+                       "{\"ipAddress\":\"%s\",\"webServerPort\":\"8080\",\"webServerSecret\":\"%s\","
+                       "\"webServerCertificate\":\"%s\",\"sshPort\":22,\"sshUsername\":\"%s\","
+                       "\"sshPassword\":\"%s\",\"sshHostKey\":\"%s\",\"sshObfuscatedPort\":%u,"
+                       "\"sshObfuscatedKey\":\"%s\",\"capabilities\":[%s],\"region\":\"%s\","
+                       "\"meekServerPort\":443,\"meekCookieEncryptionPublicKey\":\"%s\","
+                       "\"meekObfuscatedKey\":\"%s\",\"tacticsRequestPublicKey\":\"%s\","
+                       "\"configurationVersion\":1,\"signature\":\"%s\"}",
+                       ip, web_secret, web_cert,
+                       ip, web_secret, web_cert, web_secret + 32, web_secret, ssh_host_key,
+                       (unsigned)(1024 + (next_random(state) % 60000)), ssh_obfuscated_key, caps,
+                       pick_region(dist, state), meek_key, ssh_obfuscated_key, tactics_key, signature);
+    if (len < 0 || (size_t)len >= sizeof(entry)) {
+        fprintf(stderr, "server entry too long\n");
+        exit(1);
+    }
+
+    char hex[2 * sizeof(entry)];
+    static const char digits[] = "0123456789abcdef";
+    for (int j = 0; j < len; j++) {
+        hex[2 * j] = digits[(unsigned char)entry[j] >> 4];
+        hex[2 * j + 1] = digits[(unsigned char)entry[j] & 0xF];
+    }
+    fwrite(hex, 1, 2 * (size_t)len, out);
+
+    if ((double)(next_random(state) >> 11) / (double)(1ULL << 53) < crlf_ratio) {
+        fputs("\r\n", out);
+    } else {
+        fputc('\n', out);
+    }
+}
+
+/// Writes `num_lines` generated server entries to the file at `path`. Returns 0 on success, -1 on failure.
+static int generate_file(const char *path, size_t num_lines, const region_distribution *dist, double crlf_ratio,
+                         uint64_t seed) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return -1;
+    }
+    uint64_t state = seed;
+    for (size_t i = 0; i < num_lines; i++) {
+        generate_entry(f, i, dist, crlf_ratio, &state);
+    }
+    int failed = ferror(f);
+    if (fclose(f) != 0 || failed) {
+        return -1;
+    }
+    return 0;
+}
+
+/*** MEASUREMENT ***/
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// Peak resident set size of the process in KiB.
+static long peak_rss_kib(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024; // Bytes on macOS.
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+typedef struct {
+    const char *data;       // Corpus, mapped from a file.
+    size_t len;
+    size_t num_lines;
+} corpus;
+
+/// Input built for each line of a per-line stage.
+typedef enum {
+    INPUT_LINE,             // Line including its line ending.
+    INPUT_STRIPPED,         // Line without its line ending.
+    INPUT_DECODED,          // Hex decoded line.
+} line_input;
+
+/// Per-line inputs of a stage for consecutive lines of the corpus, NULL terminated and packed into one buffer.
+typedef struct {
+    char *data;
+    size_t cap;
+    char **lines;
+    size_t lines_cap;
+    size_t count;
+} batch;
+
+/// Fills `b` with the inputs of the lines following `it`, until `BATCH_BYTES` is used or the corpus ends.
+/// Returns the number of lines, or -1 on failure.
+static ssize_t batch_fill(batch *b, line_iterator *it, line_input input) {
+    b->count = 0;
+    size_t used = 0;
+
+    const char *start = it->next;
+    while (it->next < it->end) {
+        // Peek at the next line, and only consume it if it fits.
+        line_iterator peek = *it;
+        const char *line;
+        size_t len;
+        if (line_iterator_next(&peek, &line, &len) != 1) {
+            break;
+        }
+        size_t raw_len = (size_t)(peek.next - line);
+        size_t size = ((input == INPUT_LINE) ? raw_len : len) + 1;
+
+        if (used + size > b->cap) {
+            if (b->count > 0) {
+                break;
+            }
+            // A single line larger than the batch.
+            b->data = realloc(b->data, size);
+            if (b->data == NULL) {
+                return -1;
+            }
+            b->cap = size;
+        }
+        if (b->count == b->lines_cap) {
+            b->lines_cap = (b->lines_cap == 0) ? 1024 : 2 * b->lines_cap;
+            b->lines = realloc(b->lines, b->lines_cap * sizeof(char *));
+            if (b->lines == NULL) {
+                return -1;
+            }
+        }
+
+        char *out = b->data + used;
+        if (input == INPUT_DECODED) {
+            ssize_t decoded_len = hex_decode_buf(line, len, out);
+            if (decoded_len < 0) {
+                return -1;
+            }
+            out[decoded_len] = '\0';
+        } else {
+            memcpy(out, line, size - 1);
+            out[size - 1] = '\0';
+        }
+        b->lines[b->count++] = out;
+        used += size;
+        *it = peek;
+    }
+
+    // Drop the pages of the corpus that have been copied, so that they are not counted in the stage's RSS.
+    long page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t from = ((uintptr_t)start + (uintptr_t)page_size - 1) & ~((uintptr_t)page_size - 1);
+    uintptr_t to = (uintptr_t)it->next & ~((uintptr_t)page_size - 1);
+    if (to > from) {
+        madvise((void *)from, to - from, MADV_DONTNEED);
+    }
+
+    return (ssize_t)b->count;
+}
+
+/// Scratch buffer kept by a per-line stage across batches.
+typedef struct {
+    char *data;
+    size_t cap;
+} scratch;
+
+/// A benchmarked stage over per-line inputs. Returns the number of lines processed, or 0 on failure.
+typedef size_t (*line_stage_fn)(char **lines, size_t count, scratch *s);
+
+/// A benchmarked stage over the whole corpus. Returns the number of entries processed, or 0 on failure.
+typedef size_t (*corpus_stage_fn)(const char *data, size_t len);
+
+static size_t stage_drop_newline(char **lines, size_t count, scratch *s) {
+    for (size_t i = 0; i < count; i++) {
+        drop_newline_and_carriage_return(lines[i]);
+    }
+    return count;
+}
+
+static size_t stage_hex_decode(char **lines, size_t count, scratch *s) {
+    for (size_t i = 0; i < count; i++) {
+        char *decoded = hex_decode(lines[i]);
+        if (decoded == NULL) {
+            return 0;
+        }
+        free(decoded);
+    }
+    return count;
+}
+
+static size_t stage_hex_decode_buf(char **lines, size_t count, scratch *s) {
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(lines[i]);
+        if (len / 2 > s->cap) {
+            s->cap = len / 2;
+            s->data = realloc(s->data, s->cap);
+        }
+        if (s->data == NULL || hex_decode_buf(lines[i], len, s->data) < 0) {
+            return 0;
+        }
+    }
+    return count;
+}
+
+static size_t stage_server_entry_json(char **lines, size_t count, scratch *s) {
+    for (size_t i = 0; i < count; i++) {
+        if (server_entry_json(lines[i]) == NULL) {
+            return 0;
+        }
+    }
+    return count;
+}
+
+static size_t stage_region_scan(char **lines, size_t count, scratch *s) {
+    for (size_t i = 0; i < count; i++) {
+        const char *json = server_entry_json(lines[i]);
+        json_field field = {.key = "region"};
+        if (json == NULL ||
+            server_entry_json_scan(json, strlen(json), &field, 1) != JSON_SCAN_OK ||
+            field.type != JSON_VALUE_STRING) {
+            return 0;
+        }
+    }
+    return count;
+}
+
+/// Same steps as `addEgressRegionsFromLines:` in EmbeddedServerEntries.m, without the Foundation types.
+static size_t stage_egress_regions(const char *data, size_t data_len) {
+    char *decoded = NULL;
+    size_t decoded_cap = 0;
+    size_t count = 0;
+
+    line_iterator it;
+    line_iterator_init(&it, data, data_len);
+
+    const char *line;
+    size_t len;
+    while (line_iterator_next(&it, &line, &len) == 1) {
+        if (len / 2 > decoded_cap) {
+            decoded_cap = len / 2;
+            decoded = realloc(decoded, decoded_cap);
+        }
+        ssize_t decoded_len = (decoded == NULL) ? -1 : hex_decode_buf(line, len, decoded);
+        if (decoded_len < 0) {
+            count = 0;
+            break;
+        }
+        const char *json = server_entry_json_n(decoded, (size_t)decoded_len);
+        json_field field = {.key = "region"};
+        if (json == NULL ||
+            server_entry_json_scan(json, (size_t)decoded_len - (size_t)(json - decoded), &field, 1) != JSON_SCAN_OK ||
+            field.type != JSON_VALUE_STRING) {
+            count = 0;
+            break;
+        }
+        count++;
+    }
+
+    free(decoded);
+    return count;
+}
+
+static size_t stage_table(const char *data, size_t data_len) {
+    char *decoded = NULL;
+    size_t decoded_cap = 0;
+
+    server_entry_table table;
+    server_entry_table_init(&table);
+
+    line_iterator it;
+    line_iterator_init(&it, data, data_len);
+
+    const char *line;
+    size_t len;
+    while (line_iterator_next(&it, &line, &len) == 1) {
+        if (len / 2 > decoded_cap) {
+            decoded_cap = len / 2;
+            decoded = realloc(decoded, decoded_cap);
+        }
+        ssize_t decoded_len = (decoded == NULL) ? -1 : hex_decode_buf(line, len, decoded);
+        if (decoded_len < 0 || server_entry_table_add(&table, decoded, (size_t)decoded_len) != SERVER_ENTRY_TABLE_OK) {
+            break;
+        }
+    }
+
+    size_t count = table.count;
+    free(decoded);
+    server_entry_table_free(&table);
+    return count;
+}
+
+typedef struct {
+    const char *name;
+    line_input input;
+    line_stage_fn line_fn;     // Set for stages over per-line inputs,
+    corpus_stage_fn corpus_fn; // or for stages over the whole corpus.
+} stage;
+
+static const stage stages[] = {
+    {"drop_newline_and_carriage_return", INPUT_LINE, stage_drop_newline, NULL},
+    {"hex_decode", INPUT_STRIPPED, stage_hex_decode, NULL},
+    {"hex_decode_buf", INPUT_STRIPPED, stage_hex_decode_buf, NULL},
+    {"server_entry_json", INPUT_DECODED, stage_server_entry_json, NULL},
+    {"region scan", INPUT_DECODED, stage_region_scan, NULL},
+    {"egress regions (end to end)", INPUT_LINE, NULL, stage_egress_regions},
+    {"server entry table", INPUT_LINE, NULL, stage_table},
+};
+
+/// Runs one iteration of a stage. Only the stage itself is timed and its allocations counted, not building
+/// its per-line inputs. Returns the number of entries processed.
+static size_t run_stage(const stage *st, const corpus *c, batch *b, scratch *s,
+                        double *elapsed, unsigned long *stage_allocations) {
+    *elapsed = 0;
+    *stage_allocations = 0;
+
+    if (st->corpus_fn != NULL) {
+        unsigned long start_allocations = allocations;
+        double start = now_seconds();
+        size_t entries = st->corpus_fn(c->data, c->len);
+        *elapsed = now_seconds() - start;
+        *stage_allocations = allocations - start_allocations;
+        return entries;
+    }
+
+    size_t entries = 0;
+    line_iterator it;
+    line_iterator_init(&it, c->data, c->len);
+    for (;;) {
+        ssize_t count = batch_fill(b, &it, st->input);
+        if (count <= 0) {
+            return (count < 0) ? 0 : entries;
+        }
+        unsigned long start_allocations = allocations;
+        double start = now_seconds();
+        size_t processed = st->line_fn(b->lines, b->count, s);
+        *elapsed += now_seconds() - start;
+        *stage_allocations += allocations - start_allocations;
+        if (processed != b->count) {
+            return entries + processed;
+        }
+        entries += processed;
+    }
+}
+
+/// Benchmarks a stage and prints its results. Runs in a process forked for the stage, so that the reported
+/// RSS growth is that of the stage alone. Returns 0 on success, -1 on failure.
+static int benchmark_stage(const stage *st, const corpus *c, int iterations) {
+    long start_rss = peak_rss_kib();
+
+    batch b = {0};
+    scratch s = {0};
+    if (st->line_fn != NULL) {
+        b.cap = BATCH_BYTES;
+        b.data = malloc(b.cap);
+        if (b.data == NULL) {
+            return -1;
+        }
+    }
+
+    double best = 0;
+    unsigned long stage_allocations = 0;
+
+    for (int i = 0; i < iterations; i++) {
+        double elapsed;
+        size_t entries = run_stage(st, c, &b, &s, &elapsed, &stage_allocations);
+
+        if (entries != c->num_lines) {
+            fprintf(stderr, "%s: failed after %zu of %zu entries\n", st->name, entries, c->num_lines);
+            return -1;
+        }
+        if (i == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    printf("%-34s %10.2f %10.1f %14.0f %12lu %10ld\n", st->name, best * 1e3,
+           (c->len / 1e6) / best, c->num_lines / best, stage_allocations, peak_rss_kib() - start_rss);
+
+    free(s.data);
+    free(b.data);
+    free(b.lines);
+    return 0;
+}
+
+/*** MAIN ***/
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-n lines] [-r regions] [-c crlf_ratio] [-s seed] [-i iterations] [-f file] [-o file]\n"
+            "\n"
+            "  -n lines       Number of server entries to generate (default %d).\n"
+            "  -r regions     Region distribution as CODE:WEIGHT,... (default %s).\n"
+            "  -c crlf_ratio  Fraction of lines terminated by CRLF instead of LF (default 0).\n"
+            "  -s seed        Generator seed (default %d).\n"
+            "  -i iterations  Iterations of each stage; the fastest is reported (default %d).\n"
+            "  -f file        Benchmark an existing server entries file instead of a generated one.\n"
+            "  -o file        Write the generated server entries to file and exit.\n",
+            argv0, DEFAULT_LINES, DEFAULT_REGIONS, DEFAULT_SEED, DEFAULT_ITERATIONS);
+}
+
+int main(int argc, char *argv[]) {
+    size_t num_lines = DEFAULT_LINES;
+    const char *regions = DEFAULT_REGIONS;
+    double crlf_ratio = 0;
+    uint64_t seed = DEFAULT_SEED;
+    int iterations = DEFAULT_ITERATIONS;
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || value == NULL) {
+            usage(argv[0]);
+            return 2;
+        }
+        switch (arg[1]) {
+            case 'n': num_lines = strtoul(value, NULL, 10); break;
+            case 'r': regions = value; break;
+            case 'c': crlf_ratio = strtod(value, NULL); break;
+            case 's': seed = strtoull(value, NULL, 10); break;
+            case 'i': iterations = atoi(value); break;
+            case 'f': input_path = value; break;
+            case 'o': output_path = value; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+        i++;
+    }
+
+    if (num_lines == 0 || iterations <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const char *corpus_path = input_path;
+    char temp_path[] = "/tmp/server_entries_benchmark.XXXXXX";
+
+    if (input_path == NULL) {
+        region_distribution dist;
+        if (parse_regions(regions, &dist) != 0) {
+            fprintf(stderr, "invalid region distribution: %s\n", regions);
+            return 2;
+        }
+
+        // The corpus is generated to a file and mapped, like the app reads it, so that it is not held in the heap.
+        if (output_path != NULL) {
+            corpus_path = output_path;
+        } else {
+            int fd = mkstemp(temp_path);
+            if (fd < 0 || close(fd) != 0) {
+                fprintf(stderr, "%s: %s\n", temp_path, strerror(errno));
+                return 1;
+            }
+            corpus_path = temp_path;
+        }
+
+        if (generate_file(corpus_path, num_lines, &dist, crlf_ratio, seed) != 0) {
+            fprintf(stderr, "%s: %s\n", corpus_path, strerror(errno));
+            return 1;
+        }
+    }
+
+    server_entries_file file = {0};
+    int map_result = server_entries_file_map(corpus_path, &file);
+    if (corpus_path == temp_path) {
+        unlink(temp_path);
+    }
+    if (map_result != 0) {
+        fprintf(stderr, "%s: %s\n", corpus_path, strerror(errno));
+        return 1;
+    }
+
+    if (output_path != NULL) {
+        printf("wrote %zu server entries (%.1f MB) to %s\n", num_lines, file.len / 1e6, output_path);
+        return 0;
+    }
+
+    corpus c = {.data = file.data, .len = file.len, .num_lines = 0};
+    line_iterator it;
+    line_iterator_init(&it, c.data, c.len);
+    const char *line;
+    size_t len;
+    while (line_iterator_next(&it, &line, &len) == 1) {
+        c.num_lines++;
+    }
+
+    printf("corpus: %zu entries, %.1f MB, %d iterations\n", c.num_lines, c.len / 1e6, iterations);
+#if !defined(BENCH_COUNT_ALLOCATIONS)
+    printf("allocations are not counted on this platform\n");
+#endif
+    printf("%-34s %10s %10s %14s %12s %10s\n", "stage", "ms", "MB/s", "entries/s", "allocations", "RSS KiB");
+
+    for (size_t s = 0; s < sizeof(stages) / sizeof(stages[0]); s++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            int result = benchmark_stage(&stages[s], &c, iterations);
+            fflush(stdout);
+            _exit(result == 0 ? 0 : 1);
+        }
+        int status;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            return 1;
+        }
+    }
+
+    server_entries_file_unmap(&file);
+    return 0;
+}
@@ -0,0 +1,20 @@
+#!/usr/bin/env bash
+
+# Builds the timestamp parsing benchmark. See README.md.
+
+set -euo pipefail
+
+cd "$(dirname "$0")"
+
+TIMESTAMP_DIR=../../Utilities/Sources/c-timestamp
+OUTPUT=${OUTPUT:-./timestamp_benchmark}
+CC=${CC:-cc}
+
+CONFORMANCE_PATH="$(pwd)/../../Utilities/Tests/UtilitiesTests/rfc3339_conformance.tsv"
+CFLAGS=(-O2 -std=c11 -D_GNU_SOURCE -Wall -I"${TIMESTAMP_DIR}/include" -DCONFORMANCE_PATH="\"${CONFORMANCE_PATH}\"")
+
+"${CC}" "${CFLAGS[@]}" -o "${OUTPUT}" \
+    main.c \
+    "${TIMESTAMP_DIR}"/*.c
+
+echo "Built ${OUTPUT}"
@@ -0,0 +1,537 @@
+/*
+ * Copyright (c) 2026, Psiphon Inc.
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Standalone benchmark and conformance suite of the RFC 3339 timestamp parsing
+// in Utilities/Sources/c-timestamp. See README.md.
+
+#include "timestamp.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_TIMESTAMPS 2000000
+#define DEFAULT_OTHER_RATIO 0.0
+#define DEFAULT_CHECKS 1000000
+#define DEFAULT_ITERATIONS 5
+#define DEFAULT_SEED 1
+
+/// Longest timestamp generated, with nanoseconds and an offset.
+#define MAX_TIMESTAMP_LEN 40
+
+/// 2100-01-01T00:00:00Z
+#define MAX_EPOCH_SECONDS 4102444800LL
+
+/// Conformance vectors shared with the Swift tests, see build.sh.
+#ifndef CONFORMANCE_PATH
+#define CONFORMANCE_PATH "../../Utilities/Tests/UtilitiesTests/rfc3339_conformance.tsv"
+#endif
+
+#define MAX_CONFORMANCE_FIELDS 6
+
+/*** CORPUS GENERATOR ***/
+
+/// splitmix64.
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double next_unit(uint64_t *state) {
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/// Writes a random timestamp to `out`, and returns its length. With `notice_shape`, the timestamp has the
+/// `YYYY-MM-DDTHH:MM:SS.mmmZ` shape of notice timestamps. Otherwise, it has a random precision and offset.
+static size_t generate_timestamp(char *out, int notice_shape, uint64_t *state) {
+    psi_timestamp_t ts = {
+        .sec = (int64_t)(next_random(state) % MAX_EPOCH_SECONDS),
+        .nsec = (int32_t)(next_random(state) % 1000000000),
+        .offset = 0,
+    };
+    int precision = 3;
+
+    if (!notice_shape) {
+        static const int precisions[] = {0, 3, 6, 9};
+        precision = precisions[next_random(state) % 4];
+        ts.offset = (int16_t)((int)(next_random(state) % (2 * 14 * 60 + 1)) - 14 * 60);
+    }
+
+    size_t len = psi_timestamp_format_precision(out, MAX_TIMESTAMP_LEN, &ts, precision);
+
+    // Separators accepted by psi_timestamp_parse other than 'T'.
+    if (!notice_shape && len > 10 && next_random(state) % 4 == 0) {
+        out[10] = (next_random(state) % 2) ? 't' : ' ';
+    }
+    return len;
+}
+
+/// Mutates a timestamp of length `len` in place, and returns its new length.
+static size_t mutate(char *s, size_t len, uint64_t *state) {
+    static const char alphabet[] = "0123456789-:.TtZz+ /";
+
+    switch (next_random(state) % 4) {
+        case 0:
+        case 1: {
+            // Replace a character, with one that is likely to be valid somewhere.
+            size_t i = next_random(state) % len;
+            s[i] = (next_random(state) % 4 == 0) ? (char)next_random(state)
+                                                  : alphabet[next_random(state) % (sizeof(alphabet) - 1)];
+            return len;
+        }
+        case 2:
+            // Truncate.
+            return next_random(state) % len;
+        default:
+            // Extend.
+            if (len < MAX_TIMESTAMP_LEN) {
+                s[len] = alphabet[next_random(state) % (sizeof(alphabet) - 1)];
+                return len + 1;
+            }
+            return len;
+    }
+}
+
+typedef struct {
+    char *data;
+    psi_timestamp_str_t *strs;
+    psi_timestamp_t *tsps;
+    int *results;
+    size_t count;
+    size_t bytes;
+} corpus;
+
+static int generate_corpus(corpus *c, size_t count, double other_ratio, uint64_t seed) {
+    uint64_t state = seed;
+
+    memset(c, 0, sizeof(*c));
+    c->data = malloc(count * MAX_TIMESTAMP_LEN);
+    c->strs = malloc(count * sizeof(c->strs[0]));
+    c->tsps = malloc(count * sizeof(c->tsps[0]));
+    c->results = malloc(count * sizeof(c->results[0]));
+    if (c->data == NULL || c->strs == NULL || c->tsps == NULL || c->results == NULL) {
+        return -1;
+    }
+
+    char *p = c->data;
+    for (size_t i = 0; i < count; i++) {
+        size_t len = generate_timestamp(p, next_unit(&state) >= other_ratio, &state);
+        c->strs[i] = (psi_timestamp_str_t){.str = p, .len = len};
+        c->bytes += len;
+        p += len;
+    }
+    c->count = count;
+    return 0;
+}
+
+static void free_corpus(corpus *c) {
+    free(c->data);
+    free(c->strs);
+    free(c->tsps);
+    free(c->results);
+}
+
+/*** CONFORMANCE ***/
+
+/// Splits `line` in place into at most `max` tab separated fields, and returns the number of fields.
+static int split_fields(char *line, char **fields, int max) {
+    int n = 0;
+    line[strcspn(line, "\r\n")] = '\0';
+    while (n < max) {
+        fields[n++] = line;
+        char *tab = strchr(line, '\t');
+        if (tab == NULL) {
+            break;
+        }
+        *tab = '\0';
+        line = tab + 1;
+    }
+    return n;
+}
+
+/// Parses `str` with both `psi_timestamp_parse` and `psi_timestamp_parse_batch`. Returns the result, or -1 if they
+/// differ.
+static int parse_both(const char *str, psi_timestamp_t *ts) {
+    psi_timestamp_t batch_ts;
+    int batch_result;
+    psi_timestamp_str_t s = {.str = str, .len = strlen(str)};
+
+    int result = psi_timestamp_parse(s.str, s.len, ts);
+    psi_timestamp_parse_batch(&s, 1, &batch_ts, &batch_result);
+    if (result != batch_result ||
+        (result == 0 && (ts->sec != batch_ts.sec || ts->nsec != batch_ts.nsec || ts->offset != batch_ts.offset))) {
+        return -1;
+    }
+    return result;
+}
+
+static int sign(int v) {
+    return (v > 0) - (v < 0);
+}
+
+/// Checks one conformance vector. Returns 0 if the library conforms, -1 if not, or -2 if the vector is malformed.
+static int check_vector(char **f, int n) {
+    psi_timestamp_t ts, ts2;
+
+    if (strcmp(f[0], "parse") == 0 && (n == 3 || n == 6)) {
+        int result = parse_both(f[1], &ts);
+        if (result != atoi(f[2])) {
+            return -1;
+        }
+        if (result == 0 && (ts.sec != strtoll(f[3], NULL, 10) || ts.nsec != atoi(f[4]) || ts.offset != atoi(f[5]))) {
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(f[0], "format") == 0 && (n == 5 || n == 6)) {
+        char buf[MAX_TIMESTAMP_LEN];
+        ts = (psi_timestamp_t){
+            .sec = strtoll(f[1], NULL, 10),
+            .nsec = atoi(f[2]),
+            .offset = (int16_t)atoi(f[3]),
+        };
+        size_t len = psi_timestamp_format_precision(buf, sizeof(buf), &ts, atoi(f[4]));
+        if (n == 5) {
+            return (len == 0) ? 0 : -1;
+        }
+        return (len == strlen(f[5]) && memcmp(buf, f[5], len) == 0) ? 0 : -1;
+    }
+
+    if (strcmp(f[0], "compare") == 0 && (n == 3 || n == 4)) {
+        int result;
+        int ret = psi_timestamp_compare_str(f[1], strlen(f[1]), f[2], strlen(f[2]), &result);
+        if (n == 3) {
+            return (ret != 0) ? 0 : -1;
+        }
+        if (ret != 0 || result != atoi(f[3]) || parse_both(f[1], &ts) != 0 || parse_both(f[2], &ts2) != 0) {
+            return -1;
+        }
+        return (sign(psi_timestamp_compare(&ts, &ts2)) == atoi(f[3])) ? 0 : -1;
+    }
+
+    return -2;
+}
+
+/// Checks the conformance vectors in `path`.
+static int check_conformance(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "failed to open %s\n", path);
+        return -1;
+    }
+
+    char line[256];
+    size_t vectors = 0, failures = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+
+        char copy[sizeof(line)];
+        memcpy(copy, line, sizeof(line));
+
+        char *fields[MAX_CONFORMANCE_FIELDS];
+        int n = split_fields(line, fields, MAX_CONFORMANCE_FIELDS);
+        int ret = check_vector(fields, n);
+        if (ret != 0) {
+            fprintf(stderr, "%s vector: %s", (ret == -2) ? "malformed" : "failed", copy);
+            failures++;
+        }
+        vectors++;
+    }
+    fclose(file);
+
+    printf("%zu conformance vectors, %zu failures\n", vectors, failures);
+    return failures == 0 ? 0 : -1;
+}
+
+/*** DIFFERENTIAL CHECK ***/
+
+/// Parses `str` with `psi_timestamp_parse` and `psi_timestamp_parse_batch`, and returns 0 if the results are the same.
+static int check(const char *str, size_t len) {
+    psi_timestamp_t expected, actual;
+    int result;
+
+    int expected_result = psi_timestamp_parse(str, len, &expected);
+    psi_timestamp_str_t s = {.str = str, .len = len};
+    psi_timestamp_parse_batch(&s, 1, &actual, &result);
+
+    if (expected_result != result ||
+        (result == 0 && (expected.sec != actual.sec || expected.nsec != actual.nsec ||
+                         expected.offset != actual.offset))) {
+        fprintf(stderr, "mismatch on '%.*s': psi_timestamp_parse %d (%lld, %d, %d), batch %d (%lld, %d, %d)\n",
+                (int)len, str, expected_result, (long long)expected.sec, expected.nsec, expected.offset, result,
+                (long long)actual.sec, actual.nsec, actual.offset);
+        return -1;
+    }
+    return 0;
+}
+
+/// Checks `cases` generated timestamps of the notice shape and of other shapes, and mutations of them.
+/// Each buffer is the size of the timestamp, so that out of bounds reads are caught by the sanitizers.
+static int check_batch(size_t cases, uint64_t seed) {
+    uint64_t state = seed;
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < cases; i++) {
+        char s[MAX_TIMESTAMP_LEN + 1];
+        size_t len = generate_timestamp(s, i % 2 == 0, &state);
+
+        int mutations = (i % 4 < 2) ? 0 : 1 + (int)(next_random(&state) % 2);
+        for (int m = 0; m < mutations && len > 0; m++) {
+            len = mutate(s, len, &state);
+        }
+
+        char *copy = malloc(len + 1);
+        if (copy == NULL) {
+            return -1;
+        }
+        memcpy(copy, s, len);
+        if (check(copy, len) != 0) {
+            mismatches++;
+        }
+        free(copy);
+    }
+
+    printf("%zu cases, %zu mismatches\n", cases, mismatches);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/// Compares `s1` and `s2` with `psi_timestamp_compare_str`, and by parsing them, and returns 0 if the results are the
+/// same.
+static int check_compare_pair(const char *s1, size_t len1, const char *s2, size_t len2) {
+    psi_timestamp_t t1, t2;
+    int result = 0;
+
+    int expected_result = psi_timestamp_parse(s1, len1, &t1) || psi_timestamp_parse(s2, len2, &t2);
+    int ret = psi_timestamp_compare_str(s1, len1, s2, len2, &result);
+
+    if (ret != expected_result || (ret == 0 && result != psi_timestamp_compare(&t1, &t2))) {
+        fprintf(stderr, "mismatch on '%.*s' and '%.*s': parsed %d (%d), psi_timestamp_compare_str %d (%d)\n",
+                (int)len1, s1, (int)len2, s2, expected_result,
+                expected_result == 0 ? psi_timestamp_compare(&t1, &t2) : 0, ret, result);
+        return -1;
+    }
+    return 0;
+}
+
+/// Checks `cases` pairs of generated timestamps of the same and of different shapes. A third of the pairs differ in a
+/// single digit, so that ordering on any field is covered, and some are mutated as in `check_batch`.
+static int check_compare(size_t cases, uint64_t seed) {
+    uint64_t state = seed;
+    size_t mismatches = 0;
+
+    for (size_t i = 0; i < cases; i++) {
+        char s[2][MAX_TIMESTAMP_LEN + 1];
+        size_t len[2];
+
+        len[0] = generate_timestamp(s[0], i % 2 == 0, &state);
+        if (i % 3 == 0) {
+            memcpy(s[1], s[0], len[0]);
+            len[1] = len[0];
+            size_t d = next_random(&state) % len[1];
+            if (s[1][d] >= '0' && s[1][d] <= '9') {
+                s[1][d] = (char)('0' + next_random(&state) % 10);
+            }
+        } else {
+            len[1] = generate_timestamp(s[1], i % 4 < 2, &state);
+        }
+
+        if (i % 8 >= 6) {
+            int m = (int)(next_random(&state) % 2);
+            if (len[m] > 0) {
+                len[m] = mutate(s[m], len[m], &state);
+            }
+        }
+
+        char *copy[2];
+        copy[0] = malloc(len[0] + 1);
+        copy[1] = malloc(len[1] + 1);
+        if (copy[0] == NULL || copy[1] == NULL) {
+            free(copy[0]);
+            free(copy[1]);
+            return -1;
+        }
+        memcpy(copy[0], s[0], len[0]);
+        memcpy(copy[1], s[1], len[1]);
+        if (check_compare_pair(copy[0], len[0], copy[1], len[1]) != 0) {
+            mismatches++;
+        }
+        free(copy[0]);
+        free(copy[1]);
+    }
+
+    printf("%zu pairs, %zu mismatches\n", cases, mismatches);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/*** MEASUREMENT ***/
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// A benchmarked stage. Returns the number of timestamps parsed or compared.
+typedef size_t (*stage_fn)(corpus *c);
+
+/// As the feedback log parsing does, one timestamp at a time.
+static size_t stage_parse(corpus *c) {
+    size_t parsed = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        c->results[i] = psi_timestamp_parse(c->strs[i].str, c->strs[i].len, &c->tsps[i]);
+        parsed += (c->results[i] == 0);
+    }
+    return parsed;
+}
+
+static size_t stage_parse_batch(corpus *c) {
+    return psi_timestamp_parse_batch(c->strs, c->count, c->tsps, c->results);
+}
+
+/// Compares each timestamp with the next after parsing both, as sorting the parsed feedback logs does.
+static size_t stage_compare(corpus *c) {
+    size_t compared = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        const psi_timestamp_str_t *s1 = &c->strs[i];
+        const psi_timestamp_str_t *s2 = &c->strs[(i + 1) % c->count];
+        psi_timestamp_t t1, t2;
+
+        if (psi_timestamp_parse(s1->str, s1->len, &t1) == 0 && psi_timestamp_parse(s2->str, s2->len, &t2) == 0) {
+            c->results[i] = psi_timestamp_compare(&t1, &t2);
+            compared++;
+        }
+    }
+    return compared;
+}
+
+static size_t stage_compare_str(corpus *c) {
+    size_t compared = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        const psi_timestamp_str_t *s1 = &c->strs[i];
+        const psi_timestamp_str_t *s2 = &c->strs[(i + 1) % c->count];
+
+        compared += (psi_timestamp_compare_str(s1->str, s1->len, s2->str, s2->len, &c->results[i]) == 0);
+    }
+    return compared;
+}
+
+static const struct {
+    const char *name;
+    stage_fn fn;
+} stages[] = {
+    {"psi_timestamp_parse", stage_parse},
+    {"psi_timestamp_parse_batch", stage_parse_batch},
+    {"psi_timestamp_compare", stage_compare},
+    {"psi_timestamp_compare_str", stage_compare_str},
+};
+
+/*** MAIN ***/
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-n timestamps] [-o other_ratio] [-c checks] [-s seed] [-i iterations] [-t vectors]\n"
+            "\n"
+            "  -n timestamps  Number of timestamps to generate (default %d).\n"
+            "  -o other_ratio Fraction of timestamps with other precisions and offsets than notices (default %.0f).\n"
+            "  -c checks      Number of differential checks of psi_timestamp_parse_batch and of\n"
+            "                 psi_timestamp_compare_str (default %d).\n"
+            "  -s seed        Generator seed (default %d).\n"
+            "  -i iterations  Iterations of each stage; the fastest is reported (default %d).\n"
+            "  -t vectors     Conformance vectors (default %s).\n",
+            argv0, DEFAULT_TIMESTAMPS, DEFAULT_OTHER_RATIO, DEFAULT_CHECKS, DEFAULT_SEED, DEFAULT_ITERATIONS,
+            CONFORMANCE_PATH);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = DEFAULT_TIMESTAMPS;
+    double other_ratio = DEFAULT_OTHER_RATIO;
+    size_t checks = DEFAULT_CHECKS;
+    uint64_t seed = DEFAULT_SEED;
+    int iterations = DEFAULT_ITERATIONS;
+    const char *vectors = CONFORMANCE_PATH;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || value == NULL) {
+            usage(argv[0]);
+            return 2;
+        }
+        switch (arg[1]) {
+            case 'n': count = strtoull(value, NULL, 10); break;
+            case 'o': other_ratio = atof(value); break;
+            case 'c': checks = strtoull(value, NULL, 10); break;
+            case 's': seed = strtoull(value, NULL, 10); break;
+            case 'i': iterations = atoi(value); break;
+            case 't': vectors = value; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+        i++;
+    }
+
+    if (count == 0 || iterations <= 0 || other_ratio < 0 || other_ratio > 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (check_conformance(vectors) != 0 || check_batch(checks, seed) != 0 || check_compare(checks, seed) != 0) {
+        return 1;
+    }
+
+    corpus c;
+    if (generate_corpus(&c, count, other_ratio, seed) != 0) {
+        fprintf(stderr, "failed to generate %zu timestamps\n", count);
+        return 1;
+    }
+
+    printf("%zu timestamps, %.1f MB\n", c.count, c.bytes / 1e6);
+    printf("%-28s %10s %14s %10s\n", "stage", "ms", "timestamps/s", "MB/s");
+
+    for (size_t s = 0; s < sizeof(stages) / sizeof(stages[0]); s++) {
+        double best = 0;
+
+        for (int i = 0; i < iterations; i++) {
+            double start = now_seconds();
+            size_t parsed = stages[s].fn(&c);
+            double elapsed = now_seconds() - start;
+
+            if (parsed != c.count) {
+                fprintf(stderr, "%s: processed %zu of %zu timestamps\n", stages[s].name, parsed, c.count);
+                return 1;
+            }
+            if (i == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+
+        printf("%-28s %10.3f %14.0f %10.1f\n", stages[s].name, best * 1e3, c.count / best, c.bytes / best / 1e6);
+    }
+
+    free_corpus(&c);
+
+    return 0;
+}
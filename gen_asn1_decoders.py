@@ -0,0 +1,750 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (c) 2026, Psiphon Inc.
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+Generates schema-specialized BER decoders from an ASN.1 module.
+
+The asn1c runtime in `Psiphon/asn1c` decodes every type with the generic,
+table-driven SEQUENCE and SET OF decoders, which look up each member's tag
+and type descriptor as they go. For each type assignment of the module, this
+generates a `<Type>_decode_fast` function which decodes straight into the same
+structures as the asn1c generated `<Type>.h`, with the tags and members of the
+type known at compile time.
+
+The generated decoders decode the usual DER and BER encodings themselves, and
+hand anything else (constructed strings with nested segments, indefinite
+length ANY values, input that is truncated or malformed) to `ber_decode`, so
+they return the same results as the generic decoders for any input.
+
+Only the subset of ASN.1 used by `pkcs7-signed-data-simplified.asn1` is
+supported: SEQUENCE with an optional extension marker, SET OF a named type,
+INTEGER (decoded into a native long, as with `asn1c -fnative-types`),
+OBJECT IDENTIFIER, OCTET STRING, ANY and EXPLICIT tags.
+
+Usage:
+
+    ./gen_asn1_decoders.py Psiphon/asn1c/pkcs7-signed-data-simplified.asn1 \\
+        Psiphon/asn1c/receipt_decoders
+
+writes `receipt_decoders.h` and `receipt_decoders.c`.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+TOKEN_RE = re.compile(r'\s*(?:(--.*?(?:--|$))|(::=)|(\.\.\.)|([\[\]{},])|([A-Za-z][A-Za-z0-9-]*)|([0-9]+))',
+                      re.MULTILINE)
+
+UNIVERSAL_TAGS = {
+    'INTEGER': 2,
+    'OCTET STRING': 4,
+    'OBJECT IDENTIFIER': 6,
+    'SEQUENCE': 16,
+    'SET OF': 17,
+}
+
+TAG_CLASSES = {
+    'UNIVERSAL': 'ASN_TAG_CLASS_UNIVERSAL',
+    'APPLICATION': 'ASN_TAG_CLASS_APPLICATION',
+    'CONTEXT': 'ASN_TAG_CLASS_CONTEXT',
+    'PRIVATE': 'ASN_TAG_CLASS_PRIVATE',
+}
+
+
+class ParseError(Exception):
+    pass
+
+
+# Type nodes are dicts with a 'kind' of one of
+#   'INTEGER', 'OBJECT IDENTIFIER', 'OCTET STRING', 'ANY'
+#   'SEQUENCE'  'members': [(name, type)], 'extensible': bool
+#   'SET OF'    'element': type
+#   'TAGGED'    'tag': (class, number), 'type': type
+#   'REF'       'name': type name
+
+
+def tokenize(text):
+    tokens = []
+    pos = 0
+    while pos < len(text):
+        m = TOKEN_RE.match(text, pos)
+        if m is None or m.end() == pos:
+            if text[pos:].strip() == '':
+                break
+            raise ParseError('unexpected input: {!r}'.format(text[pos:pos + 20]))
+        pos = m.end()
+        if m.group(1):
+            continue
+        tokens.append(next(g for g in m.groups()[1:] if g is not None))
+    return tokens
+
+
+class Parser(object):
+
+    def __init__(self, tokens):
+        self.tokens = tokens
+        self.pos = 0
+
+    def peek(self, offset=0):
+        i = self.pos + offset
+        return self.tokens[i] if i < len(self.tokens) else None
+
+    def next(self):
+        token = self.peek()
+        if token is None:
+            raise ParseError('unexpected end of module')
+        self.pos += 1
+        return token
+
+    def expect(self, *expected):
+        for e in expected:
+            token = self.next()
+            if token != e:
+                raise ParseError('expected {!r}, found {!r}'.format(e, token))
+
+    def module(self):
+        name = self.next()
+        self.expect('DEFINITIONS')
+        if self.peek() in ('EXPLICIT', 'IMPLICIT', 'AUTOMATIC'):
+            tagging = self.next()
+            self.expect('TAGS')
+            if tagging != 'EXPLICIT':
+                raise ParseError('only EXPLICIT TAGS modules are supported')
+        self.expect('::=', 'BEGIN')
+        assignments = []
+        while self.peek() != 'END':
+            type_name = self.next()
+            self.expect('::=')
+            assignments.append((type_name, self.type()))
+        self.expect('END')
+        return name, assignments
+
+    def type(self):
+        token = self.next()
+        if token == '[':
+            tag_class = 'CONTEXT'
+            if self.peek() in TAG_CLASSES:
+                tag_class = self.next()
+            number = int(self.next())
+            self.expect(']')
+            if self.peek() == 'IMPLICIT':
+                raise ParseError('IMPLICIT tags are not supported')
+            if self.peek() == 'EXPLICIT':
+                self.next()
+            return {'kind': 'TAGGED', 'tag': (tag_class, number), 'type': self.type()}
+        if token == 'INTEGER':
+            return {'kind': 'INTEGER'}
+        if token == 'ANY':
+            return {'kind': 'ANY'}
+        if token == 'OBJECT':
+            self.expect('IDENTIFIER')
+            return {'kind': 'OBJECT IDENTIFIER'}
+        if token == 'OCTET':
+            self.expect('STRING')
+            return {'kind': 'OCTET STRING'}
+        if token == 'SET':
+            self.expect('OF')
+            return {'kind': 'SET OF', 'element': self.type()}
+        if token == 'SEQUENCE':
+            if self.peek() == 'OF':
+                raise ParseError('SEQUENCE OF is not supported')
+            return self.sequence()
+        if token[0].isupper():
+            return {'kind': 'REF', 'name': token}
+        raise ParseError('unsupported type {!r}'.format(token))
+
+    def sequence(self):
+        self.expect('{')
+        members = []
+        extensible = False
+        while True:
+            if self.peek() == '...':
+                self.next()
+                extensible = True
+            else:
+                member_name = self.next()
+                member_type = self.type()
+                if self.peek() in ('OPTIONAL', 'DEFAULT'):
+                    raise ParseError('{} members are not supported'.format(self.peek()))
+                if extensible:
+                    raise ParseError('extension additions are not supported')
+                members.append((member_name, member_type))
+            token = self.next()
+            if token == '}':
+                break
+            if token != ',':
+                raise ParseError('expected \',\' or \'}}\', found {!r}'.format(token))
+        return {'kind': 'SEQUENCE', 'members': members, 'extensible': extensible}
+
+
+class Generator(object):
+
+    def __init__(self, module_name, source_name, assignments, output_name):
+        self.module_name = module_name
+        self.source_name = source_name
+        self.assignments = assignments
+        self.types = dict(assignments)
+        self.output_name = output_name
+        self.tag_arrays = []
+        self.functions = []
+
+    def resolve(self, node):
+        while node['kind'] == 'REF':
+            if node['name'] not in self.types:
+                raise ParseError('undefined type {}'.format(node['name']))
+            node = self.types[node['name']]
+        return node
+
+    def tags(self, node):
+        """Returns the tags of the TLVs of `node`, outermost first."""
+        if node['kind'] == 'TAGGED':
+            return [node['tag']] + self.tags(node['type'])
+        if node['kind'] == 'REF':
+            return self.tags(self.resolve(node))
+        if node['kind'] == 'ANY':
+            return []
+        return [('UNIVERSAL', UNIVERSAL_TAGS[node['kind']])]
+
+    @staticmethod
+    def untagged(node):
+        while node['kind'] == 'TAGGED':
+            node = node['type']
+        return node
+
+    def tag_array(self, name, tags):
+        lines = ['static const ber_tlv_tag_t fd_tags_{}[] = {{'.format(name)]
+        lines += ['\t({} | ({} << 2)){}'.format(TAG_CLASSES[c], n, ',' if i < len(tags) - 1 else '')
+                  for i, (c, n) in enumerate(tags)]
+        lines.append('};')
+        self.tag_arrays.append('\n'.join(lines))
+        return 'fd_tags_{}'.format(name)
+
+    def decode_call(self, path, node, target, struct_names):
+        """Returns the statements decoding `node` at `p` into `target`."""
+        base = self.untagged(node)
+        if base['kind'] == 'ANY':
+            if node['kind'] == 'TAGGED':
+                raise ParseError('tagged ANY is not supported')
+            return 'n = fd_decode_any(&{}, p, end);'.format(target)
+
+        tags = self.tag_array(path, self.tags(node))
+        args = 'p, end,\n\t\tFD_TAGS({})'.format(tags)
+
+        if base['kind'] == 'INTEGER':
+            return 'n = fd_decode_native_integer(&{}, {});'.format(target, args)
+        if base['kind'] == 'OBJECT IDENTIFIER':
+            return 'n = fd_decode_primitive(&{}, {});'.format(target, args)
+        if base['kind'] == 'OCTET STRING':
+            return 'n = fd_decode_octet_string(&{}, {});'.format(target, args)
+        if base['kind'] == 'REF':
+            return 'n = fd_decode_{}(ctx, &{}, {});'.format(base['name'], target, args)
+        # Nested constructed type.
+        self.constructed(path, base, 'struct {}'.format(struct_names[-1]), struct_names)
+        return 'n = fd_decode_{}(ctx, &{}, {});'.format(path, target, args)
+
+    def constructed(self, path, node, c_type, struct_names):
+        """Generates the decoder of a SEQUENCE or SET OF type."""
+        body = []
+        if node['kind'] == 'SEQUENCE':
+            for member_name, member_type in node['members']:
+                body.append('')
+                body.append('\t/* {} */'.format(member_name))
+                call = self.decode_call('{}_{}'.format(path, member_name), member_type,
+                                        'st->{}'.format(member_name), struct_names + [member_name])
+                body.append('\t' + call)
+                body.append('\tif(n < 0) return -1;')
+                body.append('\tp += n;')
+            body.append('')
+            if node['extensible']:
+                body.append('\t/* Extensions are skipped */')
+                body.append('\tif(fd_skip_extensions(ctx, &p, end, eocs)) return -1;')
+            else:
+                body.append('\tif(eocs == 0 && p != end) return -1;')
+        else:
+            element = node['element']
+            if element['kind'] != 'REF' or self.resolve(element)['kind'] not in ('SEQUENCE', 'SET OF'):
+                raise ParseError('SET OF is only supported for named SEQUENCE and SET OF types')
+            element_type = '{}_t'.format(element['name'])
+            body.append('')
+            body.append('\twhile(eocs ? !fd_at_eoc(p, end) : p < end) {')
+            body.append('\t\t{0} *el = ({0} *)CALLOC(1, sizeof(*el));'.format(element_type))
+            body.append('\t\tif(el == 0) return -1;')
+            body.append('\t\tif(ASN_SET_ADD(&st->list, el)) {')
+            body.append('\t\t\tFREEMEM(el);')
+            body.append('\t\t\treturn -1;')
+            body.append('\t\t}')
+            call = self.decode_call('{}_element'.format(path), element, '*el', struct_names)
+            body.append('\t\t' + call.replace('&*el', 'el').replace('\n', '\n\t'))
+            body.append('\t\tif(n < 0) return -1;')
+            body.append('\t\tp += n;')
+            body.append('\t}')
+
+        # The context is only needed to decode nested types and skip extensions,
+        # so it is unused by SEQUENCEs of primitive types without extensions.
+        uses_ctx = any('(ctx,' in line for line in body)
+
+        function = [
+            'static ssize_t',
+            'fd_decode_{}(asn_codec_ctx_t *ctx, {} *st,'.format(path, c_type),
+            '\t\tconst uint8_t *p, const uint8_t *end,',
+            '\t\tconst ber_tlv_tag_t *tags, int tags_count) {',
+            '\tconst uint8_t *start = p;',
+            '\tssize_t n;',
+            '\tint eocs;',
+            '',
+        ] + ([] if uses_ctx else [
+            '\t(void)ctx;',
+            '',
+        ]) + [
+            '\teocs = fd_open(&p, &end, tags, tags_count, 1, 0);',
+            '\tif(eocs < 0) return -1;',
+        ] + body + [
+            '',
+            '\tif(fd_close(&p, end, eocs)) return -1;',
+            '',
+            '\treturn p - start;',
+            '}',
+        ]
+        self.functions.append('\n'.join(function))
+
+    def generate(self):
+        public = []
+        for type_name, node in self.assignments:
+            base = self.untagged(node)
+            if base['kind'] not in ('SEQUENCE', 'SET OF'):
+                raise ParseError('{}: only SEQUENCE and SET OF assignments are supported'.format(type_name))
+            self.tag_array(type_name, self.tags(node))
+            self.constructed(type_name, base, '{}_t'.format(type_name), [type_name])
+            public.append(type_name)
+
+        header = self.header(public)
+        source = self.source(public)
+        return header, source
+
+    def banner(self):
+        return ('/*\n'
+                ' * Generated by gen_asn1_decoders.py\n'
+                ' * From ASN.1 module "{}"\n'
+                ' * \tfound in "{}"\n'
+                ' * Do not edit, regenerate instead.\n'
+                ' */\n').format(self.module_name, self.source_name)
+
+    def header(self, public):
+        guard = '_{}_H_'.format(self.output_name)
+        lines = [self.banner(), '#ifndef\t{}'.format(guard), '#define\t{}'.format(guard), '']
+        lines += ['#include "{}.h"'.format(t) for t in public]
+        lines += ['', '#ifdef __cplusplus', 'extern "C" {', '#endif', '']
+        for t in public:
+            lines += [
+                '/*',
+                ' * Decodes a BER encoded {0} like'.format(t),
+                ' * ber_decode(opt_codec_ctx, &asn_DEF_{0}, struct_ptr, buffer, size),'.format(t),
+                ' * with the same result, but without the generic SEQUENCE and SET OF',
+                ' * decoders for the common encodings.',
+                ' */',
+                'asn_dec_rval_t {}_decode_fast(asn_codec_ctx_t *opt_codec_ctx,'.format(t),
+                '\t{}_t **struct_ptr, const void *buffer, size_t size);'.format(t),
+                '',
+            ]
+        lines += ['#ifdef __cplusplus', '}', '#endif', '', '#endif\t/* {} */'.format(guard), '']
+        return '\n'.join(lines)
+
+    def source(self, public):
+        wrappers = []
+        for t in public:
+            wrappers.append(WRAPPER_TEMPLATE.replace('$T', t))
+        parts = [
+            self.banner(),
+            '#include "asn_internal.h"',
+            '#include "{}.h"'.format(self.output_name),
+            '',
+            RUNTIME,
+            '\n\n'.join(self.tag_arrays),
+            '',
+            '\n\n'.join(self.forward_declarations()),
+            '',
+            '\n\n'.join(self.functions),
+            '',
+            '\n\n'.join(wrappers),
+        ]
+        return '\n'.join(parts)
+
+    def forward_declarations(self):
+        declarations = []
+        for function in self.functions:
+            lines = function.split('\n')
+            declarations.append('\n'.join(lines[:4])[:-2] + ';')
+        return declarations
+
+
+# Support functions shared by the generated decoders. They read tags and
+# lengths with the asn1c runtime, and follow the checks of ber_check_tags()
+# and the SEQUENCE, SET OF, OCTET STRING and ANY decoders.
+RUNTIME = r'''/*
+ * The decoders below return the number of bytes consumed, or -1 if the
+ * encoding is one that they leave to the generic decoders.
+ */
+
+/* Arguments for a tags array */
+#define	FD_TAGS(tags)	tags, (int)(sizeof(tags) / sizeof(tags[0]))
+
+/* Maximum nesting of constructed TLVs within an ANY value */
+#define	FD_MAX_ANY_DEPTH	16
+
+/*
+ * Fetches the tag and the length of the TLV at (p).
+ * Returns the combined length of T and L, or -1 if they are malformed or
+ * a definite length value does not end before (end).
+ */
+static ssize_t
+fd_fetch_tl(const uint8_t *p, const uint8_t *end, ber_tlv_tag_t *tag,
+		int *constructed, ber_tlv_len_t *len) {
+	ssize_t tl, ll;
+
+	tl = ber_fetch_tag(p, end - p, tag);
+	if(tl <= 0) return -1;
+	*constructed = BER_TLV_CONSTRUCTED(p);
+	ll = ber_fetch_length(*constructed, p + tl, end - p - tl, len);
+	if(ll <= 0) return -1;
+	if(*len > end - p - tl - ll) return -1;
+
+	return tl + ll;
+}
+
+/*
+ * Checks the chain of (tags_count) tags at (*p), as ber_check_tags() does:
+ * either all lengths are definite and each TLV exactly fills the enclosing
+ * one, or all lengths are indefinite. (form) is the expected form of the
+ * innermost TLV: 0 for primitive, 1 for constructed and -1 for either.
+ * On success, advances (*p) to the contents, sets (*end) to the end of the
+ * contents if the lengths are definite, and returns the number of
+ * end-of-contents octets pairs that follow the contents.
+ */
+static int
+fd_open(const uint8_t **p, const uint8_t **end, const ber_tlv_tag_t *tags,
+		int tags_count, int form, int *constructed) {
+	const uint8_t *ptr = *p;
+	int eocs = 0;
+	int constr = 0;
+	int i;
+
+	for(i = 0; i < tags_count; i++) {
+		ber_tlv_tag_t tag;
+		ber_tlv_len_t len;
+		ssize_t tl;
+
+		tl = fd_fetch_tl(ptr, *end, &tag, &constr, &len);
+		if(tl < 0 || tag != tags[i]) return -1;
+		if(i < tags_count - 1) {
+			if(!constr) return -1;
+		} else if(form != -1 && constr != form) {
+			return -1;
+		}
+
+		if(len < 0) {
+			/* Indefinite lengths may not follow definite ones */
+			if(eocs != i) return -1;
+			eocs++;
+		} else {
+			if(eocs) return -1;
+			if(i > 0 && ptr + tl + len != *end) return -1;
+			*end = ptr + tl + len;
+		}
+
+		ptr += tl;
+	}
+
+	*p = ptr;
+	if(constructed) *constructed = constr;
+
+	return eocs;
+}
+
+/*
+ * Returns 1 if end-of-contents octets are at (p).
+ */
+static int
+fd_at_eoc(const uint8_t *p, const uint8_t *end) {
+	return end - p >= 2 && p[0] == 0 && p[1] == 0;
+}
+
+/*
+ * Reads (eocs) end-of-contents octets pairs at (*p).
+ */
+static int
+fd_close(const uint8_t **p, const uint8_t *end, int eocs) {
+	for(; eocs > 0; eocs--) {
+		if(!fd_at_eoc(*p, end)) return -1;
+		*p += 2;
+	}
+	return 0;
+}
+
+/*
+ * Skips the extensions at the end of an extensible SEQUENCE: up to (end)
+ * if its length is definite, up to its end-of-contents octets otherwise.
+ */
+static int
+fd_skip_extensions(asn_codec_ctx_t *ctx, const uint8_t **p,
+		const uint8_t *end, int eocs) {
+	const uint8_t *ptr = *p;
+
+	while(ptr < end && !(eocs && fd_at_eoc(ptr, end))) {
+		ber_tlv_tag_t tag;
+		ssize_t tl, ll;
+
+		tl = ber_fetch_tag(ptr, end - ptr, &tag);
+		if(tl <= 0) return -1;
+		ll = ber_skip_length(ctx, BER_TLV_CONSTRUCTED(ptr),
+			ptr + tl, end - ptr - tl);
+		if(ll <= 0) return -1;
+		ptr += tl + ll;
+	}
+
+	*p = ptr;
+	return 0;
+}
+
+/*
+ * Copies (size) bytes into a new NUL terminated buffer, as the primitive
+ * decoders do.
+ */
+static int
+fd_copy(uint8_t **buf, int *buf_size, const uint8_t *p, size_t size) {
+	if(size > INT32_MAX - 1) return -1;
+	*buf = (uint8_t *)MALLOC(size + 1);
+	if(*buf == 0) return -1;
+	memcpy(*buf, p, size);
+	(*buf)[size] = '\0';
+	*buf_size = (int)size;
+	return 0;
+}
+
+static ssize_t
+fd_decode_native_integer(long *st, const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+	INTEGER_t tmp;
+
+	if(fd_open(&p, &end, tags, tags_count, 0, 0) != 0) return -1;
+
+	tmp.buf = (uint8_t *)p;
+	tmp.size = (int)(end - p);
+	if(asn_INTEGER2long(&tmp, st)) return -1;
+
+	return end - start;
+}
+
+static ssize_t
+fd_decode_primitive(ASN__PRIMITIVE_TYPE_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+
+	if(fd_open(&p, &end, tags, tags_count, 0, 0) != 0) return -1;
+	if(fd_copy(&st->buf, &st->size, p, end - p)) return -1;
+
+	return end - start;
+}
+
+/*
+ * Decodes an OCTET STRING, either primitive or constructed of primitive
+ * segments. Segments which are themselves constructed are left to the
+ * generic decoder.
+ */
+static ssize_t
+fd_decode_octet_string(OCTET_STRING_t *st,
+		const uint8_t *p, const uint8_t *end,
+		const ber_tlv_tag_t *tags, int tags_count) {
+	const uint8_t *start = p;
+	const uint8_t *segments;
+	size_t size = 0;
+	int constructed;
+	int eocs;
+
+	eocs = fd_open(&p, &end, tags, tags_count, -1, &constructed);
+	if(eocs < 0) return -1;
+
+	if(!constructed) {
+		if(fd_copy(&st->buf, &st->size, p, end - p)) return -1;
+		return end - start;
+	}
+
+	/* Sizes the segments, then copies them */
+	for(segments = p; eocs ? !fd_at_eoc(p, end) : p < end;) {
+		ber_tlv_tag_t tag;
+		ber_tlv_len_t len;
+		ssize_t tl;
+		int constr;
+
+		tl = fd_fetch_tl(p, end, &tag, &constr, &len);
+		if(tl < 0 || constr
+		|| tag != (ASN_TAG_CLASS_UNIVERSAL | (4 << 2)))
+			return -1;
+		size += len;
+		p += tl + len;
+	}
+	if(eocs == 0 && p != end) return -1;
+
+	/* Like the generic decoder, leaves (buf) NULL if there are no contents */
+	if(size) {
+		uint8_t *buf;
+		if(size > INT32_MAX - 1) return -1;
+		st->buf = buf = (uint8_t *)MALLOC(size + 1);
+		if(buf == 0) return -1;
+		for(p = segments; eocs ? !fd_at_eoc(p, end) : p < end;) {
+			ber_tlv_tag_t tag;
+			ber_tlv_len_t len;
+			int constr;
+			ssize_t tl = fd_fetch_tl(p, end, &tag, &constr, &len);
+			memcpy(buf, p + tl, len);
+			buf += len;
+			p += tl + len;
+		}
+		*buf = '\0';
+		st->size = (int)size;
+	}
+
+	if(fd_close(&p, end, eocs)) return -1;
+
+	return p - start;
+}
+
+/*
+ * Checks that the contents of a constructed definite length TLV are
+ * exactly filled with definite length TLVs, as the ANY decoder does.
+ */
+static int
+fd_check_definite(const uint8_t *p, const uint8_t *end, int depth) {
+	if(depth > FD_MAX_ANY_DEPTH) return -1;
+
+	while(p < end) {
+		ber_tlv_tag_t tag;
+		ber_tlv_len_t len;
+		ssize_t tl;
+		int constr;
+
+		tl = fd_fetch_tl(p, end, &tag, &constr, &len);
+		if(tl < 0 || len < 0) return -1;
+		if(constr && fd_check_definite(p + tl, p + tl + len, depth + 1))
+			return -1;
+		p += tl + len;
+	}
+
+	return 0;
+}
+
+/*
+ * Decodes an untagged ANY, i.e. copies its whole TLV.
+ * Indefinite length values are left to the generic decoder.
+ */
+static ssize_t
+fd_decode_any(ANY_t *st, const uint8_t *p, const uint8_t *end) {
+	ber_tlv_tag_t tag;
+	ber_tlv_len_t len;
+	ssize_t tl;
+	int constr;
+
+	tl = fd_fetch_tl(p, end, &tag, &constr, &len);
+	if(tl < 0 || len < 0) return -1;
+	if(constr && fd_check_definite(p + tl, p + tl + len, 1)) return -1;
+	if(fd_copy(&st->buf, &st->size, p, tl + len)) return -1;
+
+	return tl + len;
+}
+'''
+
+WRAPPER_TEMPLATE = r'''asn_dec_rval_t
+$T_decode_fast(asn_codec_ctx_t *opt_codec_ctx,
+		$T_t **struct_ptr, const void *buffer, size_t size) {
+	asn_codec_ctx_t s_codec_ctx;
+	$T_t *st;
+	ssize_t consumed;
+
+	/*
+	 * Continuing a partial decode is left to the generic decoder.
+	 */
+	if(*struct_ptr)
+		return ber_decode(opt_codec_ctx, &asn_DEF_$T,
+			(void **)struct_ptr, buffer, size);
+
+	/*
+	 * Same stack limit as ber_decode() when skipping extensions.
+	 */
+	if(opt_codec_ctx) {
+		s_codec_ctx = *opt_codec_ctx;
+	} else {
+		memset(&s_codec_ctx, 0, sizeof(s_codec_ctx));
+		s_codec_ctx.max_stack_size = ASN__DEFAULT_STACK_MAX;
+	}
+
+	st = ($T_t *)CALLOC(1, sizeof(*st));
+	if(st) {
+		consumed = fd_decode_$T(
+			s_codec_ctx.max_stack_size ? &s_codec_ctx : 0, st,
+			(const uint8_t *)buffer, (const uint8_t *)buffer + size,
+			FD_TAGS(fd_tags_$T));
+		if(consumed >= 0) {
+			asn_dec_rval_t rval;
+			rval.code = RC_OK;
+			rval.consumed = consumed;
+			*struct_ptr = st;
+			return rval;
+		}
+		ASN_STRUCT_FREE(asn_DEF_$T, st);
+	}
+
+	/*
+	 * Anything else is decoded, or rejected, by the generic decoder.
+	 */
+	return ber_decode(opt_codec_ctx, &asn_DEF_$T,
+		(void **)struct_ptr, buffer, size);
+}'''
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate schema-specialized BER decoders from an ASN.1 module.')
+    parser.add_argument('module', help='Path to the ASN.1 module.')
+    parser.add_argument('output', help='Path of the generated files, without the .h and .c extensions.')
+    args = parser.parse_args()
+
+    with open(args.module) as f:
+        text = f.read()
+
+    output_name = os.path.basename(args.output)
+
+    try:
+        module_name, assignments = Parser(tokenize(text)).module()
+        header, source = Generator(module_name, os.path.basename(args.module), assignments, output_name).generate()
+    except ParseError as e:
+        print('error: {}: {}'.format(args.module, e), file=sys.stderr)
+        return 1
+
+    with open(args.output + '.h', 'w') as f:
+        f.write(header)
+    with open(args.output + '.c', 'w') as f:
+        f.write(source)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
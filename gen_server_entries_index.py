@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (c) 2026, Psiphon Inc.
+# All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+Generates the binary sidecar index of an embedded server entries file.
+
+The index lets `EmbeddedServerEntries` answer egress region queries without
+decoding every server entry at launch. See `server_entries_index_open` in
+`Psiphon/EmbeddedServerEntriesHelpers.h` for the reader.
+
+Layout (all integers little-endian):
+
+    Header (40 bytes)
+        char[4]  magic "PSEI"
+        uint32   version
+        uint64   source file size
+        uint64   source hash (see `content_hash`)
+        uint32   entry count
+        uint32   region count
+        uint32   string table size
+        uint32   reserved (0)
+    Region table, region count x 16 bytes, sorted by region name
+        uint32   name offset into string table
+        uint32   name length
+        uint32   number of entries in region
+        uint32   index of first entry of region in entry offsets
+    String table, padded with zeros to a multiple of 8 bytes
+    Entry offsets, entry count x uint64, grouped by region in region table order
+        Byte offset of the start of the entry's line in the source file
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+INDEX_MAGIC = b'PSEI'
+INDEX_VERSION = 2
+HEADER_FORMAT = '<4sIQQIIII'
+REGION_FORMAT = '<IIII'
+
+HASH_BASIS = 0xcbf29ce484222325
+HASH_PRIME = 0x9E3779B97F4A7C15
+HASH_MASK = 0xffffffffffffffff
+
+
+def content_hash(data):
+    """
+    Hash of the whole source, the same as `server_entries_content_hash`
+    computes at runtime over little-endian 8 byte words.
+
+    Together with the source size this detects an index that was generated
+    for a different file, including one that differs only in the middle.
+    """
+    h = HASH_BASIS ^ len(data)
+    words = len(data) - len(data) % 8
+
+    for (word,) in struct.iter_unpack('<Q', memoryview(data)[:words]):
+        h = ((h ^ word) * HASH_PRIME) & HASH_MASK
+        h ^= h >> 32
+
+    # Remaining bytes.
+    word = int.from_bytes(data[words:], 'little')
+    h = ((h ^ word) * HASH_PRIME) & HASH_MASK
+    h ^= h >> 29
+
+    return h
+
+
+def server_entry_region(line):
+    """Returns the region of a hex encoded server entry line."""
+    decoded = bytes.fromhex(line.decode('ascii'))
+    # Skip past legacy format (4 space delimited fields) to the JSON config.
+    fields = decoded.split(b' ', 4)
+    if len(fields) != 5:
+        raise ValueError('server entry JSON not found')
+    region = json.loads(fields[4].decode('utf-8'))['region']
+    if not isinstance(region, str):
+        raise ValueError('region is not a string')
+    return region.encode('utf-8')
+
+
+def build_index(data):
+    regions = {}
+    offset = 0
+    line_number = 1
+
+    while offset < len(data):
+        end = data.find(b'\n', offset)
+        next_offset = len(data) if end == -1 else end + 1
+        line = data[offset:(len(data) if end == -1 else end)].rstrip(b'\r')
+
+        try:
+            region = server_entry_region(line)
+        except Exception as e:
+            raise ValueError('line {}: {}'.format(line_number, e))
+
+        regions.setdefault(region, []).append(offset)
+
+        offset = next_offset
+        line_number += 1
+
+    names = sorted(regions.keys())
+
+    strings = bytearray()
+    region_table = bytearray()
+    entry_offsets = bytearray()
+    entry_count = 0
+
+    for name in names:
+        offsets = regions[name]
+        region_table += struct.pack(REGION_FORMAT, len(strings), len(name), len(offsets), entry_count)
+        strings += name
+        for o in offsets:
+            entry_offsets += struct.pack('<Q', o)
+        entry_count += len(offsets)
+
+    strings_size = len(strings)
+    strings += b'\0' * (-len(strings) % 8)
+
+    header = struct.pack(HEADER_FORMAT, INDEX_MAGIC, INDEX_VERSION, len(data), content_hash(data),
+                         entry_count, len(names), strings_size, 0)
+
+    return header + bytes(region_table) + bytes(strings) + bytes(entry_offsets)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the binary index of an embedded server entries file.')
+    parser.add_argument('source', help='Path to embedded server entries file.')
+    parser.add_argument('output', help='Path to write the index to.')
+    args = parser.parse_args()
+
+    with open(args.source, 'rb') as f:
+        data = f.read()
+
+    try:
+        index = build_index(data)
+    except ValueError as e:
+        # The app falls back to scanning the server entries when the index is missing,
+        # so a stale index must not be left behind.
+        if os.path.exists(args.output):
+            os.remove(args.output)
+        print('warning: not generating server entries index for {}: {}'.format(args.source, e))
+        return 0
+
+    with open(args.output, 'wb') as f:
+        f.write(index)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())